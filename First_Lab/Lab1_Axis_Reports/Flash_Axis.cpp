@@ -2,22 +2,38 @@
 #include <hls_stream.h>
 #include <ap_int.h>
 
+// Frame size, overridable for C-sim and the sweep: -DWIDTH=W -DHEIGHT=H
+#ifndef WIDTH
 #define WIDTH 256
+#endif
+#ifndef HEIGHT
 #define HEIGHT 256
+#endif
 #define T1 32
 #define T2 96
 
-// Define a 512-bit wide word (64 pixels * 8 bits)
-typedef ap_uint<512> wide_t;
+// Beat width of the AXIS links in bits: 128, 256, 512 (default) or 1024
+// e.g. -DAXIS_BEAT_BITS=1024 for a wide HBM path, 128 for a narrow link
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
 
-// Number of 512-bit chunks in a single row
-#define CHUNKS_PER_ROW (WIDTH / 64) 
+// One beat of BEAT_BITS / 8 pixels
+typedef ap_uint<AXIS_BEAT_BITS> wide_t;
 
-void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A, hls::stream<wide_t> &stream_B, hls::stream<wide_t> &stream_C) {
-    
-    #pragma HLS INTERFACE axis port=stream_A
-    #pragma HLS INTERFACE axis port=stream_B
-    #pragma HLS INTERFACE axis port=stream_C
+/* Posterize over AXIS, any beat width
+    - Input  : A and B rows, WIDTH / LANES beats each
+    - Output : C = Compare(A, B), same beat layout
+    LANES pixels are compared per beat, CHUNKS_PER_ROW beats make a row.
+*/
+template <int BEAT_BITS>
+void posterize_axis(hls::stream<ap_uint<BEAT_BITS> > &stream_A, hls::stream<ap_uint<BEAT_BITS> > &stream_B,
+                    hls::stream<ap_uint<BEAT_BITS> > &stream_C) {
+    const int LANES = BEAT_BITS / 8;
+    const int CHUNKS_PER_ROW = WIDTH / LANES;
+    static_assert(BEAT_BITS == 128 || BEAT_BITS == 256 || BEAT_BITS == 512 || BEAT_BITS == 1024,
+                  "AXIS beat width must be 128, 256, 512 or 1024 bits");
+    static_assert(WIDTH % LANES == 0, "WIDTH must be a multiple of the pixels per beat");
 
     uint8_t a; 
     uint8_t b; 
@@ -29,15 +45,14 @@ void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A, hls::stream<wide_t> &st
         COLUMN_LOOP: for(int j = 0; j < CHUNKS_PER_ROW; j++) {
         #pragma HLS PIPELINE II=1
             
-            wide_t chunk_a = stream_A.read();
-            wide_t chunk_b = stream_B.read();
-            wide_t chunk_c;
+            ap_uint<BEAT_BITS> chunk_a = stream_A.read();
+            ap_uint<BEAT_BITS> chunk_b = stream_B.read();
+            ap_uint<BEAT_BITS> chunk_c;
 
-            AXIS_PACKET_LOOP: for(int k = 0; k < 64; k++) {
+            AXIS_PACKET_LOOP: for(int k = 0; k < LANES; k++) {
             #pragma HLS UNROLL
                 
                 // axis loop pointers
-                int pixel_idx = (j * 64) + k;
                 int start_bit = k * 8;
                 int end_bit   = start_bit + 7;
 
@@ -58,4 +73,13 @@ void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A, hls::stream<wide_t> &st
             stream_C.write(chunk_c);
         }
     }
-}
\ No newline at end of file
+}
+
+void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A, hls::stream<wide_t> &stream_B, hls::stream<wide_t> &stream_C) {
+    
+    #pragma HLS INTERFACE axis port=stream_A
+    #pragma HLS INTERFACE axis port=stream_B
+    #pragma HLS INTERFACE axis port=stream_C
+
+    posterize_axis<AXIS_BEAT_BITS>(stream_A, stream_B, stream_C);
+}
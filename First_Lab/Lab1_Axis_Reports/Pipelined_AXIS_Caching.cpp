@@ -2,25 +2,39 @@
 #include <hls_stream.h>
 #include <ap_int.h>
 
+// Frame size, overridable for C-sim and the sweep: -DWIDTH=W -DHEIGHT=H
+#ifndef WIDTH
 #define WIDTH 256
+#endif
+#ifndef HEIGHT
 #define HEIGHT 256
+#endif
 #define T1 32
 #define T2 96
 
-// Define a 512-bit wide word (64 pixels * 8 bits)
-typedef ap_uint<512> wide_t;
-
-// Number of 512-bit chunks in a single row
-// 256 pixels / 64 pixels_per_chunk = 4 chunks per row
-#define CHUNKS_PER_ROW (WIDTH / 64) 
-
-void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A, 
-                          hls::stream<wide_t> &stream_B, 
-                          hls::stream<wide_t> &stream_C) {
-    
-    #pragma HLS INTERFACE axis port=stream_A
-    #pragma HLS INTERFACE axis port=stream_B
-    #pragma HLS INTERFACE axis port=stream_C
+// Beat width of the AXIS links in bits: 128, 256, 512 (default) or 1024
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
+
+// One beat of BEAT_BITS / 8 pixels (512 bits = 64 pixels * 8 bits)
+typedef ap_uint<AXIS_BEAT_BITS> wide_t;
+
+/* Row-cached posterize over AXIS, any beat width
+    - Input  : A and B rows, CHUNKS_PER_ROW beats of LANES pixels each
+    - Output : C = Compare(A, B), same beat layout
+    Number of chunks in a single row: 256 pixels / 64 pixels_per_chunk = 4 at 512 bits,
+    8 at 256 bits, 2 at 1024 bits.
+*/
+template <int BEAT_BITS>
+void posterize_axis_cached(hls::stream<ap_uint<BEAT_BITS> > &stream_A,
+                           hls::stream<ap_uint<BEAT_BITS> > &stream_B,
+                           hls::stream<ap_uint<BEAT_BITS> > &stream_C) {
+    const int LANES = BEAT_BITS / 8;
+    const int CHUNKS_PER_ROW = WIDTH / LANES;
+    static_assert(BEAT_BITS == 128 || BEAT_BITS == 256 || BEAT_BITS == 512 || BEAT_BITS == 1024,
+                  "AXIS beat width must be 128, 256, 512 or 1024 bits");
+    static_assert(WIDTH % LANES == 0, "WIDTH must be a multiple of the pixels per beat");
 
 
     // ---------------------------------------------------------
@@ -45,13 +59,13 @@ void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A,
         load_col_loop: for(int j = 0; j < CHUNKS_PER_ROW; j++) {
         #pragma HLS PIPELINE II=1
             
-            wide_t chunk_a = stream_A.read();
-            wide_t chunk_b = stream_B.read();
+            ap_uint<BEAT_BITS> chunk_a = stream_A.read();
+            ap_uint<BEAT_BITS> chunk_b = stream_B.read();
 
-            unpack_loop: for(int k = 0; k < 64; k++) {
+            unpack_loop: for(int k = 0; k < LANES; k++) {
             #pragma HLS UNROLL
                 
-                int pixel_idx = (j * 64) + k;
+                int pixel_idx = (j * LANES) + k;
                 int start_bit = k * 8;
                 int end_bit   = start_bit + 7;
 
@@ -76,12 +90,12 @@ void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A,
         store_col_loop: for(int j = 0; j < CHUNKS_PER_ROW; j++) {
         #pragma HLS PIPELINE II=1
             
-            wide_t chunk_c;
+            ap_uint<BEAT_BITS> chunk_c;
 
-            pack_loop: for(int k = 0; k < 64; k++) {
+            pack_loop: for(int k = 0; k < LANES; k++) {
             #pragma HLS UNROLL
                 
-                int pixel_idx = (j * 64) + k;
+                int pixel_idx = (j * LANES) + k;
                 int start_bit = k * 8;
                 int end_bit   = start_bit + 7;
                 
@@ -90,4 +104,15 @@ void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A,
             stream_C.write(chunk_c);
         }
     }
+}
+
+void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A, 
+                          hls::stream<wide_t> &stream_B, 
+                          hls::stream<wide_t> &stream_C) {
+    
+    #pragma HLS INTERFACE axis port=stream_A
+    #pragma HLS INTERFACE axis port=stream_B
+    #pragma HLS INTERFACE axis port=stream_C
+
+    posterize_axis_cached<AXIS_BEAT_BITS>(stream_A, stream_B, stream_C);
 }
\ No newline at end of file
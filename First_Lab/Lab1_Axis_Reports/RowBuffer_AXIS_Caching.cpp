@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <hls_stream.h>
+#include <ap_int.h>
+
+// The frame size only sets loop bounds and the row buffer depth, it is not capped at 256x256.
+// Override it with -DWIDTH=W -DHEIGHT=H
+#ifndef WIDTH
+#define WIDTH 256
+#endif
+#ifndef HEIGHT
+#define HEIGHT 256
+#endif
+#define T1 32
+#define T2 96
+
+// Beat width of the AXIS links in bits: 128, 256, 512 (default) or 1024
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
+
+// One beat of BEAT_BITS / 8 pixels (512 bits = 64 pixels * 8 bits)
+typedef ap_uint<AXIS_BEAT_BITS> wide_t;
+
+/* Row-buffered posterize over AXIS, any beat width
+    - Input  : A and B rows, CHUNKS_PER_ROW beats of LANES pixels each
+    - Output : C = Compare(A, B), same beat layout
+    Same load / compute / store stages as Staged_AXIS_Caching.cpp, but instead of three
+    full frames each stream keeps two rows of beats, ping-ponged: while row r is loaded
+    into one half, row r - 1 is compared out of the other and row r - 2 is stored.
+    All three stages advance one beat per cycle in a single II=1 loop.
+*/
+template <int BEAT_BITS>
+void posterize_axis_rows(hls::stream<ap_uint<BEAT_BITS> > &stream_A,
+                         hls::stream<ap_uint<BEAT_BITS> > &stream_B,
+                         hls::stream<ap_uint<BEAT_BITS> > &stream_C) {
+    const int LANES = BEAT_BITS / 8;
+    const int CHUNKS_PER_ROW = WIDTH / LANES;
+    static_assert(BEAT_BITS == 128 || BEAT_BITS == 256 || BEAT_BITS == 512 || BEAT_BITS == 1024,
+                  "AXIS beat width must be 128, 256, 512 or 1024 bits");
+    static_assert(WIDTH % LANES == 0, "WIDTH must be a multiple of the pixels per beat");
+
+    // ---------------------------------------------
+    // ROW CACHE: 2 rows per stream, kept as beats
+    // ---------------------------------------------
+    ap_uint<BEAT_BITS> buf_A[2][CHUNKS_PER_ROW];
+    ap_uint<BEAT_BITS> buf_B[2][CHUNKS_PER_ROW];
+    ap_uint<BEAT_BITS> buf_C[2][CHUNKS_PER_ROW];
+
+    // One memory per half, so a stage never shares a port with the stage on the other half.
+    // A beat is read back CHUNKS_PER_ROW iterations after it is written, only 2 at 1024
+    // bits, which can be shorter than the pipeline, so the dependence is left to the tool.
+    #pragma HLS ARRAY_PARTITION variable=buf_A type=complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=buf_B type=complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=buf_C type=complete dim=1
+
+    // Two extra rows drain the compute and store stages
+    ROW_PIPE_LOOP: for(int t = 0; t < (HEIGHT + 2) * CHUNKS_PER_ROW; t++) {
+    #pragma HLS PIPELINE II=1
+
+        int i = t / CHUNKS_PER_ROW;
+        int j = t % CHUNKS_PER_ROW;
+
+        // Load row i
+        if (i < HEIGHT) {
+            buf_A[i & 1][j] = stream_A.read();
+            buf_B[i & 1][j] = stream_B.read();
+        }
+
+        // Compute row i - 1
+        if (i >= 1 && i <= HEIGHT) {
+            ap_uint<BEAT_BITS> chunk_a = buf_A[(i - 1) & 1][j];
+            ap_uint<BEAT_BITS> chunk_b = buf_B[(i - 1) & 1][j];
+            ap_uint<BEAT_BITS> chunk_c;
+
+            compute_loop: for(int k = 0; k < LANES; k++) {
+            #pragma HLS UNROLL
+
+                int start_bit = k * 8;
+                int end_bit   = start_bit + 7;
+
+                uint8_t a = chunk_a.range(end_bit, start_bit);
+                uint8_t b = chunk_b.range(end_bit, start_bit);
+
+                int16_t temp_d = (int16_t)a - (int16_t)b;
+                uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+                if(D < T1)      chunk_c.range(end_bit, start_bit) = 0;
+                else if(D < T2) chunk_c.range(end_bit, start_bit) = 128;
+                else            chunk_c.range(end_bit, start_bit) = 255;
+            }
+            buf_C[(i - 1) & 1][j] = chunk_c;
+        }
+
+        // Store row i - 2
+        if (i >= 2) {
+            stream_C.write(buf_C[i & 1][j]);
+        }
+    }
+}
+
+void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A,
+                          hls::stream<wide_t> &stream_B,
+                          hls::stream<wide_t> &stream_C) {
+
+    #pragma HLS INTERFACE axis port=stream_A
+    #pragma HLS INTERFACE axis port=stream_B
+    #pragma HLS INTERFACE axis port=stream_C
+
+    posterize_axis_rows<AXIS_BEAT_BITS>(stream_A, stream_B, stream_C);
+}
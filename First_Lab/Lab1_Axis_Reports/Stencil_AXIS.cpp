@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <hls_stream.h>
+#include <ap_int.h>
+
+// Frame size, overridable for C-sim and the sweep: -DWIDTH=W -DHEIGHT=H
+#ifndef WIDTH
+#define WIDTH 256
+#endif
+#ifndef HEIGHT
+#define HEIGHT 256
+#endif
+#define T1 32
+#define T2 96
+
+// Beat width of the AXIS links in bits: 128, 256, 512 (default) or 1024
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
+
+// One beat of BEAT_BITS / 8 pixels (512 bits = 64 pixels * 8 bits)
+typedef ap_uint<AXIS_BEAT_BITS> wide_t;
+
+/* Compare + 5-point stencil over AXIS, any beat width
+    - Input  : A and B frames, HEIGHT rows of CHUNKS_PER_ROW beats
+    - Output : 5*G - up - down - left - right clamped to [0, 255], one pixel border zero,
+               the same frame as IMAGE_DIFF_POSTERIZE_SW (common/posterize_sw.hpp)
+    G is compared as the beats arrive and kept in two line buffers (rows r - 2 and r - 1).
+    Output row r - 1 is filtered while input row r streams in, one beat behind the input, so
+    the kernel emits one beat per input beat plus one extra row (and one beat) at the end.
+    The left neighbour of a beat's first lane comes from a register holding the previous
+    beat's last pixel, the right neighbour of its last lane from the next middle row beat,
+    which the one-beat lag has already read into a register.
+*/
+template <int BEAT_BITS>
+void posterize_axis_stencil(hls::stream<ap_uint<BEAT_BITS> > &stream_A,
+                            hls::stream<ap_uint<BEAT_BITS> > &stream_B,
+                            hls::stream<ap_uint<BEAT_BITS> > &stream_C) {
+    const int LANES = BEAT_BITS / 8;
+    const int CHUNKS_PER_ROW = WIDTH / LANES;
+    const int BEATS = (HEIGHT + 1) * CHUNKS_PER_ROW;
+    static_assert(BEAT_BITS == 128 || BEAT_BITS == 256 || BEAT_BITS == 512 || BEAT_BITS == 1024,
+                  "AXIS beat width must be 128, 256, 512 or 1024 bits");
+    static_assert(WIDTH % LANES == 0, "WIDTH must be a multiple of the pixels per beat");
+
+    // --------------------------------------------
+    // LINE BUFFERS: compared rows r - 2 and r - 1
+    // --------------------------------------------
+    // Each beat is read and rewritten at the same index in the same iteration and read
+    // again CHUNKS_PER_ROW iterations later, only 2 at 1024 bits, so no DEPENDENCE false.
+    ap_uint<BEAT_BITS> line_up[CHUNKS_PER_ROW];
+    ap_uint<BEAT_BITS> line_mid[CHUNKS_PER_ROW];
+
+    // The three beats being filtered, one beat behind the line buffers
+    ap_uint<BEAT_BITS> up_cur = 0;
+    ap_uint<BEAT_BITS> mid_cur = 0;
+    ap_uint<BEAT_BITS> down_cur = 0;
+    uint8_t left_px = 0;        // last pixel of the previous middle row beat
+
+    // Input beat t, output beat t - 1; one extra row to filter the last one
+    STENCIL_LOOP: for(int t = 0; t <= BEATS; t++) {
+    #pragma HLS PIPELINE II=1
+
+        int i = t / CHUNKS_PER_ROW;
+        int j = t % CHUNKS_PER_ROW;
+
+        // Compare row i
+        ap_uint<BEAT_BITS> g = 0;
+        if (i < HEIGHT) {
+            ap_uint<BEAT_BITS> chunk_a = stream_A.read();
+            ap_uint<BEAT_BITS> chunk_b = stream_B.read();
+
+            compare_loop: for(int k = 0; k < LANES; k++) {
+            #pragma HLS UNROLL
+
+                int start_bit = k * 8;
+                int end_bit   = start_bit + 7;
+
+                uint8_t a = chunk_a.range(end_bit, start_bit);
+                uint8_t b = chunk_b.range(end_bit, start_bit);
+
+                int16_t temp_d = (int16_t)a - (int16_t)b;
+                uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+                if(D < T1)      g.range(end_bit, start_bit) = 0;
+                else if(D < T2) g.range(end_bit, start_bit) = 128;
+                else            g.range(end_bit, start_bit) = 255;
+            }
+        }
+
+        // Shift the line buffers down one row, beat by beat
+        ap_uint<BEAT_BITS> up_next = 0;
+        ap_uint<BEAT_BITS> mid_next = 0;       // look-ahead: holds the right neighbour of mid_cur
+        if (t < BEATS) {
+            up_next = line_up[j];
+            mid_next = line_mid[j];
+            line_up[j] = mid_next;
+            line_mid[j] = g;
+        }
+
+        // Filter the previous beat, one row behind the input
+        if (t > CHUNKS_PER_ROW) {
+            int o = t - 1;
+            int row = o / CHUNKS_PER_ROW - 1;
+            int jo = o % CHUNKS_PER_ROW;
+            uint8_t right_px = (jo < CHUNKS_PER_ROW - 1) ? (uint8_t)mid_next.range(7, 0) : (uint8_t)0;
+            if (jo == 0) left_px = 0;
+
+            ap_uint<BEAT_BITS> chunk_c;
+
+            filter_loop: for(int k = 0; k < LANES; k++) {
+            #pragma HLS UNROLL
+
+                int start_bit = k * 8;
+                int end_bit   = start_bit + 7;
+
+                uint8_t center = mid_cur.range(end_bit, start_bit);
+                uint8_t above  = up_cur.range(end_bit, start_bit);
+                uint8_t below  = down_cur.range(end_bit, start_bit);
+                uint8_t left   = (k == 0) ? left_px : (uint8_t)mid_cur.range(start_bit - 1, start_bit - 8);
+                uint8_t right  = (k == LANES - 1) ? right_px : (uint8_t)mid_cur.range(end_bit + 8, end_bit + 1);
+
+                int16_t temp_filter = 5 * center - above - below - left - right;
+                uint8_t filtered = (temp_filter < 0) ? 0 : ((temp_filter > 255) ? 255 : temp_filter);
+
+                // Border rows and columns stay zero
+                int col = jo * LANES + k;
+                if (row == 0 || row == HEIGHT - 1 || col == 0 || col == WIDTH - 1) filtered = 0;
+
+                chunk_c.range(end_bit, start_bit) = filtered;
+            }
+            stream_C.write(chunk_c);
+            left_px = mid_cur.range(BEAT_BITS - 1, BEAT_BITS - 8);
+        }
+
+        up_cur = up_next;
+        mid_cur = mid_next;
+        down_cur = g;
+    }
+}
+
+void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A,
+                          hls::stream<wide_t> &stream_B,
+                          hls::stream<wide_t> &stream_C) {
+
+    #pragma HLS INTERFACE axis port=stream_A
+    #pragma HLS INTERFACE axis port=stream_B
+    #pragma HLS INTERFACE axis port=stream_C
+
+    posterize_axis_stencil<AXIS_BEAT_BITS>(stream_A, stream_B, stream_C);
+}
@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <hls_stream.h>
+#include <ap_int.h>
+#include <ap_axi_sdata.h>
+
+// Only the line length is fixed, a frame ends wherever the next start-of-frame arrives
+#define WIDTH 256
+#define T1 32
+#define T2 96
+
+// Beat width of the AXIS links in bits: 128, 256, 512 (default) or 1024
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
+
+#define LANES (AXIS_BEAT_BITS / 8)
+#define CHUNKS_PER_ROW (WIDTH / LANES)
+
+// AXI4-Stream video beat: TUSER = start of frame (first beat), TLAST = end of line
+typedef ap_axiu<AXIS_BEAT_BITS, 1, 0, 0> video_t;
+
+/*
+ * Free-running video mode
+ *
+ * ap_ctrl_none and a pipelined body that handles one beat per call: the block restarts
+ * itself every cycle, so back-to-back frames stream through without the idle cycles of a
+ * start / done handshake per frame.
+ *
+ * A and B are locked to each other on TUSER. While locked every call consumes one beat of
+ * each and emits one output beat. If only one of them starts a new frame (a short or
+ * dropped frame upstream), its start-of-frame beat is held and the other stream is read
+ * and dropped until its own start-of-frame shows up, then both resume together.
+ * Output TUSER follows the input start of frame, output TLAST is regenerated from the
+ * column count, so C is well framed even when the inputs were not.
+ */
+void IMAGE_DIFF_POSTERIZE_VIDEO(hls::stream<video_t> &stream_A, hls::stream<video_t> &stream_B, hls::stream<video_t> &stream_C) {
+
+    #pragma HLS INTERFACE axis port=stream_A
+    #pragma HLS INTERFACE axis port=stream_B
+    #pragma HLS INTERFACE axis port=stream_C
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    #pragma HLS PIPELINE II=1
+
+    static bool locked = false;             // A and B are inside the same frame
+    static bool held_A = false;             // start-of-frame beat waiting for the other stream
+    static bool held_B = false;
+    static video_t sof_A;
+    static video_t sof_B;
+    static ap_uint<16> col = 0;             // beat within the output line
+
+    video_t beat_a;
+    video_t beat_b;
+    bool valid = false;
+
+    if (locked) {
+        beat_a = stream_A.read();
+        beat_b = stream_B.read();
+
+        if (beat_a.user == beat_b.user) {
+            valid = true;
+        }
+        else {
+            // Frames out of step: keep the start of frame, drop the other beat
+            locked = false;
+            held_A = beat_a.user;
+            held_B = beat_b.user;
+            sof_A = beat_a;
+            sof_B = beat_b;
+        }
+    }
+    else {
+        // Resynchronize: read each stream up to its start of frame
+        if (!held_A) {
+            video_t a = stream_A.read();
+            if (a.user) {
+                held_A = true;
+                sof_A = a;
+            }
+        }
+        if (!held_B) {
+            video_t b = stream_B.read();
+            if (b.user) {
+                held_B = true;
+                sof_B = b;
+            }
+        }
+        if (held_A && held_B) {
+            beat_a = sof_A;
+            beat_b = sof_B;
+            held_A = false;
+            held_B = false;
+            locked = true;
+            valid = true;
+        }
+    }
+
+    if (valid) {
+        if (beat_a.user) col = 0;
+
+        video_t beat_c;
+        AXIS_PACKET_LOOP: for(int k = 0; k < LANES; k++) {
+        #pragma HLS UNROLL
+
+            int start_bit = k * 8;
+            int end_bit   = start_bit + 7;
+
+            uint8_t a = beat_a.data.range(end_bit, start_bit);
+            uint8_t b = beat_b.data.range(end_bit, start_bit);
+
+            int16_t temp_d = (int16_t)a - (int16_t)b;
+            uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+            if(D < T1)      beat_c.data.range(end_bit, start_bit) = 0;
+            else if(D < T2) beat_c.data.range(end_bit, start_bit) = 128;
+            else            beat_c.data.range(end_bit, start_bit) = 255;
+        }
+        beat_c.keep = -1;
+        beat_c.strb = -1;
+        beat_c.user = beat_a.user;
+        beat_c.last = (col == CHUNKS_PER_ROW - 1);
+        stream_C.write(beat_c);
+
+        col = (col == CHUNKS_PER_ROW - 1) ? (ap_uint<16>)0 : (ap_uint<16>)(col + 1);
+    }
+}
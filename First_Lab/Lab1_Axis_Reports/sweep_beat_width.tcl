@@ -0,0 +1,66 @@
+# Beat width sweep of the AXIS kernels: C-simulates and synthesizes Flash_Axis.cpp,
+# Stencil_AXIS.cpp, Pipelined_AXIS_Caching.cpp and RowBuffer_AXIS_Caching.cpp at 128,
+# 256, 512 and 1024 bits per beat, copies each csynth report here as
+# <kernel>_<bits>_csynth.rpt and collects latency, FF and LUT of all of them in
+# beat_width_sweep.md.
+#
+# Run from this directory: vitis_hls -f sweep_beat_width.tcl
+# The frame size defaults to 256x256, kernels and testbenches get the same -DWIDTH / -DHEIGHT.
+set part {xcu200-fsgd2104-2-e}
+set width 256
+set height 256
+
+# Testbench of each kernel
+set tb(Flash_Axis)             tb_IMAGE_DIFF_POSTERIZE.cpp
+set tb(Pipelined_AXIS_Caching) tb_IMAGE_DIFF_POSTERIZE.cpp
+set tb(RowBuffer_AXIS_Caching) tb_IMAGE_DIFF_POSTERIZE.cpp
+set tb(Stencil_AXIS)           tb_Stencil_AXIS.cpp
+
+# Latency (max cycles), FF and LUT of a csynth report
+proc report_numbers {rpt} {
+    set fp [open $rpt r]
+    set latency -
+    set ff -
+    set lut -
+    set in_latency 0
+    while {[gets $fp line] >= 0} {
+        if {[string match {+ Latency:*} [string trim $line]]} {
+            set in_latency 1
+        } elseif {$in_latency && [regexp {^\s*\|\s*(\d+)\|\s*(\d+)\|} $line -> lmin lmax]} {
+            set latency $lmax
+            set in_latency 0
+        } elseif {$ff eq "-" && [string match {|Total*} $line]} {
+            set fields [split $line |]
+            set ff [string trim [lindex $fields 4]]
+            set lut [string trim [lindex $fields 5]]
+        }
+    }
+    close $fp
+    return [list $latency $ff $lut]
+}
+
+set summary [open beat_width_sweep.md w]
+puts $summary "| Kernel | Beat bits | Latency (cycles) | FF | LUT |"
+puts $summary "|--------|-----------|------------------|----|-----|"
+
+foreach kernel {Flash_Axis Stencil_AXIS Pipelined_AXIS_Caching RowBuffer_AXIS_Caching} {
+    foreach bits {128 256 512 1024} {
+        set cflags "-DAXIS_BEAT_BITS=${bits} -DWIDTH=${width} -DHEIGHT=${height}"
+        open_project -reset sweep_${kernel}_${bits}
+        set_top IMAGE_DIFF_POSTERIZE
+        add_files ${kernel}.cpp -cflags $cflags
+        add_files -tb $tb($kernel) -cflags $cflags
+        open_solution -reset "solution1" -flow_target vivado
+        set_part $part
+        create_clock -period 10 -name default
+        csim_design             ;# stops the sweep if the testbench fails
+        csynth_design
+        file copy -force sweep_${kernel}_${bits}/solution1/syn/report/IMAGE_DIFF_POSTERIZE_csynth.rpt ${kernel}_${bits}_csynth.rpt
+        close_project
+        lassign [report_numbers ${kernel}_${bits}_csynth.rpt] latency ff lut
+        puts $summary "| $kernel | $bits | $latency | $ff | $lut |"
+        flush $summary
+    }
+}
+close $summary
+exit
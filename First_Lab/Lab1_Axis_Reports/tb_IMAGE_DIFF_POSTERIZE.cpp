@@ -4,11 +4,22 @@
 #include <hls_stream.h>
 #include <ap_int.h>
 
-// CRITICAL: Must match Kernel Dimensions
-#define WIDTH 64
-#define HEIGHT 64
+// CRITICAL: Must match Kernel Dimensions (256x256 unless both are built with -DWIDTH / -DHEIGHT)
+#ifndef WIDTH
+#define WIDTH 256
+#endif
+#ifndef HEIGHT
+#define HEIGHT 256
+#endif
 
-typedef ap_uint<512> wide_t;
+// Must match the kernel's AXIS_BEAT_BITS (build both with the same -DAXIS_BEAT_BITS=N)
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
+#define LANES (AXIS_BEAT_BITS / 8)
+static_assert(WIDTH % LANES == 0, "WIDTH must be a multiple of the pixels per beat");
+
+typedef ap_uint<AXIS_BEAT_BITS> wide_t;
 
 void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A, 
                           hls::stream<wide_t> &stream_B, 
@@ -25,7 +36,7 @@ uint8_t C[HEIGHT][WIDTH];
 uint8_t ref_data[HEIGHT][WIDTH];
 
 int main() {
-    printf("Initializing 256x256 data...\n");
+    printf("Initializing %dx%d data, %d-bit beats...\n", WIDTH, HEIGHT, AXIS_BEAT_BITS);
     for(int i = 0; i < HEIGHT; i++) {
         for(int j = 0; j < WIDTH; j++) {
             A[i][j] = (uint8_t)((i * j) % 256);
@@ -37,7 +48,7 @@ int main() {
     hls::stream<wide_t> strm_B;
     hls::stream<wide_t> strm_C;
 
-    int chunks_per_row = WIDTH / 64;
+    int chunks_per_row = WIDTH / LANES;
 
     printf("Packing streams...\n");
     for (int i = 0; i < HEIGHT; i++) {
@@ -45,8 +56,8 @@ int main() {
             wide_t pack_a = 0;
             wide_t pack_b = 0;
 
-            for (int k = 0; k < 64; k++) {
-                int col_idx = (j * 64) + k;
+            for (int k = 0; k < LANES; k++) {
+                int col_idx = (j * LANES) + k;
                 int start = k * 8;
                 int end = start + 7;
                 
@@ -71,8 +82,8 @@ int main() {
             }
             wide_t pack_c = strm_C.read();
 
-            for (int k = 0; k < 64; k++) {
-                int col_idx = (j * 64) + k;
+            for (int k = 0; k < LANES; k++) {
+                int col_idx = (j * LANES) + k;
                 int start = k * 8;
                 int end = start + 7;
                 C[i][col_idx] = (uint8_t)pack_c.range(end, start);
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <hls_stream.h>
+#include <ap_int.h>
+#include "../../common/posterize_sw.hpp"
+
+// CRITICAL: Must match Kernel Dimensions (256x256 unless both are built with -DWIDTH / -DHEIGHT)
+#ifndef WIDTH
+#define WIDTH 256
+#endif
+#ifndef HEIGHT
+#define HEIGHT 256
+#endif
+
+// Must match the kernel's AXIS_BEAT_BITS (build both with the same -DAXIS_BEAT_BITS=N)
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
+#define LANES (AXIS_BEAT_BITS / 8)
+static_assert(WIDTH % LANES == 0, "WIDTH must be a multiple of the pixels per beat");
+
+typedef ap_uint<AXIS_BEAT_BITS> wide_t;
+
+void IMAGE_DIFF_POSTERIZE(hls::stream<wide_t> &stream_A,
+                          hls::stream<wide_t> &stream_B,
+                          hls::stream<wide_t> &stream_C);
+
+// Global, like tb_IMAGE_DIFF_POSTERIZE.cpp, to keep large frames off the stack
+uint8_t A[HEIGHT][WIDTH];
+uint8_t B[HEIGHT][WIDTH];
+uint8_t C[HEIGHT][WIDTH];
+uint8_t ref_data[HEIGHT][WIDTH];
+
+int main() {
+    int chunks_per_row = WIDTH / LANES;
+
+    // Two frame pairs: the compare-only testbench pattern, and one where G changes
+    // inside every beat and across beat boundaries
+    for (int pattern = 0; pattern < 2; pattern++) {
+        printf("Pattern %d, %dx%d, %d-bit beats...\n", pattern, WIDTH, HEIGHT, AXIS_BEAT_BITS);
+        for(int i = 0; i < HEIGHT; i++) {
+            for(int j = 0; j < WIDTH; j++) {
+                if (pattern == 0) {
+                    A[i][j] = (uint8_t)((i * j) % 256);
+                    B[i][j] = (uint8_t)((i / (j + 1)) % 256);
+                } else {
+                    A[i][j] = (uint8_t)((i * 7 + j * 13) ^ (j >> 2));
+                    B[i][j] = (uint8_t)((i * 5 + j * 3) ^ (i >> 1));
+                }
+            }
+        }
+        IMAGE_DIFF_POSTERIZE_SW(&A[0][0], &B[0][0], &ref_data[0][0], WIDTH, HEIGHT);
+
+        hls::stream<wide_t> strm_A;
+        hls::stream<wide_t> strm_B;
+        hls::stream<wide_t> strm_C;
+
+        for (int i = 0; i < HEIGHT; i++) {
+            for (int j = 0; j < chunks_per_row; j++) {
+                wide_t pack_a = 0;
+                wide_t pack_b = 0;
+                for (int k = 0; k < LANES; k++) {
+                    int col_idx = (j * LANES) + k;
+                    pack_a.range(k * 8 + 7, k * 8) = A[i][col_idx];
+                    pack_b.range(k * 8 + 7, k * 8) = B[i][col_idx];
+                }
+                strm_A.write(pack_a);
+                strm_B.write(pack_b);
+            }
+        }
+
+        IMAGE_DIFF_POSTERIZE(strm_A, strm_B, strm_C);
+
+        for (int i = 0; i < HEIGHT; i++) {
+            for (int j = 0; j < chunks_per_row; j++) {
+                if (strm_C.empty()) {
+                    printf("Error: Stream C is empty prematurely at Row %d Col Chunk %d!\n", i, j);
+                    return 1;
+                }
+                wide_t pack_c = strm_C.read();
+                for (int k = 0; k < LANES; k++) {
+                    C[i][(j * LANES) + k] = (uint8_t)pack_c.range(k * 8 + 7, k * 8);
+                }
+            }
+        }
+        if (!strm_C.empty()) {
+            printf("Error: %d extra output beats\n", (int)strm_C.size());
+            return 1;
+        }
+
+        for (int i = 0; i < HEIGHT; i++) {
+            for (int j = 0; j < WIDTH; j++) {
+                if (C[i][j] != ref_data[i][j]) {
+                    printf("Mismatch at (%d,%d): HW=%d vs Expected=%d\n", i, j, C[i][j], ref_data[i][j]);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    printf("Test PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+#include <hls_stream.h>
+#include <ap_int.h>
+#include <ap_axi_sdata.h>
+
+// CRITICAL: Must match the kernel's line length
+#define WIDTH 256
+
+// Must match the kernel's AXIS_BEAT_BITS (build both with the same -DAXIS_BEAT_BITS=N)
+#ifndef AXIS_BEAT_BITS
+#define AXIS_BEAT_BITS 512
+#endif
+#define LANES (AXIS_BEAT_BITS / 8)
+#define CHUNKS_PER_ROW (WIDTH / LANES)
+
+#define LINES 3                                     // lines of a full test frame
+#define FRAME_BEATS (LINES * CHUNKS_PER_ROW)
+
+typedef ap_axiu<AXIS_BEAT_BITS, 1, 0, 0> video_t;
+
+void IMAGE_DIFF_POSTERIZE_VIDEO(hls::stream<video_t> &stream_A, hls::stream<video_t> &stream_B, hls::stream<video_t> &stream_C);
+
+// Pixel of a frame beat, A and B get different patterns so every class of the compare shows up
+static uint8_t pixel(int which, int frame, int beat, int lane) {
+    if (which == 0) return (uint8_t)(frame * 37 + beat * 11 + lane * 3);
+    return (uint8_t)(frame * 13 + beat * 7 + lane * 29);
+}
+
+static uint8_t compare(uint8_t a, uint8_t b) {
+    int16_t temp_d = (int16_t)a - (int16_t)b;
+    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+    if(D < 32) return 0;
+    else if(D < 96) return 128;
+    else return 255;
+}
+
+// Frame of `beats` beats: TUSER on the first, TLAST at the end of each line
+static void send_frame(hls::stream<video_t> &s, int which, int frame, int beats) {
+    for (int i = 0; i < beats; i++) {
+        video_t v;
+        for (int k = 0; k < LANES; k++) v.data.range(k * 8 + 7, k * 8) = pixel(which, frame, i, k);
+        v.keep = -1;
+        v.strb = -1;
+        v.user = (i == 0);
+        v.last = (i % CHUNKS_PER_ROW == CHUNKS_PER_ROW - 1);
+        s.write(v);
+    }
+}
+
+// Beats of no frame, as after a link comes up mid-frame
+static void send_junk(hls::stream<video_t> &s, int beats) {
+    for (int i = 0; i < beats; i++) {
+        video_t v;
+        v.data = 0;
+        for (int k = 0; k < LANES; k++) v.data.range(k * 8 + 7, k * 8) = (uint8_t)(i * 97 + k);
+        v.keep = -1;
+        v.strb = -1;
+        v.user = 0;
+        v.last = 0;
+        s.write(v);
+    }
+}
+
+struct ExpectedFrame { int frame; int beats; };
+
+int main() {
+    hls::stream<video_t> strm_A;
+    hls::stream<video_t> strm_B;
+    hls::stream<video_t> strm_C;
+    std::vector<ExpectedFrame> expected;
+
+    printf("Building streams, %d-bit beats, %d beats per line...\n", AXIS_BEAT_BITS, CHUNKS_PER_ROW);
+
+    // 1. Start up with A two beats into a frame: A is dropped up to its first TUSER
+    send_junk(strm_A, 2);
+    send_frame(strm_A, 0, 0, FRAME_BEATS);
+    send_frame(strm_B, 1, 0, FRAME_BEATS);
+    expected.push_back({0, FRAME_BEATS});
+
+    // 2. Back-to-back frames
+    for (int f = 1; f <= 2; f++) {
+        send_frame(strm_A, 0, f, FRAME_BEATS);
+        send_frame(strm_B, 1, f, FRAME_BEATS);
+        expected.push_back({f, FRAME_BEATS});
+    }
+
+    // 3. Short frame on A, ending mid-line: the rest of B's frame is dropped
+    send_frame(strm_A, 0, 3, CHUNKS_PER_ROW + CHUNKS_PER_ROW / 2);
+    send_frame(strm_B, 1, 3, FRAME_BEATS);
+    expected.push_back({3, CHUNKS_PER_ROW + CHUNKS_PER_ROW / 2});
+    send_frame(strm_A, 0, 4, FRAME_BEATS);
+    send_frame(strm_B, 1, 4, FRAME_BEATS);
+    expected.push_back({4, FRAME_BEATS});
+
+    // 4. Short frame on B: the rest of A's frame is dropped
+    send_frame(strm_A, 0, 5, FRAME_BEATS);
+    send_frame(strm_B, 1, 5, CHUNKS_PER_ROW + 1);
+    expected.push_back({5, CHUNKS_PER_ROW + 1});
+    send_frame(strm_A, 0, 6, FRAME_BEATS);
+    send_frame(strm_B, 1, 6, FRAME_BEATS);
+    expected.push_back({6, FRAME_BEATS});
+
+    // 5. Mismatched TUSER while locked: B's start of frame comes two beats after A's
+    send_frame(strm_A, 0, 7, FRAME_BEATS);
+    send_junk(strm_B, 2);
+    send_frame(strm_B, 1, 7, FRAME_BEATS);
+    expected.push_back({7, FRAME_BEATS});
+
+    // 6. Aligned again, both streams end together
+    send_frame(strm_A, 0, 8, FRAME_BEATS);
+    send_frame(strm_B, 1, 8, FRAME_BEATS);
+    expected.push_back({8, FRAME_BEATS});
+
+    printf("Running Kernel...\n");
+    // Free running: one call per cycle until the inputs are drained
+    while (!strm_A.empty() || !strm_B.empty()) {
+        if (strm_A.empty() || strm_B.empty()) {
+            printf("Error: one input ran dry before the other (A %d, B %d beats left)\n",
+                   (int)strm_A.size(), (int)strm_B.size());
+            return 1;
+        }
+        IMAGE_DIFF_POSTERIZE_VIDEO(strm_A, strm_B, strm_C);
+    }
+
+    printf("Verifying...\n");
+    for (size_t n = 0; n < expected.size(); n++) {
+        const ExpectedFrame &e = expected[n];
+        for (int i = 0; i < e.beats; i++) {
+            if (strm_C.empty()) {
+                printf("Error: Stream C is empty at frame %d beat %d!\n", e.frame, i);
+                return 1;
+            }
+            video_t c = strm_C.read();
+
+            bool user = (i == 0);
+            bool last = (i % CHUNKS_PER_ROW == CHUNKS_PER_ROW - 1);
+            if (c.user != user || c.last != last) {
+                printf("Framing mismatch at frame %d beat %d: TUSER=%d TLAST=%d vs Expected TUSER=%d TLAST=%d\n",
+                       e.frame, i, (int)c.user, (int)c.last, user, last);
+                return 1;
+            }
+            for (int k = 0; k < LANES; k++) {
+                uint8_t got = c.data.range(k * 8 + 7, k * 8);
+                uint8_t want = compare(pixel(0, e.frame, i, k), pixel(1, e.frame, i, k));
+                if (got != want) {
+                    printf("Mismatch at frame %d beat %d lane %d: HW=%d vs Expected=%d\n", e.frame, i, k, got, want);
+                    return 1;
+                }
+            }
+        }
+    }
+    if (!strm_C.empty()) {
+        printf("Error: %d extra output beats\n", (int)strm_C.size());
+        return 1;
+    }
+
+    printf("Test PASSED!\n");
+    return 0;
+}
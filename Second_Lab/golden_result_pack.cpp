@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include "../common/pack.hpp"
 #define WIDTH 5
 #define HEIGHT 5
 
@@ -31,27 +32,23 @@ void IMAGE_DIFF_POSTERIZE(uint32_t *A , uint32_t *B, uint32_t *out){
     uint8_t C[DATA_SIZE];
     int temp_filter;
     uint8_t temp_out[DATA_SIZE];
+    uint8_t pixels_A[DATA_SIZE];
+    uint8_t pixels_B[DATA_SIZE];
+    unpack_words(A, DATA_SIZE, pixels_A);
+    unpack_words(B, DATA_SIZE, pixels_B);
+
     printf("Difference Matrix:\n");
-    for(int w=0; w< WORD_COUNT; w++){
-            uint32_t word_A = A[w];
-            uint32_t word_B = B[w];
-            for(int byte_idx = 0; byte_idx < 4; byte_idx++){
-                    int idx = w * 4 + byte_idx;
-                    if(idx < DATA_SIZE){
-                    uint8_t byte_A = (word_A >> (byte_idx * 8)) & 0xFF;
-                    uint8_t byte_B = (word_B >> (byte_idx * 8)) & 0xFF;
-                    C[idx] = Compare(byte_A, byte_B);
-                    printf("%d ", C[idx]);
-                    }
+    for(int idx = 0; idx < DATA_SIZE; idx++){
+        C[idx] = Compare(pixels_A[idx], pixels_B[idx]);
+        printf("%d ", C[idx]);
     }
-}
 
 
     for(int i = 0 ; i < HEIGHT ; i++){
         for(int j =0 ; j < WIDTH ; j++){
             int idx = i * WIDTH + j;
             if(i==0|| i == HEIGHT -1 || j ==0 || j == WIDTH -1){
-                out[idx] = 0; // Set boundary pixels to 0
+                temp_out[idx] = 0; // Set boundary pixels to 0
             }else{
                 temp_filter = 5*C[idx] 
                             - C[idx +1] // Right 
@@ -59,7 +56,7 @@ void IMAGE_DIFF_POSTERIZE(uint32_t *A , uint32_t *B, uint32_t *out){
                             - C[idx + WIDTH] // Bottom
                             - C[idx - WIDTH]; // Top
                 // Clip to [0, 255]
-                out[idx] = (uint8_t)(temp_filter < 0 ? 0 : (temp_filter > 255 ? 255 : temp_filter));
+                temp_out[idx] = (uint8_t)(temp_filter < 0 ? 0 : (temp_filter > 255 ? 255 : temp_filter));
             }
         }
 
@@ -67,22 +64,7 @@ void IMAGE_DIFF_POSTERIZE(uint32_t *A , uint32_t *B, uint32_t *out){
 }
 
 // Pack output
-    for(int w=0; w< WORD_COUNT; w++){
-            uint32_t packed_word = 0;
-            for(int byte_idx = 0; byte_idx < 4; byte_idx++){
-                    int idx = w * 4 + byte_idx;
-                    uint8_t byte_out = 0;
-                    
-                    if(idx < DATA_SIZE){
-                    byte_out = out[idx];
-                    }
-                    else{
-                    byte_out = 0; // Padding for out-of-bounds
-                    }
-                    packed_word |= (byte_out << (byte_idx * 8));
-            }
-            out[w] = packed_word;
-    }
+    pack_words(temp_out, DATA_SIZE, out);
 
 }
 
@@ -117,44 +99,18 @@ int main()
     // pack input
     uint32_t packed_A[WORD_COUNT];
     uint32_t packed_B[WORD_COUNT];
-    for(int w=0; w< WORD_COUNT; w++){
-            uint32_t word_A = 0;
-            uint32_t word_B = 0;
-            for(int byte_idx = 0; byte_idx < 4; byte_idx++){
-                    int idx = w * 4 + byte_idx;
-                    uint8_t byte_A = 0;
-                    uint8_t byte_B = 0;
-                    if(idx < DATA_SIZE){
-                    byte_A = A[idx];
-                    byte_B = B[idx];
-                    }
-                    else{
-                    byte_A = 0; // Padding for out-of-bounds
-                    byte_B = 0; // Padding for out-of-bounds
-                    }
-                    word_A |= (byte_A << (byte_idx * 8));
-                    word_B |= (byte_B << (byte_idx * 8));
-            }
-            packed_A[w] = word_A;
-            packed_B[w] = word_B;
-    }
+    pack_words(A, DATA_SIZE, packed_A);
+    pack_words(B, DATA_SIZE, packed_B);
 
     IMAGE_DIFF_POSTERIZE(packed_A, packed_B, out);
 
     // Read unpacked output
     printf("\nResult Output:\n");
-    for (int w = 0; w < WORD_COUNT; w++)
+    uint8_t result[DATA_SIZE];
+    unpack_words(out, DATA_SIZE, result);
+    for (int idx = 0; idx < DATA_SIZE; idx++)
     {
-        uint32_t packed_word = out[w];
-        for (int byte_idx = 0; byte_idx < 4; byte_idx++)
-        {
-            int idx = w * 4 + byte_idx;
-            if (idx < DATA_SIZE)
-            {
-                uint8_t byte_out = (packed_word >> (byte_idx * 8)) & 0xFF;
-                printf("%3d ", byte_out);
-            }
-        }
+        printf("%3d ", result[idx]);
     }
 
     return 0;
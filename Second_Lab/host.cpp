@@ -8,11 +8,17 @@
 
 #include "xcl2.hpp" // Xilinx helper functions for OpenCL
 #include "event_timer.hpp"
+#include "../common/event_profiler.hpp"
+#include "../common/benchmark.hpp"
+#include "../common/workload_gen.hpp"
+#include "../common/frame_io.hpp"
+#include "../common/verify.hpp"
 #include <algorithm>
 #include <vector>
 #include <iostream>
 #include <fstream>  // <--- ADDED: To support file writing
 #include <stdint.h>
+#include <stdlib.h>
 
 #define WIDTH  256
 #define HEIGHT 256
@@ -30,13 +36,25 @@ int main(int argc, char **argv) {
     // -------------------------------------------------------------------------
     // 1. Initial Checks & Setup
     // -------------------------------------------------------------------------
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " <XCLBIN File>" << std::endl;
+    BenchConfig bench;
+    SceneParams scene;
+    FrameIOConfig frame_io;
+    std::vector<std::string> args = parse_bench_args(argc, argv, bench);
+    parse_workload_args(args, scene);
+    parse_frame_io_args(args, frame_io);
+    if (args.size() < 2 || args.size() > 3 || frame_io.input_a.empty() != frame_io.input_b.empty()) {
+        std::cout << "Usage: " << argv[0] << " <XCLBIN File> [Profile Iterations]"
+                  << " [--scene noise|blobs|ramp|sensor] [--seed N] [--frame N] [--sigma N]"
+                  << " [--input-a <pgm|ppm|raw>[:N] --input-b <pgm|ppm|raw>[:N]] [--output <pgm|raw>]"
+                  << " [--bench [--warmup N] [--iters N]]" << std::endl;
         return EXIT_FAILURE;
     }
 
     EventTimer et;
-    std::string binaryFile = argv[1];
+    EventProfiler prof;
+    std::string binaryFile = args[1];
+    int profile_iterations = (args.size() == 3) ? atoi(args[2].c_str()) : 1;
+    if (profile_iterations < 1) profile_iterations = 1;
 
     size_t vector_size_bytes = sizeof(uint8_t) * DATA_SIZE;
     int size = DATA_SIZE;
@@ -60,15 +78,35 @@ int main(int argc, char **argv) {
     uint8_t out_C[DATA_SIZE];
     et.finish();
 
-    // Fill vectors with random data
+    // Fill vectors with a synthetic scene (see common/workload_gen.hpp), or map the
+    // --input-a/--input-b files and hand their pages to the device buffers directly
     et.add("Fill the buffers");
-    std::generate(source_in1.begin(), source_in1.end(), std::rand);
-    std::generate(source_in2.begin(), source_in2.end(), std::rand);
+    FrameReader reader_A, reader_B;
+    uint8_t *src_in1 = source_in1.data();
+    uint8_t *src_in2 = source_in2.data();
+    if (!frame_io.input_a.empty()) {
+        if (!reader_A.open(frame_io.input_a, WIDTH, HEIGHT) || !reader_B.open(frame_io.input_b, WIDTH, HEIGHT)) {
+            return EXIT_FAILURE;
+        }
+        if (reader_A.width() != WIDTH || reader_A.height() != HEIGHT ||
+            reader_B.width() != WIDTH || reader_B.height() != HEIGHT) {
+            std::cerr << "Input frames must be " << WIDTH << "x" << HEIGHT << std::endl;
+            return EXIT_FAILURE;
+        }
+        src_in1 = reader_A.frame(frame_io.index_a);
+        src_in2 = reader_B.frame(frame_io.index_b);
+        if (src_in1 == nullptr || src_in2 == nullptr) {
+            std::cerr << "Frame index out of range" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        generate_frame_pair(source_in1.data(), source_in2.data(), WIDTH, HEIGHT, scene);
+    }
 
     // Calculate Golden Result (Software Reference)
     for (int i = 0; i < DATA_SIZE; i++) {
-    	in_A[i] = source_in1[i];
-    	in_B[i] = source_in2[i];
+    	in_A[i] = src_in1[i];
+    	in_B[i] = src_in2[i];
         source_hw_results[i] = 0; // Clear HW result buffer
     }
     IMAGE_DIFF_POSTERIZE(in_A, in_B, out_C, size);
@@ -129,8 +167,8 @@ int main(int argc, char **argv) {
     // 4. Device Memory Allocation
     // -------------------------------------------------------------------------
     et.add("Allocate Buffer in Global Memory");
-    OCL_CHECK(err, cl::Buffer buffer_in1(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, vector_size_bytes, source_in1.data(), &err));
-    OCL_CHECK(err, cl::Buffer buffer_in2(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, vector_size_bytes, source_in2.data(), &err));
+    OCL_CHECK(err, cl::Buffer buffer_in1(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, vector_size_bytes, src_in1, &err));
+    OCL_CHECK(err, cl::Buffer buffer_in2(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, vector_size_bytes, src_in2, &err));
     OCL_CHECK(err, cl::Buffer buffer_output(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, vector_size_bytes, source_hw_results.data(), &err));
     et.finish();
 
@@ -144,18 +182,34 @@ int main(int argc, char **argv) {
     OCL_CHECK(err, err = krnl_vector_add.setArg(3, size));
     et.finish();
 
+    // Each command signals an event so that the device-side timestamps can be read back,
+    // the EventTimer entries only cover the time the enqueue calls take to return.
     et.add("Copy input data to device global memory");
-    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1, buffer_in2}, 0));
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1, buffer_in2}, 0, nullptr, prof.event("Migrate inputs to device")));
     et.finish();
 
     et.add("Launch the Kernel");
-    OCL_CHECK(err, err = q.enqueueTask(krnl_vector_add));
+    OCL_CHECK(err, err = q.enqueueTask(krnl_vector_add, nullptr, prof.event("Kernel")));
     et.finish();
 
     et.add("Copy Result from Device Global Memory to Host Local Memory");
-    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST));
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, prof.event("Migrate output to host")));
     OCL_CHECK(err, err = q.finish());
     et.finish();
+    prof.collect();
+
+    // Additional runs only feed the device profile percentiles
+    if (profile_iterations > 1) {
+        et.add("Profile device execution");
+        for (int it = 1; it < profile_iterations; it++) {
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1, buffer_in2}, 0, nullptr, prof.event("Migrate inputs to device")));
+            OCL_CHECK(err, err = q.enqueueTask(krnl_vector_add, nullptr, prof.event("Kernel")));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, prof.event("Migrate output to host")));
+            OCL_CHECK(err, err = q.finish());
+            prof.collect();
+        }
+        et.finish();
+    }
 
     // -------------------------------------------------------------------------
     // NEW STEP: Export Results to File
@@ -180,25 +234,70 @@ int main(int argc, char **argv) {
     }
     et.finish();
 
+    if (!frame_io.output.empty()) {
+        et.add("Write output frame");
+        FrameWriter writer;
+        if (writer.open(frame_io.output, frame_format_for(frame_io.output), WIDTH, HEIGHT) &&
+            writer.write_frame(source_hw_results.data())) {
+            std::cout << "Device result written to " << frame_io.output << std::endl;
+        }
+        et.finish();
+    }
+
     // -------------------------------------------------------------------------
     // 6. Verification
     // -------------------------------------------------------------------------
     et.add("Compare the results of the Device to the simulation");
-    bool match = true;
-    for (int i = 0; i < DATA_SIZE; i++) {
-        if (source_hw_results[i] != out_C[i]) {
-            std::cout << "Error: Result mismatch" << std::endl;
-            std::cout << "i = " << i << " CPU result = " << (int)out_C[i]
-                      << " Device result = " << (int)source_hw_results[i] << std::endl;
-            match = false;
-            break;
-        }
-    }
+    VerifyResult verify = verify_frames(out_C, source_hw_results.data(), WIDTH, HEIGHT);
+    if (!verify.passed()) std::cout << "Error: Result mismatch" << std::endl;
+    verify_print(verify, WIDTH);
+    bool match = verify.passed();
     et.finish();
 
+    // -------------------------------------------------------------------------
+    // 7. Benchmark (optional)
+    // -------------------------------------------------------------------------
+    // Warmup iterations first so caches, pages and the driver are hot, then every
+    // timed iteration is recorded on its own. The kernel is built for WIDTH x HEIGHT,
+    // so this lab benchmarks the compiled frame size only.
+    if (bench.enabled) {
+        et.add("Benchmark");
+        EventProfiler bench_prof;
+
+        auto device_frame = [&]() {
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1, buffer_in2}, 0, nullptr, bench_prof.event("Migrate inputs to device")));
+            OCL_CHECK(err, err = q.enqueueTask(krnl_vector_add, nullptr, bench_prof.event("Kernel")));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, bench_prof.event("Migrate output to host")));
+            OCL_CHECK(err, err = q.finish());
+        };
+        bench_run(device_frame, bench.warmup, 0);
+        bench_prof.clear();
+        std::vector<double> e2e = bench_run(device_frame, 0, bench.iterations);
+        bench_prof.collect();
+
+        std::vector<double> sw = bench_run([&]() {
+            IMAGE_DIFF_POSTERIZE(in_A, in_B, out_C, size);
+        }, bench.warmup, bench.iterations);
+
+        std::cout << "----------------- Benchmark (" << WIDTH << "x" << HEIGHT << ") -----------------" << std::endl;
+        bench_header();
+        bench_report("Device end-to-end", e2e, DATA_SIZE, 3 * vector_size_bytes);
+        bench_report("Device kernel only", ns_to_seconds(bench_prof.exec_times("Kernel")), DATA_SIZE, 3 * vector_size_bytes);
+        bench_report("Host->device migrate", ns_to_seconds(bench_prof.exec_times("Migrate inputs to device")), DATA_SIZE, 2 * vector_size_bytes);
+        bench_report("Device->host migrate", ns_to_seconds(bench_prof.exec_times("Migrate output to host")), DATA_SIZE, vector_size_bytes);
+        bench_report("CPU IMAGE_DIFF_POSTERIZE", sw, DATA_SIZE, 3 * vector_size_bytes);
+        et.finish();
+    }
+
     std::cout << "----------------- Key execution times -----------------" << std::endl;
     et.print();
 
+    std::cout << "----------------- Device execution times -----------------" << std::endl;
+    prof.print();
+    if (prof.export_json("../device_profile.json")) {
+        std::cout << "Successfully wrote device profile to ../device_profile.json" << std::endl;
+    }
+
     std::cout << "TEST " << (match ? "PASSED" : "FAILED") << std::endl;
     return (match ? EXIT_SUCCESS : EXIT_FAILURE);
 }
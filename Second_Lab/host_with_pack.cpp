@@ -13,6 +13,7 @@
 #include <iostream>
 #include <fstream>  // <--- ADDED: To support file writing
 #include <stdint.h>
+#include "../common/pack.hpp"
 
 #define WIDTH 256
 #define HEIGHT 256
@@ -66,33 +67,10 @@ int main(int argc, char **argv) {
     std::generate(source_in1_bytes.begin(), source_in1_bytes.end(), std::rand);
     std::generate(source_in2_bytes.begin(), source_in2_bytes.end(), std::rand);
     
-    // Pack byte data into 32-bit words
-    for (int i = 0; i < WORD_COUNT; i++) {
-        // Check if we are within bounds for each byte and pad with zeros if not
-        uint8_t byte1_0 = (4*i < DATA_SIZE) ? source_in1_bytes[4*i] : 0;
-        uint8_t byte1_1 = (4*i + 1 < DATA_SIZE) ? source_in1_bytes[4*i + 1] : 0;
-        uint8_t byte1_2 = (4*i + 2 < DATA_SIZE) ? source_in1_bytes[4*i + 2] : 0;
-        uint8_t byte1_3 = (4*i + 3 < DATA_SIZE) ? source_in1_bytes[4*i + 3] : 0;
-
+    // Pack byte data into 32-bit words (zero padded)
+    pack_words(source_in1_bytes.data(), DATA_SIZE, source_in1.data());
+    pack_words(source_in2_bytes.data(), DATA_SIZE, source_in2.data());
 
-        uint32_t word1 = (byte1_0 << 0) |
-                         (byte1_1 << 8) |
-                         (byte1_2 << 16) |
-                         (byte1_3 << 24);
-        
-        uint8_t byte2_0 = (4*i < DATA_SIZE) ? source_in2_bytes[4*i] : 0;
-        uint8_t byte2_1 = (4*i + 1 < DATA_SIZE) ? source_in2_bytes[4*i + 1] : 0;
-        uint8_t byte2_2 = (4*i + 2 < DATA_SIZE) ? source_in2_bytes[4*i + 2] : 0;
-        uint8_t byte2_3 = (4*i + 3 < DATA_SIZE) ? source_in2_bytes[4*i + 3] : 0;
-
-        uint32_t word2 = (byte2_0 << 0) |
-                         (byte2_1 << 8) |
-                         (byte2_2 << 16) |
-                         (byte2_3 << 24);
-
-        source_in1[i] = word1;
-        source_in2[i] = word2;
-    }
     // Calculate Golden Result (Software Reference)
     for (int i = 0; i < WORD_COUNT; i++) {
 
@@ -177,23 +155,19 @@ int main(int argc, char **argv) {
     // -------------------------------------------------------------------------
     // We export before verification so we have the data even if verification fails.
     et.add("Export results to ../results_comparison.txt");
-    
+    std::vector<uint8_t> sw_bytes(DATA_SIZE), hw_bytes(DATA_SIZE);
+    unpack_words(source_sw_results.data(), DATA_SIZE, sw_bytes.data());
+    unpack_words(source_hw_results.data(), DATA_SIZE, hw_bytes.data());
+
     std::ofstream outFile("../results_comparison.txt");
     if (outFile.is_open()) {
         outFile << "Index\tSW_Result\tHW_Result\tMatch\n";
-        for (int i = 0; i < WORD_COUNT; i++) {
-            uint32_t sw_word = source_sw_results[i];
-            uint32_t hw_word = source_hw_results[i];
-            for (int byte_idx = 0; byte_idx < 4; byte_idx++) {
-                int index = i * 4 + byte_idx;
-                uint8_t sw_byte = (sw_word >> (byte_idx * 8)) & 0xFF;
-                uint8_t hw_byte = (hw_word >> (byte_idx * 8)) & 0xFF;
-                bool is_match = (sw_byte == hw_byte);
-                outFile << index << "\t" 
-                        << static_cast<int>(sw_byte) << "\t" 
-                        << static_cast<int>(hw_byte) << "\t" 
-                        << (is_match ? "YES" : "NO") << "\n";
-            }
+        for (int index = 0; index < DATA_SIZE; index++) {
+            bool is_match = (sw_bytes[index] == hw_bytes[index]);
+            outFile << index << "\t"
+                    << static_cast<int>(sw_bytes[index]) << "\t"
+                    << static_cast<int>(hw_bytes[index]) << "\t"
+                    << (is_match ? "YES" : "NO") << "\n";
         }
         outFile.close();
         std::cout << "Successfully wrote results to ../results_comparison.txt" << std::endl;
@@ -208,10 +182,10 @@ int main(int argc, char **argv) {
     et.add("Compare the results of the Device to the simulation");
     bool match = true;
     for (int i = 0; i < DATA_SIZE; i++) {
-        if (source_hw_results[i] != source_sw_results[i]) {
+        if (hw_bytes[i] != sw_bytes[i]) {
             std::cout << "Error: Result mismatch" << std::endl;
-            std::cout << "i = " << i << " CPU result = " << source_sw_results[i]
-                      << " Device result = " << source_hw_results[i] << std::endl;
+            std::cout << "i = " << i << " CPU result = " << (int)sw_bytes[i]
+                      << " Device result = " << (int)hw_bytes[i] << std::endl;
             match = false;
             break;
         }
@@ -244,27 +218,23 @@ void IMAGE_DIFF_POSTERIZE(uint32_t *A , uint32_t *B, uint32_t *out){
     uint8_t C[DATA_SIZE];
     int temp_filter;
     uint8_t temp_out[DATA_SIZE];
+    uint8_t pixels_A[DATA_SIZE];
+    uint8_t pixels_B[DATA_SIZE];
+    unpack_words(A, DATA_SIZE, pixels_A);
+    unpack_words(B, DATA_SIZE, pixels_B);
+
     printf("Difference Matrix:\n");
-    for(int w=0; w< WORD_COUNT; w++){
-            uint32_t word_A = A[w];
-            uint32_t word_B = B[w];
-            for(int byte_idx = 0; byte_idx < 4; byte_idx++){
-                    int idx = w * 4 + byte_idx;
-                    if(idx < DATA_SIZE){
-                    uint8_t byte_A = (word_A >> (byte_idx * 8)) & 0xFF;
-                    uint8_t byte_B = (word_B >> (byte_idx * 8)) & 0xFF;
-                    C[idx] = Compare(byte_A, byte_B);
-                    printf("%d ", C[idx]);
-                    }
+    for(int idx = 0; idx < DATA_SIZE; idx++){
+        C[idx] = Compare(pixels_A[idx], pixels_B[idx]);
+        printf("%d ", C[idx]);
     }
-}
 
 
     for(int i = 0 ; i < HEIGHT ; i++){
         for(int j =0 ; j < WIDTH ; j++){
             int idx = i * WIDTH + j;
             if(i==0|| i == HEIGHT -1 || j ==0 || j == WIDTH -1){
-                out[idx] = 0; // Set boundary pixels to 0
+                temp_out[idx] = 0; // Set boundary pixels to 0
             }else{
                 temp_filter = 5*C[idx] 
                             - C[idx +1] // Right 
@@ -272,10 +242,13 @@ void IMAGE_DIFF_POSTERIZE(uint32_t *A , uint32_t *B, uint32_t *out){
                             - C[idx + WIDTH] // Bottom
                             - C[idx - WIDTH]; // Top
                 // Clip to [0, 255]
-                out[idx] = (uint8_t)(temp_filter < 0 ? 0 : (temp_filter > 255 ? 255 : temp_filter));
+                temp_out[idx] = (uint8_t)(temp_filter < 0 ? 0 : (temp_filter > 255 ? 255 : temp_filter));
             }
         }
 
 
 }
-}
\ No newline at end of file
+
+    // Pack output
+    pack_words(temp_out, DATA_SIZE, out);
+}
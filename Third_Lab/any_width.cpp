@@ -0,0 +1,28 @@
+#include "any_width_core.hpp"
+
+#define T1 32
+#define T2 96
+
+/* ANY WIDTH
+    - Input  : in_A, in_B frames of width x height pixels packed back to back, any width in
+               [MIN_WIDTH, MAX_WIDTH]
+    - Output : out, ceil(width * height / 64) beats, see any_width_core.hpp
+*/
+extern "C" {
+    void IMAGE_DIFF_POSTERIZE_ANY_WIDTH(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                                        int width, int height)
+    {
+        // INTERFACE DIRECTIVES
+        #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem0
+        #pragma HLS INTERFACE m_axi port = in_B offset = slave bundle = gmem1
+        #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem2
+        #pragma HLS INTERFACE s_axilite port = in_A bundle = control
+        #pragma HLS INTERFACE s_axilite port = in_B bundle = control
+        #pragma HLS INTERFACE s_axilite port = out bundle = control
+        #pragma HLS INTERFACE s_axilite port = width bundle = control
+        #pragma HLS INTERFACE s_axilite port = height bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        any_width_core(in_A, in_B, out, width, height, T1, T2);
+    }
+}
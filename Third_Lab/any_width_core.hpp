@@ -0,0 +1,213 @@
+/*
+ * Runtime-size datapath of the any-width kernels
+ *
+ * Compare + 5-point stencil over a packed frame of any width in [MIN_WIDTH, MAX_WIDTH],
+ * streamed as one linear run of 512-bit beats. Shared by the single-launch kernel
+ * (any_width.cpp) and the persistent descriptor-ring kernel (persistent.cpp), which
+ * also takes the thresholds from its descriptors.
+ */
+
+#ifndef ANY_WIDTH_CORE_HPP
+#define ANY_WIDTH_CORE_HPP
+
+#include <stdint.h>
+#include <ap_int.h>
+
+// Frame bounds, the actual size is a kernel argument
+#define MIN_WIDTH 64
+#define MAX_WIDTH 4096
+
+// Transaction Definition
+#define PIXEL_SIZE 8
+#define AXI_WIDTH_BITS 512       // Data width of Memory Access in bits per cycle
+#define AXI_WIDTH_BYTES (AXI_WIDTH_BITS / PIXEL_SIZE)
+#define MAX_ROW_BEATS ((MAX_WIDTH + AXI_WIDTH_BYTES - 1) / AXI_WIDTH_BYTES)
+
+// G delay lines, indexed modulo a power of two above the longest delay (2 rows of beats)
+#define RING_SIZE (4 * MAX_ROW_BEATS)
+#define RING_MASK (RING_SIZE - 1)
+
+// Delays up to G_REG_BEATS come from registers, so a delay line is only read back
+// RING_MIN_DISTANCE or more beats after it is written
+#define G_REG_BEATS 8
+#define RING_MIN_DISTANCE (G_REG_BEATS + 1)
+
+// Type Definitions
+typedef ap_uint<AXI_WIDTH_BITS> uint512_dt;
+typedef ap_uint<PIXEL_SIZE> pixel_t;
+
+/* Compare with runtime thresholds
+    - Input  : 2 uint8_t numbers, thresholds t1 < t2
+    - Output : Quantized absolute difference
+*/
+static pixel_t compare_px(pixel_t A, pixel_t B, uint8_t t1, uint8_t t2){
+    int16_t temp_d = (int16_t) A - (int16_t) B;
+    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+    if(D < t1) return (pixel_t) 0;
+    else if(D < t2) return (pixel_t) 128;
+    else return (pixel_t) 255;
+}
+
+/* ANY WIDTH CORE
+    - Input  : in_A, in_B frames of width x height pixels packed back to back, any width in
+               [MIN_WIDTH, MAX_WIDTH]; the last beat is zero padded up to 64 bytes
+    - Output : out, the same frame as IMAGE_DIFF_POSTERIZE_SW (common/posterize_sw.hpp) for
+               thresholds t1 / t2, ceil(width * height / 64) beats with the padding bytes
+               written as zero
+
+    Rows are not beat aligned when width % 64 != 0, so instead of walking rows the core
+    streams the frame as one linear run of beats at II=1. With width = 64 * Q - r (Q beats
+    per row, 0 <= r < 64), output beat o needs:
+        centre / left / right  beats o - 1, o, o + 1
+        up                     beats o - Q, o - Q + 1, shifted by r bytes
+        down                   beats o + Q - 1, o + Q, shifted by 64 - r bytes
+    The last G_REG_BEATS compared beats are kept in registers, which give the down beats and,
+    for narrow frames, the Q and 2 * Q beat delays of centre and up. Longer delays read the
+    G delay lines, which are then always at least RING_MIN_DISTANCE beats behind the write.
+    Output beat o leaves Q + 1 beats after input beat o came in.
+    Row and column of every lane are tracked incrementally to zero the border.
+
+    Byte masks: the lanes of the last input beat past width * height are forced to zero
+    (the host buffer may hold anything there) and the lanes of the output past the frame
+    are written as zero. HLS always drives full write strobes on a 512-bit m_axi port, so
+    the padding bytes of the last beat are written, the host allocates whole beats.
+*/
+static void any_width_core(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                           int width, int height, uint8_t t1, uint8_t t2)
+{
+    if (width < MIN_WIDTH || width > MAX_WIDTH || height < 1) return;
+
+    const int pixels = width * height;
+    const int beats = (pixels + AXI_WIDTH_BYTES - 1) / AXI_WIDTH_BYTES;
+    const int tail_bytes = pixels - (beats - 1) * AXI_WIDTH_BYTES;     // valid bytes of the last beat
+    const int Q = (width + AXI_WIDTH_BYTES - 1) / AXI_WIDTH_BYTES;
+    const int r = Q * AXI_WIDTH_BYTES - width;
+
+    // Delay lines: ring_mid read Q beats back, ring_up 2 * Q beats back, only for delays
+    // above G_REG_BEATS. The distance tells the scheduler how far apart the accesses are at
+    // least, a deeper pipeline than that shows up as a higher II instead of a stale read.
+    uint512_dt ring_mid[RING_SIZE];
+    uint512_dt ring_up[RING_SIZE];
+    #pragma HLS DEPENDENCE variable=ring_mid inter RAW distance=RING_MIN_DISTANCE true
+    #pragma HLS DEPENDENCE variable=ring_up inter RAW distance=RING_MIN_DISTANCE true
+
+    uint512_dt g_hist[G_REG_BEATS];     // g_hist[d - 1] = G beat t - d, the down beats are d = 2, 1
+    #pragma HLS ARRAY_PARTITION variable=g_hist complete
+    for (int d = 0; d < G_REG_BEATS; d++) {
+    #pragma HLS UNROLL
+        g_hist[d] = 0;
+    }
+
+    uint512_dt mid_prev = 0;    // beat o - 1
+    uint512_dt mid_cur = 0;     // beat o
+    uint512_dt mid_next = 0;    // beat o + 1
+    uint512_dt up_lo = 0;       // beat o - Q
+    uint512_dt up_hi = 0;       // beat o - Q + 1
+
+    // Row / column of the first pixel of the output beat
+    int base_row = 0;
+    int base_col = 0;
+
+    ANY_WIDTH_LOOP: for (int t = 0; t < beats + Q + 1; t++) {
+    #pragma HLS PIPELINE II=1
+    #pragma HLS LOOP_TRIPCOUNT min = 2 max = 131072
+
+        // Compare beat t, zero-extended past the end of the frame
+        uint512_dt res_G = 0;
+        if (t < beats) {
+            uint512_dt val1 = in_A[t];
+            uint512_dt val2 = in_B[t];
+
+            for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+            #pragma HLS UNROLL
+                pixel_t p1 = val1.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                pixel_t p2 = val2.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+
+                // Read mask of the last beat
+                bool valid = (t < beats - 1) || (v < tail_bytes);
+                res_G.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = valid ? compare_px(p1, p2, t1, t2) : (pixel_t)0;
+            }
+        }
+
+        // Advance the centre and up windows by one beat
+        uint512_dt mid_in;
+        if (Q <= G_REG_BEATS) mid_in = g_hist[Q - 1];
+        else                  mid_in = (t >= Q) ? ring_mid[(t - Q) & RING_MASK] : (uint512_dt)0;
+        uint512_dt up_in;
+        if (2 * Q <= G_REG_BEATS) up_in = g_hist[2 * Q - 1];
+        else                      up_in = (t >= 2 * Q) ? ring_up[(t - 2 * Q) & RING_MASK] : (uint512_dt)0;
+
+        mid_prev = mid_cur;
+        mid_cur = mid_next;
+        mid_next = mid_in;
+        up_lo = up_hi;
+        up_hi = up_in;
+
+        // Filter output beat o = t - Q - 1
+        int o = t - Q - 1;
+        if (o >= 0) {
+            pixel_t up_px[2 * AXI_WIDTH_BYTES];
+            pixel_t down_px[2 * AXI_WIDTH_BYTES];
+            pixel_t mid_px[AXI_WIDTH_BYTES + 2];
+            #pragma HLS ARRAY_PARTITION variable=up_px complete
+            #pragma HLS ARRAY_PARTITION variable=down_px complete
+            #pragma HLS ARRAY_PARTITION variable=mid_px complete
+
+            for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+            #pragma HLS UNROLL
+                up_px[v] = up_lo.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                up_px[AXI_WIDTH_BYTES + v] = up_hi.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                down_px[v] = g_hist[1].range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                down_px[AXI_WIDTH_BYTES + v] = g_hist[0].range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                mid_px[v + 1] = mid_cur.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+            }
+            mid_px[0] = mid_prev.range(AXI_WIDTH_BITS - 1, AXI_WIDTH_BITS - PIXEL_SIZE);
+            mid_px[AXI_WIDTH_BYTES + 1] = mid_next.range(PIXEL_SIZE - 1, 0);
+
+            uint512_dt out_val;
+            for (int k = 0; k < AXI_WIDTH_BYTES; k++) {
+            #pragma HLS UNROLL
+                // Row and column of lane k, width >= 64 so a beat wraps at most once
+                int col = base_col + k;
+                int row = base_row;
+                if (col >= width) {
+                    col -= width;
+                    row++;
+                }
+
+                int16_t temp_filter = 5 * mid_px[k + 1]                       // Center pixel
+                                        - up_px[r + k]                        // Up pixel
+                                        - down_px[AXI_WIDTH_BYTES - r + k]    // Down pixel
+                                        - mid_px[k]                           // Left pixel
+                                        - mid_px[k + 2];                      // Right pixel
+
+                // Clamping the result to [0, 255]
+                pixel_t filtered_pixel = (temp_filter < 0) ? 0 : (temp_filter > 255 ? 255 : temp_filter);
+
+                // Border rows and columns, and the write mask past the frame, stay zero
+                if (row == 0 || row >= height - 1 || col == 0 || col == width - 1) filtered_pixel = 0;
+
+                out_val.range(PIXEL_SIZE * (k + 1) - 1, k * PIXEL_SIZE) = filtered_pixel;
+            }
+            out[o] = out_val;
+
+            base_col += AXI_WIDTH_BYTES;
+            if (base_col >= width) {
+                base_col -= width;
+                base_row++;
+            }
+        }
+
+        // Shift the compared beat into the delay lines
+        ring_mid[t & RING_MASK] = res_G;
+        ring_up[t & RING_MASK] = res_G;
+        for (int d = G_REG_BEATS - 1; d > 0; d--) {
+        #pragma HLS UNROLL
+            g_hist[d] = g_hist[d - 1];
+        }
+        g_hist[0] = res_G;
+    }
+}
+
+#endif
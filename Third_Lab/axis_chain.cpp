@@ -0,0 +1,200 @@
+#include <stdint.h>
+#include <ap_int.h>
+#include <ap_axi_sdata.h>
+#include <hls_stream.h>
+
+// Original Image
+#define WIDTH 256
+#define HEIGHT 512
+
+// Transaction Definition
+#define PIXEL_SIZE 8
+#define AXI_WIDTH_BITS 512       // Data width of Memory Access in bits per cycle
+#define AXI_WIDTH_BYTES (AXI_WIDTH_BITS / PIXEL_SIZE)
+#define CHUNKS_PER_ROW (WIDTH / AXI_WIDTH_BYTES)
+
+// Type Definitions
+typedef ap_uint<AXI_WIDTH_BITS> uint512_dt;
+typedef ap_uint<PIXEL_SIZE> pixel_t;
+typedef ap_axiu<AXI_WIDTH_BITS, 0, 0, 0> pkt_t;     // one output beat, TLAST on the last beat of the frame
+
+#include "stats_unit.hpp"
+#include "stencil_beat.hpp"
+
+// Helper Functions
+pixel_t Compare(pixel_t A, pixel_t B);
+
+/*
+ * Kernel-to-kernel chain: IMAGE_DIFF_POSTERIZE_AXIS -> POSTERIZE_STATS
+ *
+ * The posterize kernel writes its filtered frame to an AXI stream instead of DDR and the
+ * stats kernel consumes it, so a chained run only reads A and B from global memory and
+ * writes 261 words of statistics. Link the two with
+ *     [connectivity]
+ *     stream_connect=IMAGE_DIFF_POSTERIZE_AXIS_1.out:POSTERIZE_STATS_1.in
+ * POSTERIZE_STATS_CHAIN connects them with an hls::stream for C-sim (tb_axis_chain.cpp).
+ */
+
+/* POSTERIZE, AXIS OUTPUT
+    - Input  : in_A, in_B frames (512-bit packed)
+    - Output : filtered frame as HEIGHT * CHUNKS_PER_ROW beats in raster order
+
+    Compare and filter overlap in one II=1 loop over the beats. Compared beat t enters a
+    register window of WINDOW_BEATS beats and output beat o = t - CHUNKS_PER_ROW - 1 (one
+    row plus one beat behind) is filtered in the same cycle, from
+        up = window[2 * CHUNKS_PER_ROW + 1]   left  = window[CHUNKS_PER_ROW + 2]
+        mid = window[CHUNKS_PER_ROW + 1]      right = window[CHUNKS_PER_ROW]
+        down = window[1]
+    The window is fully partitioned, so no RAM is read back shortly after it was written.
+*/
+#define WINDOW_BEATS (2 * CHUNKS_PER_ROW + 2)
+
+extern "C" {
+    void IMAGE_DIFF_POSTERIZE_AXIS(const uint512_dt *in_A, const uint512_dt *in_B, hls::stream<pkt_t> &out)
+    {
+        // INTERFACE DIRECTIVES
+        #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem0
+        #pragma HLS INTERFACE m_axi port = in_B offset = slave bundle = gmem1
+        #pragma HLS INTERFACE axis port = out
+        #pragma HLS INTERFACE s_axilite port = in_A bundle = control
+        #pragma HLS INTERFACE s_axilite port = in_B bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        // Compared beats t, t - 1, ..., t - WINDOW_BEATS + 1
+        uint512_dt window[WINDOW_BEATS];
+        #pragma HLS ARRAY_PARTITION variable=window complete
+
+        for (int w = 0; w < WINDOW_BEATS; w++) {
+        #pragma HLS UNROLL
+            window[w] = 0;
+        }
+
+        pkt_t pkt;
+        pkt.keep = -1;
+        pkt.strb = -1;
+
+        const int frame_beats = HEIGHT * CHUNKS_PER_ROW;
+        int row = 0, chunk = 0;     // position of output beat o
+
+        BEATS: for (int t = 0; t < frame_beats + CHUNKS_PER_ROW + 1; t++) {
+        #pragma HLS PIPELINE II=1
+
+            // Compare beat t, zero past the end of the frame
+            uint512_dt res_G = 0;
+            if (t < frame_beats) {
+                uint512_dt val1 = in_A[t];
+                uint512_dt val2 = in_B[t];
+
+                for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+                #pragma HLS UNROLL
+                    pixel_t p1 = val1.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                    pixel_t p2 = val2.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                    res_G.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = Compare(p1, p2);
+                }
+            }
+
+            for (int w = WINDOW_BEATS - 1; w > 0; w--) {
+            #pragma HLS UNROLL
+                window[w] = window[w - 1];
+            }
+            window[0] = res_G;
+
+            // Filter output beat o, the first and last rows are zero
+            if (t >= CHUNKS_PER_ROW + 1) {
+                pixel_t left_px = (chunk > 0) ? (pixel_t)window[CHUNKS_PER_ROW + 2].range(AXI_WIDTH_BITS - 1, AXI_WIDTH_BITS - PIXEL_SIZE) : (pixel_t)0;
+                pixel_t right_px = (chunk < CHUNKS_PER_ROW - 1) ? (pixel_t)window[CHUNKS_PER_ROW].range(PIXEL_SIZE - 1, 0) : (pixel_t)0;
+
+                if (row == 0 || row == HEIGHT - 1) pkt.data = 0;
+                else pkt.data = filter_beat(window[2 * CHUNKS_PER_ROW + 1], window[CHUNKS_PER_ROW + 1], window[1], left_px, right_px, chunk);
+                pkt.last = (row == HEIGHT - 1 && chunk == CHUNKS_PER_ROW - 1);
+                out.write(pkt);
+
+                if (chunk == CHUNKS_PER_ROW - 1) {
+                    chunk = 0;
+                    row++;
+                } else {
+                    chunk++;
+                }
+            }
+        }
+    }
+}
+
+
+/* STATS
+    - Input  : filtered frame beats, up to the one with TLAST
+    - Output : stats[STATS_WORDS] (histogram, nonzero count, bounding box)
+*/
+extern "C" {
+    void POSTERIZE_STATS(hls::stream<pkt_t> &in, uint32_t *stats)
+    {
+        #pragma HLS INTERFACE axis port = in
+        #pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem2 depth = 261
+        #pragma HLS INTERFACE s_axilite port = stats bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        stats_unit_t su;
+        #pragma HLS ARRAY_PARTITION variable=su.lane_hist complete dim=1
+        #pragma HLS DEPENDENCE variable=su.lane_hist inter RAW distance=STATS_DEP_DISTANCE true
+        #pragma HLS ARRAY_PARTITION variable=su.fwd_bin complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=su.fwd_count complete dim=0
+
+        stats_clear(su);
+
+        int row = 0, chunk = 0;
+        bool last = false;
+
+        BEATS: while (!last) {
+        #pragma HLS PIPELINE II=1
+        #pragma HLS LOOP_TRIPCOUNT min=HEIGHT*CHUNKS_PER_ROW max=HEIGHT*CHUNKS_PER_ROW
+            pkt_t pkt = in.read();
+            last = pkt.last;
+
+            stats_beat(su, pkt.data, row, chunk);
+
+            if (chunk == CHUNKS_PER_ROW - 1) {
+                chunk = 0;
+                row++;
+            } else {
+                chunk++;
+            }
+        }
+
+        stats_write(su, stats);
+    }
+}
+
+
+/* C-SIM TOP
+    Posterize straight into stats over an hls::stream, nothing written to global memory
+    but the statistics.
+*/
+void POSTERIZE_STATS_CHAIN(const uint512_dt *in_A, const uint512_dt *in_B, uint32_t *stats) {
+    hls::stream<pkt_t> link;
+    #pragma HLS STREAM variable=link depth=2*CHUNKS_PER_ROW
+    #pragma HLS DATAFLOW
+
+    IMAGE_DIFF_POSTERIZE_AXIS(in_A, in_B, link);
+    POSTERIZE_STATS(link, stats);
+}
+
+
+/* Compare Helper Function
+    - Input  : 2 uint8_t numbers
+    - Output : Quantized absolute difference
+*/
+pixel_t Compare(pixel_t A, pixel_t B){
+    pixel_t C;
+    int16_t temp_d = (int16_t) A - (int16_t) B;
+
+    constexpr uint8_t T1 = 32;
+    constexpr uint8_t T2 = 96;
+
+    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+    if(D < T1) C = (pixel_t) 0;
+    else if(D < T2) C = (pixel_t) 128;
+    else C = (pixel_t) 255;
+
+    return C;
+}
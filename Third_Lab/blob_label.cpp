@@ -0,0 +1,242 @@
+#include <stdint.h>
+#include <ap_int.h>
+#include <ap_axi_sdata.h>
+#include <hls_stream.h>
+
+// Original Image
+#define WIDTH 256
+#define HEIGHT 512
+
+// Transaction Definition
+#define PIXEL_SIZE 8
+#define AXI_WIDTH_BITS 512       // Data width of Memory Access in bits per cycle
+#define AXI_WIDTH_BYTES (AXI_WIDTH_BITS / PIXEL_SIZE)
+#define CHUNKS_PER_ROW (WIDTH / AXI_WIDTH_BYTES)
+
+// Labeler sizing
+#define BLOB_THRESHOLD  1                   // foreground is value >= threshold, any change
+#define MAX_RUNS        (WIDTH / 2)         // a row of alternating pixels
+#define MAX_LABELS      (2 * MAX_RUNS)      // runs of the previous row + new runs of this one
+#define MAX_BLOBS       256
+
+// Result layout, must match common/blob_labeler.hpp (MotionBlob)
+#define BLOBS_COUNT     0       // blobs written
+#define BLOBS_DROPPED   1       // blobs that did not fit in MAX_BLOBS
+#define BLOBS_FIRST     2       // then x0, y0, x1, y1, area per blob
+#define BLOB_WORDS      5
+#define LABEL_NONE      0xFFFF
+
+// Type Definitions
+typedef ap_uint<AXI_WIDTH_BITS> uint512_dt;
+typedef ap_uint<PIXEL_SIZE> pixel_t;
+typedef ap_uint<16> label_t;
+typedef ap_axiu<AXI_WIDTH_BITS, 0, 0, 0> pkt_t;
+
+// Helper Functions
+label_t find_root(const label_t parent[MAX_LABELS], label_t l);
+
+/*
+ * Streaming connected-component labeler (8-connected), the fixed-size version of
+ * common/blob_labeler.hpp. It takes the filtered frame as AXIS beats, e.g. from
+ *     [connectivity]
+ *     stream_connect=IMAGE_DIFF_POSTERIZE_AXIS_1.out:BLOB_LABEL_1.in
+ * and writes the bounding box and area of every blob, in the order the blobs close.
+ *
+ * Per row: the pixels are cut into runs (1 pixel per cycle), every run is joined with
+ * the runs above it by union-find, components the row did not reach are written out,
+ * and the survivors are renumbered so the label tables never outgrow two rows.
+ */
+extern "C" {
+    void BLOB_LABEL(hls::stream<pkt_t> &in, uint32_t *blobs)
+    {
+        #pragma HLS INTERFACE axis port = in
+        #pragma HLS INTERFACE m_axi port = blobs offset = slave bundle = gmem2 depth = 1282
+        #pragma HLS INTERFACE s_axilite port = blobs bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        // Runs of the previous and current row, [start, end)
+        ap_uint<16> prev_start[MAX_RUNS], prev_end[MAX_RUNS];
+        ap_uint<16> cur_start[MAX_RUNS], cur_end[MAX_RUNS];
+        label_t prev_label[MAX_RUNS], cur_label[MAX_RUNS];
+
+        // Union-find and per-label accumulators, valid at the roots
+        label_t parent[MAX_LABELS];
+        label_t remap[MAX_LABELS];
+        ap_uint<16> bx0[MAX_LABELS], by0[MAX_LABELS], bx1[MAX_LABELS], by1[MAX_LABELS];
+        uint32_t area[MAX_LABELS];
+        int last_row[MAX_LABELS];           // -2 once written out
+
+        // Accumulators of the renumbered survivors
+        ap_uint<16> next_x0[MAX_RUNS], next_y0[MAX_RUNS], next_x1[MAX_RUNS], next_y1[MAX_RUNS];
+        uint32_t next_area[MAX_RUNS];
+
+        int n_prev = 0;
+        uint32_t n_blobs = 0, dropped = 0;
+
+        ROWS: for (int row = 0; row < HEIGHT; row++) {
+
+            // 1. Runs of this row
+            int n_cur = 0;
+            bool in_run = false;
+            ap_uint<16> start = 0;
+            uint512_dt beat = 0;
+            RUNS: for (int x = 0; x < WIDTH; x++) {
+            #pragma HLS PIPELINE II=1
+                if (x % AXI_WIDTH_BYTES == 0) beat = in.read().data;
+                int v = x % AXI_WIDTH_BYTES;
+                bool fg = (pixel_t)beat.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) >= BLOB_THRESHOLD;
+
+                if (fg && !in_run) {
+                    start = x;
+                    in_run = true;
+                }
+                if (in_run && (!fg || x == WIDTH - 1)) {
+                    cur_start[n_cur] = start;
+                    cur_end[n_cur] = fg ? x + 1 : x;
+                    n_cur++;
+                    in_run = false;
+                }
+            }
+
+            // 2. Join with the runs above (touching or diagonal), new label otherwise
+            int n_labels = n_prev;
+            int i = 0;
+            LINK: for (int j = 0; j < n_cur; j++) {
+            #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_RUNS
+                SKIP: while (i < n_prev && prev_end[i] + 1 <= cur_start[j]) {
+                #pragma HLS LOOP_TRIPCOUNT min=0 max=2
+                    i++;
+                }
+
+                label_t label = LABEL_NONE;
+                OVERLAP: for (int k = i; k < n_prev && prev_start[k] < cur_end[j] + 1; k++) {
+                #pragma HLS LOOP_TRIPCOUNT min=0 max=2
+                    label_t other = find_root(parent, prev_label[k]);
+                    if (label == LABEL_NONE) {
+                        label = other;
+                    } else if (other != label) {
+                        // Smaller label stays root, as on the CPU
+                        label_t a = (other < label) ? other : label;
+                        label_t b = (other < label) ? label : other;
+                        parent[b] = a;
+                        if (bx0[b] < bx0[a]) bx0[a] = bx0[b];
+                        if (by0[b] < by0[a]) by0[a] = by0[b];
+                        if (bx1[b] > bx1[a]) bx1[a] = bx1[b];
+                        if (by1[b] > by1[a]) by1[a] = by1[b];
+                        area[a] += area[b];
+                        if (last_row[b] > last_row[a]) last_row[a] = last_row[b];
+                        label = a;
+                    }
+                }
+                if (label == LABEL_NONE) {
+                    label = n_labels++;
+                    parent[label] = label;
+                    bx0[label] = cur_start[j];
+                    by0[label] = row;
+                    bx1[label] = cur_end[j] - 1;
+                    area[label] = 0;
+                }
+
+                if (cur_start[j] < bx0[label]) bx0[label] = cur_start[j];
+                if (cur_end[j] - 1 > bx1[label]) bx1[label] = cur_end[j] - 1;
+                by1[label] = row;
+                area[label] += cur_end[j] - cur_start[j];
+                last_row[label] = row;
+                cur_label[j] = label;
+            }
+
+            // 3. Components this row did not reach are final
+            CLOSE: for (int k = 0; k < n_prev; k++) {
+            #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_RUNS
+                label_t root = find_root(parent, prev_label[k]);
+                if (last_row[root] != row && last_row[root] != -2) {
+                    last_row[root] = -2;
+                    if (n_blobs < MAX_BLOBS) {
+                        uint32_t base = BLOBS_FIRST + n_blobs * BLOB_WORDS;
+                        blobs[base + 0] = bx0[root];
+                        blobs[base + 1] = by0[root];
+                        blobs[base + 2] = bx1[root];
+                        blobs[base + 3] = by1[root];
+                        blobs[base + 4] = area[root];
+                        n_blobs++;
+                    } else {
+                        dropped++;
+                    }
+                }
+            }
+
+            // 4. Renumber the survivors 0..n-1, this row becomes the previous one
+            CLEAR_REMAP: for (int l = 0; l < n_labels; l++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_LABELS
+                remap[l] = LABEL_NONE;
+            }
+            int n_next = 0;
+            RENUMBER: for (int j = 0; j < n_cur; j++) {
+            #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_RUNS
+                label_t root = find_root(parent, cur_label[j]);
+                if (remap[root] == LABEL_NONE) {
+                    remap[root] = n_next;
+                    next_x0[n_next] = bx0[root];
+                    next_y0[n_next] = by0[root];
+                    next_x1[n_next] = bx1[root];
+                    next_y1[n_next] = by1[root];
+                    next_area[n_next] = area[root];
+                    n_next++;
+                }
+                prev_start[j] = cur_start[j];
+                prev_end[j] = cur_end[j];
+                prev_label[j] = remap[root];
+            }
+            COMPACT: for (int l = 0; l < n_next; l++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_RUNS
+                parent[l] = l;
+                bx0[l] = next_x0[l];
+                by0[l] = next_y0[l];
+                bx1[l] = next_x1[l];
+                by1[l] = next_y1[l];
+                area[l] = next_area[l];
+                last_row[l] = row;
+            }
+            n_prev = n_cur;
+        }
+
+        // Whatever touches the last row closes with the frame
+        FLUSH: for (int k = 0; k < n_prev; k++) {
+        #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_RUNS
+            label_t root = prev_label[k];
+            if (last_row[root] != -2) {
+                last_row[root] = -2;
+                if (n_blobs < MAX_BLOBS) {
+                    uint32_t base = BLOBS_FIRST + n_blobs * BLOB_WORDS;
+                    blobs[base + 0] = bx0[root];
+                    blobs[base + 1] = by0[root];
+                    blobs[base + 2] = bx1[root];
+                    blobs[base + 3] = by1[root];
+                    blobs[base + 4] = area[root];
+                    n_blobs++;
+                } else {
+                    dropped++;
+                }
+            }
+        }
+
+        blobs[BLOBS_COUNT] = n_blobs;
+        blobs[BLOBS_DROPPED] = dropped;
+    }
+}
+
+
+/* Root of a label
+    - Input  : union-find table, label
+    - Output : root label (roots point to themselves)
+*/
+label_t find_root(const label_t parent[MAX_LABELS], label_t l) {
+    FIND: for (int it = 0; it < MAX_LABELS; it++) {
+    #pragma HLS LOOP_TRIPCOUNT min=1 max=4
+        if (parent[l] == l) break;
+        l = parent[l];
+    }
+    return l;
+}
@@ -27,10 +27,19 @@ typedef enum {
     STREAM
 } FilterState;
 
+// Optional frame statistics of the output (build with -DFRAME_STATS)
+#ifdef FRAME_STATS
+#include "stats_unit.hpp"
+#endif
+
 // Helper Functions
 pixel_t Compare(pixel_t A, pixel_t B);
 void compute_G_stage(const uint512_dt *in1, const uint512_dt *in2, hls::stream<uint512_dt> &stream_G,  unsigned int ref_point);
+#ifdef FRAME_STATS
+void compute_F_stage(hls::stream<uint512_dt> &stream_G, uint512_dt *out, FilterState &state_F, unsigned int row, unsigned int href_point, stats_unit_t &su, bool last_step);
+#else
 void compute_F_stage(hls::stream<uint512_dt> &stream_G, uint512_dt *out, FilterState &state_F, unsigned int row, unsigned int href_point);
+#endif
 
 // TRIPCOUNT identifier
 const unsigned int BUFFER_SIZE = BUFFER_HEIGHT*BUFFER_WIDTH_BYTES;
@@ -39,7 +48,11 @@ const unsigned int c_len = HEIGHT*WIDTH / c_size;
 
 // MAIN
 extern "C" {
+#ifdef FRAME_STATS
+    void IMAGE_DIFF_POSTERIZE(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, unsigned int size, uint32_t *stats)
+#else
     void IMAGE_DIFF_POSTERIZE(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, unsigned int size)
+#endif
     {
         // INTERFACE DIRECTIVES
         #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem1
@@ -51,6 +64,19 @@ extern "C" {
         #pragma HLS INTERFACE s_axilite port = size bundle = control
         #pragma HLS INTERFACE s_axilite port = return bundle = control
 
+#ifdef FRAME_STATS
+        // Histogram, nonzero count and bounding box, STATS_WORDS words written at the end
+        #pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem3 depth = 261
+        #pragma HLS INTERFACE s_axilite port = stats bundle = control
+
+        stats_unit_t su;
+        #pragma HLS ARRAY_PARTITION variable=su.lane_hist complete dim=1
+        #pragma HLS DEPENDENCE variable=su.lane_hist inter RAW distance=STATS_DEP_DISTANCE true
+        #pragma HLS ARRAY_PARTITION variable=su.fwd_bin complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=su.fwd_count complete dim=0
+        stats_clear(su);
+#endif
+
         // Stream to connect Stage 1 of Comparison and Stage 2 of filtering
 
         // Reference point for reading input data
@@ -79,7 +105,11 @@ extern "C" {
                     case 1: State_F = HOLD_1; break;
                     default: State_F = STREAM; break;
                 }
+#ifdef FRAME_STATS
+                compute_F_stage(stream_G, out, State_F, row, local_href_point, su, h_step == h_steps - 1);
+#else
                 compute_F_stage(stream_G, out, State_F, row, local_href_point);
+#endif
             }
         	}
 
@@ -92,15 +122,25 @@ extern "C" {
             out[chunk] = 0;
             out[(HEIGHT-1)*(WIDTH/AXI_WIDTH_BYTES) + chunk] = 0;
         }
+
+#ifdef FRAME_STATS
+        stats_zero_beats(su, 2 * (WIDTH / AXI_WIDTH_BYTES));
+        stats_write(su, stats);
+#endif
     }
 }
 
 
 /* F-STAGE: FILTERING
     - Input  : Stream of compared rows from G stage
-    - Output : Filtered output written to global memory
+    - Output : Filtered output written to global memory, beats that stay in out are
+               added to su when FRAME_STATS is set
 */
+#ifdef FRAME_STATS
+void compute_F_stage(hls::stream<uint512_dt> &stream_G, uint512_dt *out, FilterState &state_F, unsigned int row, unsigned int href_point, stats_unit_t &su, bool last_step) {
+#else
 void compute_F_stage(hls::stream<uint512_dt> &stream_G, uint512_dt *out, FilterState &state_F, unsigned int row, unsigned int href_point) {
+#endif
     static pixel_t Prior_chunk_1[BUFFER_WIDTH_BYTES];
     static pixel_t Prior_chunk_2[BUFFER_WIDTH_BYTES];
     pixel_t Current_chunk[BUFFER_WIDTH_BYTES];
@@ -205,6 +245,11 @@ void compute_F_stage(hls::stream<uint512_dt> &stream_G, uint512_dt *out, FilterS
                 }
 
                 out[write_row_offset + chunk] = out_val;
+#ifdef FRAME_STATS
+                // The next step rewrites the second beat, only the last step keeps it
+                if (chunk == 0 || last_step)
+                    stats_beat(su, out_val, row - 1, href_point / AXI_WIDTH_BYTES + chunk);
+#endif
             }
 
             // Refresh the Chunks
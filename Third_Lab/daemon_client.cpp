@@ -0,0 +1,79 @@
+/**
+ * @file daemon_client.cpp
+ * @brief Short job against a running posterize_daemon
+ *
+ * Connects, generates frames straight into the shared memory, runs them through the
+ * daemon and checks every result against the CPU reference. Prints the connect time
+ * (what replaces xclbin programming for the job) and the per-frame latency.
+ *
+ * Usage: daemon_client [--socket path] [--frames N] [--scene ...] [--seed N] [--sigma N]
+ */
+
+#include "../common/daemon_protocol.hpp"
+#include "../common/benchmark.hpp"
+#include "../common/posterize_sw.hpp"
+#include "../common/verify.hpp"
+#include "../common/workload_gen.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define WIDTH  256
+#define HEIGHT 512
+
+int main(int argc, char **argv) {
+    std::vector<std::string> args(argv, argv + argc);
+    SceneParams scene;
+    parse_workload_args(args, scene);
+
+    std::string socket_path = DAEMON_SOCKET_PATH;
+    int frames = 10;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "--socket" && i + 1 < args.size()) socket_path = args[++i];
+        else if (args[i] == "--frames" && i + 1 < args.size()) frames = std::max(1, atoi(args[++i].c_str()));
+        else {
+            std::cout << "Usage: " << argv[0] << " [--socket path] [--frames N]"
+                      << " [--scene noise|blobs|ramp|sensor] [--seed N] [--sigma N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PosterizeClient client;
+    if (!client.connect(WIDTH, HEIGHT, socket_path)) return EXIT_FAILURE;
+    auto connected = std::chrono::steady_clock::now();
+
+    std::vector<uint8_t> sw_result((size_t)WIDTH * HEIGHT);
+    std::vector<double> latency, service;
+    bool match = true;
+
+    for (int f = 0; f < frames; f++) {
+        scene.frame = f;
+        generate_frame_pair(client.frame_A(), client.frame_B(), WIDTH, HEIGHT, scene);
+
+        uint64_t service_ns = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        int status = client.process(&service_ns);
+        auto t1 = std::chrono::steady_clock::now();
+        if (status != DAEMON_OK) {
+            std::cerr << "Frame " << f << " failed with status " << status << std::endl;
+            return EXIT_FAILURE;
+        }
+        latency.push_back(std::chrono::duration<double>(t1 - t0).count());
+        service.push_back(service_ns * 1e-9);
+
+        IMAGE_DIFF_POSTERIZE_SW(client.frame_A(), client.frame_B(), sw_result.data(), WIDTH, HEIGHT);
+        VerifyResult verify = verify_frames(sw_result.data(), client.output(), WIDTH, HEIGHT);
+        verify_print(verify, WIDTH);
+        match = match && verify.passed();
+    }
+
+    std::cout << "Connected in " << std::chrono::duration<double, std::milli>(connected - start).count() << " ms\n";
+    bench_header();
+    bench_report("Daemon round trip", latency, (size_t)WIDTH * HEIGHT, 0);
+    bench_report("Daemon service time", service, (size_t)WIDTH * HEIGHT, 0);
+
+    std::cout << "\nTEST " << (match ? "PASSED" : "FAILED") << std::endl;
+    return (match ? EXIT_SUCCESS : EXIT_FAILURE);
+}
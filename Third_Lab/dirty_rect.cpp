@@ -0,0 +1,70 @@
+#include <stdint.h>
+#include <ap_int.h>
+
+// Original Image
+#define WIDTH 256
+#define HEIGHT 512
+
+// Transaction Definition
+#define PIXEL_SIZE 8
+#define AXI_WIDTH_BITS 512       // Data width of Memory Access in bits per cycle
+#define AXI_WIDTH_BYTES (AXI_WIDTH_BITS / PIXEL_SIZE)
+#define CHUNKS_PER_ROW (WIDTH / AXI_WIDTH_BYTES)
+
+// Type Definitions
+typedef ap_uint<AXI_WIDTH_BITS> uint512_dt;
+typedef ap_uint<PIXEL_SIZE> pixel_t;
+
+// Helper Functions
+pixel_t Compare(pixel_t A, pixel_t B);
+
+#include "rect_walk.hpp"
+
+/* DIRTY RECTANGLE UPDATE
+    - Input  : in_A, in_B full frames (512-bit packed), out holding the previous result
+    - Output : out rows [row_start, row_end), beats [chunk_start, chunk_end) recomputed in place
+    The host passes a changed rectangle grown by the stencil halo and widened to beats
+    (common/dirty_rect.hpp), so rows 0 and HEIGHT-1 are never touched and the work is
+    proportional to the rectangle instead of the frame. One launch per rectangle.
+*/
+extern "C" {
+    void IMAGE_DIFF_POSTERIZE_RECT(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                                   int row_start, int row_end, int chunk_start, int chunk_end)
+    {
+        // INTERFACE DIRECTIVES
+        #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem0
+        #pragma HLS INTERFACE m_axi port = in_B offset = slave bundle = gmem1
+        #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem2
+        #pragma HLS INTERFACE s_axilite port = in_A bundle = control
+        #pragma HLS INTERFACE s_axilite port = in_B bundle = control
+        #pragma HLS INTERFACE s_axilite port = out bundle = control
+        #pragma HLS INTERFACE s_axilite port = row_start bundle = control
+        #pragma HLS INTERFACE s_axilite port = row_end bundle = control
+        #pragma HLS INTERFACE s_axilite port = chunk_start bundle = control
+        #pragma HLS INTERFACE s_axilite port = chunk_end bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        rect_walk(in_A, in_B, out, row_start, row_end, chunk_start, chunk_end);
+    }
+}
+
+
+/* Compare Helper Function
+    - Input  : 2 uint8_t numbers
+    - Output : Quantized absolute difference
+*/
+pixel_t Compare(pixel_t A, pixel_t B){
+    pixel_t C;
+    int16_t temp_d = (int16_t) A - (int16_t) B;
+
+    constexpr uint8_t T1 = 32;
+    constexpr uint8_t T2 = 96;
+
+    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+    if(D < T1) C = (pixel_t) 0;
+    else if(D < T2) C = (pixel_t) 128;
+    else C = (pixel_t) 255;
+
+    return C;
+}
@@ -1,10 +1,26 @@
 #include "xcl2.hpp"
 #include "event_timer.hpp"
+#include "../common/event_profiler.hpp"
+#include "../common/benchmark.hpp"
+#include "../common/posterize_sw.hpp"
+#include "../common/perf_counters.hpp"
+#include "../common/frame_stats.hpp"
+#include "../common/workload_gen.hpp"
+#include "../common/frame_io.hpp"
+#include "../common/verify.hpp"
+#include "../common/dirty_rect.hpp"
+#include "../common/blob_labeler.hpp"
+#include "../common/morphology.hpp"
+#include "../common/pyramid.hpp"
+#include "../common/result_cache.hpp"
+#include "../common/any_width.hpp"
+#include "../common/posterize_accelerator.hpp"
 #include <algorithm>
 #include <vector>
 #include <iostream>
 #include <fstream>
 #include <stdint.h>
+#include <stdlib.h>
 
 #define WIDTH  256
 #define HEIGHT 512
@@ -19,23 +35,48 @@
 
 #define VECTOR_SIZE AXI_WIDTH_BITS/PIXEL_SIZE  // 512 bits / 8 bits per pixel
 
-#define T1 32
-#define T2 96
+#define KERNEL_CLOCK_MHZ 300.0  // kernel clock used to turn counter cycles into time
 
 const int DATA_SIZE = WIDTH * HEIGHT;
 const int PACKET_COUNT = (DATA_SIZE + VECTOR_SIZE - 1) / VECTOR_SIZE;  // Ceiling division
 
-uint8_t Compare(uint8_t A, uint8_t B);
-void IMAGE_DIFF_POSTERIZE_SW(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out);
-
 int main(int argc, char **argv) {
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " <XCLBIN File>" << std::endl;
+    BenchConfig bench;
+    SceneParams scene;
+    FrameIOConfig frame_io;
+    std::vector<DirtyRect> dirty;
+    BlobConfig blob_cfg;
+    bool blobs_enabled = false;
+    int morph_mode = MORPH_MODE_NONE;
+    PyramidConfig pyramid_cfg;
+    bool pyramid_enabled = false;
+    size_t cache_mb = 0;
+    std::vector<std::pair<int, int>> any_width_sizes;
+    std::vector<std::string> args = parse_bench_args(argc, argv, bench);
+    parse_workload_args(args, scene);
+    parse_frame_io_args(args, frame_io);
+    parse_dirty_args(args, dirty);
+    parse_blob_args(args, blob_cfg, blobs_enabled);
+    parse_morph_args(args, morph_mode);
+    parse_pyramid_args(args, pyramid_cfg, pyramid_enabled);
+    parse_cache_args(args, cache_mb);
+    parse_any_width_args(args, any_width_sizes);
+    if (args.size() < 2 || args.size() > 3 || frame_io.input_a.empty() != frame_io.input_b.empty()) {
+        std::cout << "Usage: " << argv[0] << " <XCLBIN File> [Profile Iterations]"
+                  << " [--scene noise|blobs|ramp|sensor] [--seed N] [--frame N] [--sigma N]"
+                  << " [--input-a <pgm|ppm|raw>[:N] --input-b <pgm|ppm|raw>[:N]] [--output <pgm|raw>]"
+                  << " [--dirty x,y,w,h]..."
+                  << " [--blobs [--blob-threshold N] [--blob-min-area N]]" << " [--morph open|close]"
+                  << " [--pyramid [--pyramid-factor N] [--pyramid-block WxH]]" << " [--any-width WxH]..."
+                  << " [--bench [--warmup N] [--iters N] [--size WxH]... [--cache MB]]" << std::endl;
         return EXIT_FAILURE;
     }
 
     EventTimer et;
-    std::string binaryFile = argv[1];
+    EventProfiler prof;
+    std::string binaryFile = args[1];
+    int profile_iterations = (args.size() == 3) ? atoi(args[2].c_str()) : 1;
+    if (profile_iterations < 1) profile_iterations = 1;
 
     // Calculate buffer size in PACKETS
     size_t packet_size_bytes = AXI_WIDTH_BITS/PIXEL_SIZE;  // 64 bytes per packet
@@ -44,6 +85,16 @@ int main(int argc, char **argv) {
     cl_int err;
     cl::Context context;
     cl:: Kernel kernel;
+    cl::Kernel rect_kernel;
+    bool has_rect_kernel = false;
+    cl::Kernel morph_kernel;
+    bool has_morph_kernel = false;
+    cl::Kernel pyramid_kernel;
+    bool has_pyramid_kernel = false;
+    cl::Kernel any_width_kernel;
+    bool has_any_width_kernel = false;
+    cl::Device device_used;
+    cl::Program program_used;
     cl::CommandQueue q;
 
     // ========== HOST MEMORY ALLOCATION ==========
@@ -58,9 +109,41 @@ int main(int argc, char **argv) {
     et.finish();
 
     // ========== INITIALIZE DATA ==========
+    // Frames from files are used in place: an 8-bit PGM or raw file whose pixels are
+    // page aligned goes to the device straight from the mapping, anything else is
+    // converted once into the reader's aligned scratch frame.
     et.add("Fill the buffers");
-    std::generate(in_A.begin(), in_A.end(), std::rand);
-    std::generate(in_B.begin(), in_B.end(), std::rand);
+    FrameReader reader_A, reader_B;
+    uint8_t *src_A = in_A.data();
+    uint8_t *src_B = in_B.data();
+    if (!frame_io.input_a.empty()) {
+        if (!reader_A.open(frame_io.input_a, WIDTH, HEIGHT) || !reader_B.open(frame_io.input_b, WIDTH, HEIGHT)) {
+            return EXIT_FAILURE;
+        }
+        if (reader_A.width() != WIDTH || reader_A.height() != HEIGHT ||
+            reader_B.width() != WIDTH || reader_B.height() != HEIGHT) {
+            std::cerr << "Input frames must be " << WIDTH << "x" << HEIGHT << " (kernel is compiled for that size)" << std::endl;
+            return EXIT_FAILURE;
+        }
+        // The kernel never writes its inputs, so the read-only mapping can back the buffers
+        src_A = reader_A.frame(frame_io.index_a);
+        src_B = reader_B.frame(frame_io.index_b);
+        if (src_A == nullptr || src_B == nullptr) {
+            std::cerr << "Frame index out of range" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Inputs: " << frame_io.input_a << " [" << frame_io.index_a << "]"
+                  << (reader_A.zero_copy(frame_io.index_a) ? " (zero-copy)" : " (converted)") << ", "
+                  << frame_io.input_b << " [" << frame_io.index_b << "]"
+                  << (reader_B.zero_copy(frame_io.index_b) ? " (zero-copy)" : " (converted)") << std::endl;
+    } else {
+        generate_frame_pair(in_A.data(), in_B.data(), WIDTH, HEIGHT, scene);
+    }
+    // The dirty rectangle pass edits A, so a mapped (read-only) A is copied once
+    if (!dirty.empty() && src_A != in_A.data()) {
+        std::copy(src_A, src_A + DATA_SIZE, in_A.begin());
+        src_A = in_A.data();
+    }
     for(int i=0; i < DATA_SIZE; i++){
     	hw_result[i] = 0;
     	sw_result[i] = 0;
@@ -81,7 +164,12 @@ int main(int argc, char **argv) {
     	std::cout << std::endl;
     } */
     // Compute software reference
-    IMAGE_DIFF_POSTERIZE_SW(in_A. data(), in_B.data(), sw_result.data());
+#ifdef FRAME_STATS
+    uint32_t sw_stats[STATS_WORDS];
+    IMAGE_DIFF_POSTERIZE_SW(src_A, src_B, sw_result.data(), WIDTH, HEIGHT, T1, T2, sw_stats);
+#else
+    IMAGE_DIFF_POSTERIZE_SW(src_A, src_B, sw_result.data(), WIDTH, HEIGHT);
+#endif
     et.finish();
 
     // ========== OPENCL SETUP ==========
@@ -107,6 +195,28 @@ int main(int argc, char **argv) {
 
         std::cout << "Device[" << i << "]: program successful!\n";
         OCL_CHECK(err, kernel = cl::Kernel(program, "IMAGE_DIFF_POSTERIZE", &err));
+        if (!dirty.empty()) {
+            // Optional second kernel (Third_Lab/dirty_rect.cpp), only some xclbins carry it
+            rect_kernel = cl::Kernel(program, "IMAGE_DIFF_POSTERIZE_RECT", &err);
+            has_rect_kernel = (err == CL_SUCCESS);
+        }
+        if (morph_mode != MORPH_MODE_NONE) {
+            // Optional fused open/close kernel (Third_Lab/morph_fused.cpp)
+            morph_kernel = cl::Kernel(program, "IMAGE_DIFF_POSTERIZE_MORPH", &err);
+            has_morph_kernel = (err == CL_SUCCESS);
+        }
+        if (pyramid_enabled) {
+            // Optional coarse-to-fine kernel (Third_Lab/pyramid.cpp)
+            pyramid_kernel = cl::Kernel(program, "IMAGE_DIFF_POSTERIZE_PYRAMID", &err);
+            has_pyramid_kernel = (err == CL_SUCCESS);
+        }
+        if (!any_width_sizes.empty()) {
+            // Optional runtime-size kernel (Third_Lab/any_width.cpp)
+            any_width_kernel = cl::Kernel(program, "IMAGE_DIFF_POSTERIZE_ANY_WIDTH", &err);
+            has_any_width_kernel = (err == CL_SUCCESS);
+        }
+        device_used = device;
+        program_used = program;
         device_found = true;
         break;
     }
@@ -125,16 +235,32 @@ int main(int argc, char **argv) {
 
     OCL_CHECK(err, cl::Buffer buffer_in_A(
         context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
-        pixel_buffer_bytes, in_A.data(), &err));
+        pixel_buffer_bytes, src_A, &err));
 
     OCL_CHECK(err, cl::Buffer buffer_in_B(
         context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
-        pixel_buffer_bytes, in_B.data(), &err));
+        pixel_buffer_bytes, src_B, &err));
 
     OCL_CHECK(err, cl::Buffer buffer_out(
         context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
         pixel_buffer_bytes, hw_result.data(), &err));
 
+#ifdef PERF_COUNTERS
+    // Kernel built with -DPERF_COUNTERS writes its counters here at the end of each run
+    std::vector<uint64_t, aligned_allocator<uint64_t>> perf_regs(PERF_NUM_COUNTERS, 0);
+    OCL_CHECK(err, cl::Buffer buffer_perf(
+        context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+        PERF_NUM_COUNTERS * sizeof(uint64_t), perf_regs.data(), &err));
+#endif
+
+#ifdef FRAME_STATS
+    // Kernel built with -DFRAME_STATS writes the output statistics here
+    std::vector<uint32_t, aligned_allocator<uint32_t>> hw_stats(STATS_WORDS, 0);
+    OCL_CHECK(err, cl::Buffer buffer_stats(
+        context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+        STATS_WORDS * sizeof(uint32_t), hw_stats.data(), &err));
+#endif
+
     et.finish();
 
     // ========== KERNEL EXECUTION ==========
@@ -142,20 +268,64 @@ int main(int argc, char **argv) {
     OCL_CHECK(err, err = kernel.setArg(0, buffer_in_A));
     OCL_CHECK(err, err = kernel.setArg(1, buffer_in_B));
     OCL_CHECK(err, err = kernel.setArg(2, buffer_out));
+#ifdef PERF_COUNTERS
+    OCL_CHECK(err, err = kernel.setArg(3, buffer_perf));
+#endif
+#ifdef FRAME_STATS
+#ifdef PERF_COUNTERS
+    OCL_CHECK(err, err = kernel.setArg(4, buffer_stats));
+#else
+    OCL_CHECK(err, err = kernel.setArg(3, buffer_stats));
+#endif
+#endif
     et.finish();
 
+    // Every command signals an event so the device-side timestamps can be read back.
+    // The wall-clock entries below only show how long the enqueue calls take to return.
     et.add("Copy input data to device");
-    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in_A, buffer_in_B}, 0));
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in_A, buffer_in_B}, 0, nullptr, prof.event("Migrate inputs to device")));
     et.finish();
 
     et.add("Launch Kernel");
-    OCL_CHECK(err, err = q. enqueueTask(kernel));
+    OCL_CHECK(err, err = q. enqueueTask(kernel, nullptr, prof.event("Kernel")));
     et.finish();
 
     et.add("Copy results from device");
-    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_out}, CL_MIGRATE_MEM_OBJECT_HOST));
+#ifdef FRAME_STATS
+    // Statistics first: a frame without a single changed pixel is all zeros, so
+    // there is no need to move the output across PCIe at all
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, prof.event("Migrate stats to host")));
+    OCL_CHECK(err, err = q.finish());
+    if (hw_stats[STATS_NONZERO] == 0) {
+        std::cout << "Quiet frame, output read-back skipped\n";
+        std::fill(hw_result.begin(), hw_result.end(), 0);
+    } else {
+        OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_out}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, prof.event("Migrate output to host")));
+    }
+#else
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_out}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, prof.event("Migrate output to host")));
+#endif
+#ifdef PERF_COUNTERS
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_perf}, CL_MIGRATE_MEM_OBJECT_HOST));
+#endif
     OCL_CHECK(err, err = q.finish());
     et.finish();
+    prof.collect();
+
+    // ========== DEVICE PROFILING ==========
+    // Extra iterations only feed the percentile statistics, the results of the
+    // first run above are the ones that get verified.
+    if (profile_iterations > 1) {
+        et.add("Profile device execution");
+        for (int it = 1; it < profile_iterations; it++) {
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in_A, buffer_in_B}, 0, nullptr, prof.event("Migrate inputs to device")));
+            OCL_CHECK(err, err = q.enqueueTask(kernel, nullptr, prof.event("Kernel")));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_out}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, prof.event("Migrate output to host")));
+            OCL_CHECK(err, err = q.finish());
+            prof.collect();
+        }
+        et.finish();
+    }
 
     // ========== EXPORT RESULTS ==========
     et. add("Export results to file");
@@ -176,69 +346,348 @@ int main(int argc, char **argv) {
     }
     et.finish();
 
-    // ========== VERIFICATION ==========
-    et.add("Verify results");
-    bool match = true;
-    int mismatch_count = 0;
-    for (int i = 0; i < DATA_SIZE; i++) {
-        if (sw_result[i] != hw_result[i]) {
-            if (mismatch_count < 10) {  // Print first 10 errors
-                std::cout << "Mismatch at i=" << i
-                          << " (row=" << i/WIDTH << ", col=" << i%WIDTH << "): "
-                          << "SW=" << (int)sw_result[i] << " "
-                          << "HW=" << (int)hw_result[i] << std::endl;
-            }
-            mismatch_count++;
-            match = false;
+    if (!frame_io.output.empty()) {
+        et.add("Write output frame");
+        FrameWriter writer;
+        if (writer.open(frame_io.output, frame_format_for(frame_io.output), WIDTH, HEIGHT) &&
+            writer.write_frame(hw_result.data())) {
+            std::cout << "Device result written to " << frame_io.output << "\n";
         }
+        writer.close();
+        et.finish();
     }
-    if (mismatch_count > 10) {
-        std::cout << "...  and " << (mismatch_count - 10) << " more mismatches\n";
+
+    // ========== VERIFICATION ==========
+    et.add("Verify results");
+    VerifyResult verify = verify_frames(sw_result.data(), hw_result.data(), WIDTH, HEIGHT);
+    verify_print(verify, WIDTH);
+    bool match = verify.passed();
+#ifdef FRAME_STATS
+    std::cout << "Device frame statistics:\n";
+    frame_stats_print(hw_stats.data());
+    if (!std::equal(hw_stats.begin(), hw_stats.end(), sw_stats)) {
+        std::cout << "Frame statistics differ from the software reference\n";
+        match = false;
     }
+#endif
     et.finish();
 
-    std::cout << "\n----------------- Key execution times -----------------\n";
-    et.print();
+    // ========== MOTION BLOBS ==========
+    // Connected groups of changed pixels in the device output, labeled row by row
+    if (blobs_enabled) {
+        et.add("Extract motion blobs");
+        std::vector<MotionBlob> blobs = blob_extract(hw_result.data(), WIDTH, HEIGHT, blob_cfg);
+        et.finish();
+        blob_print(blobs);
+    }
 
-    std::cout << "\nTEST " << (match ? "PASSED" : "FAILED") << std::endl;
-    return (match ? EXIT_SUCCESS : EXIT_FAILURE);
-}
+    // ========== FUSED MORPHOLOGY ==========
+    // Posterize and open/close in one pass on the device, against posterize followed
+    // by two separate 3x3 passes on the host
+    if (morph_mode != MORPH_MODE_NONE) {
+        et.add("Fused open/close");
+        std::vector<uint8_t, aligned_allocator<uint8_t>> morph_sw_result(DATA_SIZE);
+        std::vector<uint8_t, aligned_allocator<uint8_t>> morph_hw_result(DATA_SIZE);
+        IMAGE_DIFF_POSTERIZE_MORPH_SW(src_A, src_B, morph_sw_result.data(), WIDTH, HEIGHT, morph_mode);
+
+        if (has_morph_kernel) {
+            // Own output buffer: the device copy of the plain output stays intact for the
+            // dirty-rectangle section, which reads whole rows of buffer_out back
+            OCL_CHECK(err, cl::Buffer buffer_morph_out(
+                context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                pixel_buffer_bytes, morph_hw_result.data(), &err));
+            OCL_CHECK(err, err = morph_kernel.setArg(0, buffer_in_A));
+            OCL_CHECK(err, err = morph_kernel.setArg(1, buffer_in_B));
+            OCL_CHECK(err, err = morph_kernel.setArg(2, buffer_morph_out));
+            OCL_CHECK(err, err = morph_kernel.setArg(3, (unsigned int)morph_mode));
+            OCL_CHECK(err, err = q.enqueueTask(morph_kernel, nullptr, prof.event("Morph kernel")));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_morph_out}, CL_MIGRATE_MEM_OBJECT_HOST,
+                                                            nullptr, prof.event("Morph output to host")));
+            OCL_CHECK(err, err = q.finish());
+            prof.collect();
+
+            VerifyResult verify_morph = verify_frames(morph_sw_result.data(), morph_hw_result.data(), WIDTH, HEIGHT);
+            std::cout << "Fused " << (morph_mode == MORPH_MODE_OPEN ? "open" : "close") << ": device "
+                      << (verify_morph.passed() ? "matches" : "DIFFERS from") << " host reference\n";
+            verify_print(verify_morph, WIDTH);
+            match = match && verify_morph.passed();
+        } else {
+            std::cout << "xclbin has no IMAGE_DIFF_POSTERIZE_MORPH, host reference only\n";
+        }
+        et.finish();
+    }
 
-uint8_t Compare(uint8_t A, uint8_t B) {
-    int16_t temp_d = (int16_t)A - (int16_t)B;
-    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+    // ========== COARSE-TO-FINE ==========
+    // Coarse pass on the host picks the active blocks, the device computes only those
+    // and writes zeros elsewhere. Exact against the plain output unless a change falls
+    // between the sampling points.
+    if (pyramid_enabled) {
+        et.add("Coarse-to-fine pass");
+        std::vector<uint8_t, aligned_allocator<uint8_t>> pyramid_sw_result(DATA_SIZE);
+        std::vector<DirtyRect> active;
+        IMAGE_DIFF_POSTERIZE_SW_PYRAMID(src_A, src_B, pyramid_sw_result.data(), WIDTH, HEIGHT, pyramid_cfg, &active);
+        VerifyResult verify_full = verify_frames(sw_result.data(), pyramid_sw_result.data(), WIDTH, HEIGHT);
+        std::cout << "Coarse-to-fine (factor " << pyramid_cfg.factor << ", blocks " << pyramid_cfg.block_w << "x"
+                  << pyramid_cfg.block_h << "): " << active.size() << " active regions, "
+                  << 100.0 * pyramid_coverage(active, WIDTH, HEIGHT) << "% of the frame at full resolution, "
+                  << verify_full.mismatches << " pixels differ from the full computation\n";
+
+        std::vector<int> block_list = pyramid_block_list(active, WIDTH, HEIGHT, VECTOR_SIZE);
+        const int n_blocks = (int)block_list.size() / 4;
+        if (has_pyramid_kernel && n_blocks > PYRAMID_MAX_BLOCKS) {
+            std::cout << "More than " << PYRAMID_MAX_BLOCKS << " active regions, device run skipped\n";
+        } else if (has_pyramid_kernel && n_blocks > 0) {
+            std::vector<uint8_t, aligned_allocator<uint8_t>> pyramid_hw_result(DATA_SIZE);
+            std::vector<int, aligned_allocator<int>> block_args(block_list.begin(), block_list.end());
+            OCL_CHECK(err, cl::Buffer buffer_blocks(
+                context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                block_args.size() * sizeof(int), block_args.data(), &err));
+            // Own output buffer, buffer_out keeps the plain output for the dirty-rectangle section
+            OCL_CHECK(err, cl::Buffer buffer_pyramid_out(
+                context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                pixel_buffer_bytes, pyramid_hw_result.data(), &err));
+            OCL_CHECK(err, err = pyramid_kernel.setArg(0, buffer_in_A));
+            OCL_CHECK(err, err = pyramid_kernel.setArg(1, buffer_in_B));
+            OCL_CHECK(err, err = pyramid_kernel.setArg(2, buffer_pyramid_out));
+            OCL_CHECK(err, err = pyramid_kernel.setArg(3, buffer_blocks));
+            OCL_CHECK(err, err = pyramid_kernel.setArg(4, n_blocks));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_blocks}, 0, nullptr, prof.event("Block list to device")));
+            OCL_CHECK(err, err = q.enqueueTask(pyramid_kernel, nullptr, prof.event("Pyramid kernel")));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_pyramid_out}, CL_MIGRATE_MEM_OBJECT_HOST,
+                                                            nullptr, prof.event("Pyramid output to host")));
+            OCL_CHECK(err, err = q.finish());
+            prof.collect();
+
+            VerifyResult verify_pyramid = verify_frames(pyramid_sw_result.data(), pyramid_hw_result.data(), WIDTH, HEIGHT);
+            std::cout << "Coarse-to-fine: device " << (verify_pyramid.passed() ? "matches" : "DIFFERS from") << " host reference\n";
+            verify_print(verify_pyramid, WIDTH);
+            match = match && verify_pyramid.passed();
+        } else if (!has_pyramid_kernel) {
+            std::cout << "xclbin has no IMAGE_DIFF_POSTERIZE_PYRAMID, host reference only\n";
+        }
+        et.finish();
+    }
 
-    if (D < T1) return 0;
-    else if (D < T2) return 128;
-    else return 255;
-}
+    // ========== DIRTY RECTANGLES ==========
+    // Change A inside the rectangles, as the next captured frame would, then patch the
+    // previous outputs instead of recomputing the frames. Only the rows a rectangle
+    // touches are transferred, so cost follows the changed area.
+    if (!dirty.empty()) {
+        et.add("Dirty rectangle update");
+        for (const DirtyRect &r : dirty) {
+            for (int row = r.y; row < std::min(HEIGHT, r.y + r.h); row++) {
+                for (int col = r.x; col < std::min(WIDTH, r.x + r.w); col++) {
+                    src_A[row * WIDTH + col] ^= 0x5A;
+                }
+            }
+        }
+        IMAGE_DIFF_POSTERIZE_SW_RECTS(src_A, src_B, sw_result.data(), WIDTH, HEIGHT, dirty);
+
+        if (has_rect_kernel) {
+            OCL_CHECK(err, err = rect_kernel.setArg(0, buffer_in_A));
+            OCL_CHECK(err, err = rect_kernel.setArg(1, buffer_in_B));
+            OCL_CHECK(err, err = rect_kernel.setArg(2, buffer_out));
+            for (const DirtyRect &r : dirty) {
+                RectLaunch launch;
+                if (!dirty_rect_launch(r, WIDTH, HEIGHT, launch, VECTOR_SIZE)) continue;
+
+                size_t in_offset = (size_t)r.y * WIDTH;
+                size_t in_bytes = (size_t)(std::min(HEIGHT, r.y + r.h) - r.y) * WIDTH;
+                size_t out_offset = (size_t)launch.row_start * WIDTH;
+                size_t out_bytes = (size_t)(launch.row_end - launch.row_start) * WIDTH;
+
+                OCL_CHECK(err, err = rect_kernel.setArg(3, launch.row_start));
+                OCL_CHECK(err, err = rect_kernel.setArg(4, launch.row_end));
+                OCL_CHECK(err, err = rect_kernel.setArg(5, launch.chunk_start));
+                OCL_CHECK(err, err = rect_kernel.setArg(6, launch.chunk_end));
+                OCL_CHECK(err, err = q.enqueueWriteBuffer(buffer_in_A, CL_FALSE, in_offset, in_bytes, src_A + in_offset,
+                                                          nullptr, prof.event("Dirty rows to device")));
+                OCL_CHECK(err, err = q.enqueueTask(rect_kernel, nullptr, prof.event("Dirty rect kernel")));
+                OCL_CHECK(err, err = q.enqueueReadBuffer(buffer_out, CL_FALSE, out_offset, out_bytes, hw_result.data() + out_offset,
+                                                         nullptr, prof.event("Dirty rows to host")));
+                OCL_CHECK(err, err = q.finish());
+                prof.collect();
+            }
+        } else {
+            std::cout << "xclbin has no IMAGE_DIFF_POSTERIZE_RECT, patching on the host only\n";
+        }
 
-void IMAGE_DIFF_POSTERIZE_SW(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out) {
-    // First pass: compute difference
-    uint8_t diff[DATA_SIZE];
-    for (int i = 0; i < DATA_SIZE; i++) {
-        diff[i] = Compare(in_A[i], in_B[i]);
+        // Patched outputs must equal a full recompute of the edited frames
+        std::vector<uint8_t, aligned_allocator<uint8_t>> full_result(DATA_SIZE);
+        IMAGE_DIFF_POSTERIZE_SW(src_A, src_B, full_result.data(), WIDTH, HEIGHT);
+        VerifyResult verify_sw = verify_frames(full_result.data(), sw_result.data(), WIDTH, HEIGHT);
+        std::cout << "Dirty rectangles (" << dirty.size() << "): host patch "
+                  << (verify_sw.passed() ? "matches" : "DIFFERS") << " full recompute";
+        match = match && verify_sw.passed();
+        if (has_rect_kernel) {
+            VerifyResult verify_hw = verify_frames(full_result.data(), hw_result.data(), WIDTH, HEIGHT);
+            std::cout << ", device patch " << (verify_hw.passed() ? "matches" : "DIFFERS") << "\n";
+            verify_print(verify_hw, WIDTH);
+            match = match && verify_hw.passed();
+        } else {
+            std::cout << ", device patch check skipped\n";
+        }
+        et.finish();
     }
 
-    // Second pass:  apply filter
-    for (int row = 0; row < HEIGHT; row++) {
-        for (int col = 0; col < WIDTH; col++) {
-            int idx = row * WIDTH + col;
+    // ========== ANY WIDTH ==========
+    // Frames whose width is not a multiple of 64 pixels, through the runtime-size kernel.
+    // Buffers are whole beats with zero padding, the kernel reads and writes full beats.
+    if (!any_width_sizes.empty()) {
+        et.add("Any-width frames");
+        if (!has_any_width_kernel) {
+            std::cout << "xclbin has no IMAGE_DIFF_POSTERIZE_ANY_WIDTH, skipping --any-width\n";
+        }
+        for (size_t s = 0; has_any_width_kernel && s < any_width_sizes.size(); s++) {
+            int aw = any_width_sizes[s].first;
+            int ah = any_width_sizes[s].second;
+            size_t frame_bytes = any_width_frame_bytes(aw, ah);
+
+            std::vector<uint8_t, aligned_allocator<uint8_t>> aw_A(frame_bytes, 0);
+            std::vector<uint8_t, aligned_allocator<uint8_t>> aw_B(frame_bytes, 0);
+            std::vector<uint8_t, aligned_allocator<uint8_t>> aw_hw(frame_bytes, 0);
+            std::vector<uint8_t, aligned_allocator<uint8_t>> aw_sw((size_t)aw * ah);
+            generate_frame_pair(aw_A.data(), aw_B.data(), aw, ah, scene);
+            IMAGE_DIFF_POSTERIZE_SW(aw_A.data(), aw_B.data(), aw_sw.data(), aw, ah);
+
+            OCL_CHECK(err, cl::Buffer aw_buffer_A(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, frame_bytes, aw_A.data(), &err));
+            OCL_CHECK(err, cl::Buffer aw_buffer_B(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, frame_bytes, aw_B.data(), &err));
+            OCL_CHECK(err, cl::Buffer aw_buffer_out(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, frame_bytes, aw_hw.data(), &err));
+
+            OCL_CHECK(err, err = any_width_kernel.setArg(0, aw_buffer_A));
+            OCL_CHECK(err, err = any_width_kernel.setArg(1, aw_buffer_B));
+            OCL_CHECK(err, err = any_width_kernel.setArg(2, aw_buffer_out));
+            OCL_CHECK(err, err = any_width_kernel.setArg(3, aw));
+            OCL_CHECK(err, err = any_width_kernel.setArg(4, ah));
+
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({aw_buffer_A, aw_buffer_B}, 0, nullptr, prof.event("Any-width inputs to device")));
+            OCL_CHECK(err, err = q.enqueueTask(any_width_kernel, nullptr, prof.event("Any-width kernel")));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({aw_buffer_out}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, prof.event("Any-width output to host")));
+            OCL_CHECK(err, err = q.finish());
+            prof.collect();
+
+            VerifyResult verify_aw = verify_frames(aw_sw.data(), aw_hw.data(), aw, ah);
+            std::cout << "Any-width " << aw << "x" << ah << " (" << frame_bytes / ANY_WIDTH_BEAT_BYTES << " beats): "
+                      << (verify_aw.passed() ? "matches" : "DIFFERS from") << " the CPU reference\n";
+            verify_print(verify_aw, aw);
+            match = match && verify_aw.passed();
+        }
+        et.finish();
+    }
 
-            // Handle borders
-            if (row == 0 || row == HEIGHT-1 || col == 0 || col == WIDTH-1) {
-                out[idx] = 0;
-                continue;
+    // ========== BENCHMARK ==========
+    // Warm caches, pages and driver first, then time every iteration separately.
+    // Device runs always use the compiled WIDTH x HEIGHT, --size only applies to the CPU reference.
+    if (bench.enabled) {
+        et.add("Benchmark");
+        EventProfiler bench_prof;
+        const size_t frame_bytes = DATA_SIZE * sizeof(uint8_t);
+
+        auto device_frame = [&]() {
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in_A, buffer_in_B}, 0, nullptr, bench_prof.event("Migrate inputs to device")));
+            OCL_CHECK(err, err = q.enqueueTask(kernel, nullptr, bench_prof.event("Kernel")));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_out}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, bench_prof.event("Migrate output to host")));
+            OCL_CHECK(err, err = q.finish());
+        };
+        bench_run(device_frame, bench.warmup, 0);
+        bench_prof.clear();
+        std::vector<double> e2e = bench_run(device_frame, 0, bench.iterations);
+        bench_prof.collect();
+
+        std::cout << "\n----------------- Benchmark (" << WIDTH << "x" << HEIGHT << ", "
+                  << bench.warmup << " warmup) -----------------\n";
+        bench_header();
+        bench_report("Device end-to-end", e2e, DATA_SIZE, 3 * frame_bytes);
+        bench_report("Device kernel only", ns_to_seconds(bench_prof.exec_times("Kernel")), DATA_SIZE, 3 * frame_bytes);
+        bench_report("Host->device migrate", ns_to_seconds(bench_prof.exec_times("Migrate inputs to device")), DATA_SIZE, 2 * frame_bytes);
+        bench_report("Device->host migrate", ns_to_seconds(bench_prof.exec_times("Migrate output to host")), DATA_SIZE, frame_bytes);
+
+#if !defined(PERF_COUNTERS) && !defined(FRAME_STATS)
+        // Same kernel through the asynchronous front end: depth frames kept in flight
+        // so transfers of one frame overlap the kernel run of the next. The accelerator
+        // only binds in_A, in_B and out, so builds with a perf or stats argument skip it
+        {
+            PosterizeAccelerator accel(context, device_used, program_used, WIDTH, HEIGHT);
+            std::vector<uint8_t, aligned_allocator<uint8_t>> async_out((size_t)accel.depth() * DATA_SIZE);
+            bool async_ok = accel.ok();
+            auto batch = [&]() {
+                std::vector<std::future<bool>> done;
+                for (int f = 0; f < accel.depth(); f++) {
+                    done.push_back(accel.submit(src_A, src_B, async_out.data() + (size_t)f * DATA_SIZE));
+                }
+                for (auto &d : done) async_ok = d.get() && async_ok;
+            };
+            std::vector<double> async;
+            if (async_ok) async = bench_run(batch, bench.warmup, bench.iterations);
+            if (async_ok) {
+                bench_report("Device async x" + std::to_string(accel.depth()) + " (per batch)", async,
+                             (size_t)accel.depth() * DATA_SIZE, (size_t)accel.depth() * 3 * frame_bytes);
+            } else {
+                // Failed submits finish early, timing them would report a bogus rate
+                std::cout << "Device async run failed, no timing reported" << std::endl;
+                match = false;
             }
+        }
+#endif
 
-            // 5-point stencil
-            int16_t temp = 5 * diff[idx]
-                         - diff[(row-1) * WIDTH + col]      // top
-                         - diff[(row+1) * WIDTH + col]      // bottom
-                         - diff[row * WIDTH + (col-1)]      // left
-                         - diff[row * WIDTH + (col+1)];     // right
+        // Replayed pair through the result cache: the first call misses and runs the
+        // device, every timed one is a hit (hash of both inputs + copy, no device)
+        if (cache_mb > 0) {
+            ResultCache cache(cache_mb << 20);
+            std::vector<uint8_t, aligned_allocator<uint8_t>> cached_out(DATA_SIZE);
+            auto cached_frame = [&]() {
+                FrameHash key = frame_pair_hash(src_A, src_B, WIDTH, HEIGHT, T1, T2);
+                if (cache.lookup(key, cached_out.data(), frame_bytes)) return;
+                device_frame();
+                std::copy(hw_result.begin(), hw_result.end(), cached_out.begin());
+                cache.insert(key, cached_out.data(), frame_bytes);
+            };
+            cached_frame();
+            std::vector<double> hits = bench_run(cached_frame, bench.warmup, bench.iterations);
+            bench_report("Result cache hit", hits, DATA_SIZE, 2 * frame_bytes);
+            cache.print_stats();
+            if (!std::equal(cached_out.begin(), cached_out.end(), hw_result.begin())) {
+                std::cout << "Result cache returned a different frame than the device" << std::endl;
+                match = false;
+            }
+        }
 
-            out[idx] = (temp < 0) ? 0 : ((temp > 255) ? 255 : temp);
+        if (bench.sizes.empty()) bench.sizes.push_back({WIDTH, HEIGHT});
+        for (const auto &size : bench.sizes) {
+            size_t pixels = (size_t)size.first * size.second;
+            std::vector<uint8_t, aligned_allocator<uint8_t>> a(pixels), b(pixels), c(pixels);
+            generate_frame_pair(a.data(), b.data(), size.first, size.second, scene);
+
+            std::vector<double> sw = bench_run([&]() {
+                IMAGE_DIFF_POSTERIZE_SW(a.data(), b.data(), c.data(), size.first, size.second);
+            }, bench.warmup, bench.iterations);
+            bench_report("CPU IMAGE_DIFF_POSTERIZE_SW " + std::to_string(size.first) + "x" + std::to_string(size.second),
+                         sw, pixels, 3 * pixels);
         }
+        et.finish();
     }
+
+    std::cout << "\n----------------- Key execution times -----------------\n";
+    et.print();
+
+    std::cout << "\n----------------- Device execution times -----------------\n";
+    prof.print();
+    if (prof.export_json("../device_profile.json")) {
+        std::cout << "Device profile written to ../device_profile.json\n";
+    }
+
+#ifdef PERF_COUNTERS
+    // Emulation has no real clock behind the counters, fall back to the C-sim model there
+    std::cout << "\n----------------- Kernel performance counters -----------------\n";
+    if (getenv("XCL_EMULATION_MODE") != nullptr) {
+        uint64_t modeled[PERF_NUM_COUNTERS];
+        perf_model(WIDTH, HEIGHT, modeled);
+        perf_print(modeled, KERNEL_CLOCK_MHZ, true);
+    } else {
+        perf_print(perf_regs.data(), KERNEL_CLOCK_MHZ, false);
+    }
+#endif
+
+    std::cout << "\nTEST " << (match ? "PASSED" : "FAILED") << std::endl;
+    return (match ? EXIT_SUCCESS : EXIT_FAILURE);
 }
@@ -0,0 +1,142 @@
+#include <stdint.h>
+#include <ap_int.h>
+
+/*
+ * Memory system microbenchmarks for the kernel AXI ports
+ *
+ * Small kernels that only move data through m_axi bundles laid out like the posterize
+ * kernels (inputs on gmem0 / gmem1, output on gmem2), so their bandwidth is the ceiling
+ * the real kernels can reach. The port parameters are compile time, one xclbin per
+ * configuration:
+ *     -DMB_WORD_BITS=N      data width of the ports (default 512)
+ *     -DMB_BURST_LEN=N      max_read/write_burst_length in words (default 64)
+ *     -DMB_OUTSTANDING=N    num_read/write_outstanding (default 16)
+ * MEM_CONFIG reports them so the host (mem_bench_host.cpp) can label its table.
+ *
+ * Every kernel leaves something the host can check: reads fold the words they read
+ * with XOR, writes store a counting pattern, copies duplicate the input.
+ */
+
+#ifndef MB_WORD_BITS
+#define MB_WORD_BITS 512
+#endif
+#ifndef MB_BURST_LEN
+#define MB_BURST_LEN 64
+#endif
+#ifndef MB_OUTSTANDING
+#define MB_OUTSTANDING 16
+#endif
+
+#define MB_LANES_32 (MB_WORD_BITS / 32)    // 32-bit words per port word
+
+// MEM_CONFIG layout, must match mem_bench_host.cpp
+#define MB_CFG_WORD_BITS    0
+#define MB_CFG_BURST_LEN    1
+#define MB_CFG_OUTSTANDING  2
+#define MB_CFG_WORDS        3
+
+typedef ap_uint<MB_WORD_BITS> mb_word_t;
+
+extern "C" {
+
+/* CONFIG
+    - Output : cfg[MB_CFG_WORDS], the port parameters this xclbin was built with
+*/
+void MEM_CONFIG(uint32_t *cfg)
+{
+    #pragma HLS INTERFACE m_axi port = cfg offset = slave bundle = gmem2 depth = 3
+    #pragma HLS INTERFACE s_axilite port = cfg bundle = control
+    #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    cfg[MB_CFG_WORD_BITS] = MB_WORD_BITS;
+    cfg[MB_CFG_BURST_LEN] = MB_BURST_LEN;
+    cfg[MB_CFG_OUTSTANDING] = MB_OUTSTANDING;
+}
+
+/* READ ONLY (stride 1) / STRIDED READ (stride > 1)
+    - Input  : in, words words taken every stride words
+    - Output : result[0] = XOR of the words read
+    Any stride above 1 breaks the bursts, each word becomes its own transaction.
+*/
+void MEM_READ(const mb_word_t *in, mb_word_t *result, int words, int stride)
+{
+    #pragma HLS INTERFACE m_axi port = in offset = slave bundle = gmem0 max_read_burst_length = MB_BURST_LEN num_read_outstanding = MB_OUTSTANDING
+    #pragma HLS INTERFACE m_axi port = result offset = slave bundle = gmem2 depth = 1
+    #pragma HLS INTERFACE s_axilite port = in bundle = control
+    #pragma HLS INTERFACE s_axilite port = result bundle = control
+    #pragma HLS INTERFACE s_axilite port = words bundle = control
+    #pragma HLS INTERFACE s_axilite port = stride bundle = control
+    #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    mb_word_t fold = 0;
+    READ: for (int i = 0; i < words; i++) {
+    #pragma HLS PIPELINE II=1
+        fold ^= in[(size_t)i * stride];
+    }
+    result[0] = fold;
+}
+
+/* TWO-STREAM READ
+    - Input  : in_A on gmem0 and in_B on gmem1, words words each, read in the same cycle
+    - Output : result[0] = XOR of all words read
+*/
+void MEM_READ2(const mb_word_t *in_A, const mb_word_t *in_B, mb_word_t *result, int words)
+{
+    #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem0 max_read_burst_length = MB_BURST_LEN num_read_outstanding = MB_OUTSTANDING
+    #pragma HLS INTERFACE m_axi port = in_B offset = slave bundle = gmem1 max_read_burst_length = MB_BURST_LEN num_read_outstanding = MB_OUTSTANDING
+    #pragma HLS INTERFACE m_axi port = result offset = slave bundle = gmem2 depth = 1
+    #pragma HLS INTERFACE s_axilite port = in_A bundle = control
+    #pragma HLS INTERFACE s_axilite port = in_B bundle = control
+    #pragma HLS INTERFACE s_axilite port = result bundle = control
+    #pragma HLS INTERFACE s_axilite port = words bundle = control
+    #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    mb_word_t fold = 0;
+    READ2: for (int i = 0; i < words; i++) {
+    #pragma HLS PIPELINE II=1
+        fold ^= in_A[i] ^ in_B[i];
+    }
+    result[0] = fold;
+}
+
+/* WRITE ONLY
+    - Output : out seen as 32-bit words holds 0, 1, 2, ... (words port words)
+*/
+void MEM_WRITE(mb_word_t *out, int words)
+{
+    #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem2 max_write_burst_length = MB_BURST_LEN num_write_outstanding = MB_OUTSTANDING
+    #pragma HLS INTERFACE s_axilite port = out bundle = control
+    #pragma HLS INTERFACE s_axilite port = words bundle = control
+    #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    WRITE: for (int i = 0; i < words; i++) {
+    #pragma HLS PIPELINE II=1
+        mb_word_t w;
+        for (int l = 0; l < MB_LANES_32; l++) {
+        #pragma HLS UNROLL
+            w.range(32 * l + 31, 32 * l) = (uint32_t)(i * MB_LANES_32 + l);
+        }
+        out[i] = w;
+    }
+}
+
+/* COPY
+    - Input  : in on gmem0, words words
+    - Output : out on gmem2, the same words
+*/
+void MEM_COPY(const mb_word_t *in, mb_word_t *out, int words)
+{
+    #pragma HLS INTERFACE m_axi port = in offset = slave bundle = gmem0 max_read_burst_length = MB_BURST_LEN num_read_outstanding = MB_OUTSTANDING
+    #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem2 max_write_burst_length = MB_BURST_LEN num_write_outstanding = MB_OUTSTANDING
+    #pragma HLS INTERFACE s_axilite port = in bundle = control
+    #pragma HLS INTERFACE s_axilite port = out bundle = control
+    #pragma HLS INTERFACE s_axilite port = words bundle = control
+    #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    COPY: for (int i = 0; i < words; i++) {
+    #pragma HLS PIPELINE II=1
+        out[i] = in[i];
+    }
+}
+
+}
@@ -0,0 +1,253 @@
+/**
+ * @file mem_bench_host.cpp
+ * @brief Host driver of the memory microbenchmarks (mem_bench.cpp)
+ *
+ * Runs read-only, strided read, two-stream read, write-only and copy on every xclbin
+ * given, one xclbin per port configuration (word width, burst length, outstanding
+ * transactions). It prints one bandwidth table for all of them, with optional CSV
+ * output. Bandwidth is the useful bytes moved per kernel run over the median device
+ * execution time from event profiling, so host transfers are not included. Every run
+ * is checked (XOR fold, write pattern, copy contents), so the harness can be validated
+ * in software emulation (XCL_EMULATION_MODE=sw_emu), where the GB/s numbers mean nothing.
+ *
+ * Usage: mem_bench_host <XCLBIN File>... [--mb N]... [--iters N] [--stride N] [--csv path]
+ */
+
+#include "xcl2.hpp"
+#include "../common/event_profiler.hpp"
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// MEM_CONFIG layout, must match mem_bench.cpp
+#define MB_CFG_WORD_BITS    0
+#define MB_CFG_BURST_LEN    1
+#define MB_CFG_OUTSTANDING  2
+#define MB_CFG_WORDS        3
+
+struct MemBenchRow {
+    uint32_t word_bits, burst_len, outstanding;
+    std::string test;
+    size_t buffer_mb;       // size of each buffer
+    size_t bytes;           // useful bytes moved per run
+    double p50_us;
+    bool ok;
+};
+
+typedef std::vector<uint32_t, aligned_allocator<uint32_t>> host_words_t;
+
+// XOR of all port words of buf[first, first + words * stride) taken every stride words, as 32-bit lanes
+static std::vector<uint32_t> xor_fold(const uint32_t *buf, size_t words, size_t stride, size_t lanes) {
+    std::vector<uint32_t> fold(lanes, 0);
+    for (size_t i = 0; i < words; i++) {
+        const uint32_t *w = buf + i * stride * lanes;
+        for (size_t l = 0; l < lanes; l++) fold[l] ^= w[l];
+    }
+    return fold;
+}
+
+static double median_us(const std::vector<uint64_t> &sorted_ns) {
+    if (sorted_ns.empty()) return 0.0;
+    return sorted_ns[(sorted_ns.size() - 1) / 2] / 1000.0;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> xclbins;
+    std::vector<size_t> sizes_mb;
+    int iterations = 10;
+    int stride = 4;
+    std::string csv_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mb" && i + 1 < argc) sizes_mb.push_back(std::max(1, atoi(argv[++i])));
+        else if (arg == "--iters" && i + 1 < argc) iterations = std::max(1, atoi(argv[++i]));
+        else if (arg == "--stride" && i + 1 < argc) stride = std::max(2, atoi(argv[++i]));
+        else if (arg == "--csv" && i + 1 < argc) csv_path = argv[++i];
+        else xclbins.push_back(arg);
+    }
+    if (xclbins.empty()) {
+        std::cout << "Usage: " << argv[0] << " <XCLBIN File>... [--mb N]... [--iters N] [--stride N] [--csv path]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    // Software emulation runs the kernels as C code, keep the working set small there
+    const bool emulation = getenv("XCL_EMULATION_MODE") != nullptr;
+    if (sizes_mb.empty()) {
+        if (emulation) sizes_mb = {1};
+        else sizes_mb = {1, 16, 256};
+    }
+
+    cl_int err;
+    std::vector<MemBenchRow> rows;
+    bool all_ok = true;
+    auto devices = xcl::get_xil_devices();
+
+    for (const std::string &binaryFile : xclbins) {
+        auto fileBuf = xcl::read_binary_file(binaryFile);
+        cl::Program::Binaries bins{{fileBuf.data(), fileBuf.size()}};
+
+        cl::Context context;
+        cl::CommandQueue q;
+        cl::Program program;
+        bool device_found = false;
+        for (unsigned int i = 0; i < devices.size() && !device_found; i++) {
+            OCL_CHECK(err, context = cl::Context(devices[i], nullptr, nullptr, nullptr, &err));
+            OCL_CHECK(err, q = cl::CommandQueue(context, devices[i], CL_QUEUE_PROFILING_ENABLE, &err));
+            program = cl::Program(context, {devices[i]}, bins, nullptr, &err);
+            device_found = (err == CL_SUCCESS);
+        }
+        if (!device_found) {
+            std::cout << "No device accepted " << binaryFile << ", skipping it\n";
+            all_ok = false;
+            continue;
+        }
+
+        cl::Kernel k_config, k_read, k_read2, k_write, k_copy;
+        OCL_CHECK(err, k_config = cl::Kernel(program, "MEM_CONFIG", &err));
+        OCL_CHECK(err, k_read = cl::Kernel(program, "MEM_READ", &err));
+        OCL_CHECK(err, k_read2 = cl::Kernel(program, "MEM_READ2", &err));
+        OCL_CHECK(err, k_write = cl::Kernel(program, "MEM_WRITE", &err));
+        OCL_CHECK(err, k_copy = cl::Kernel(program, "MEM_COPY", &err));
+
+        // Port configuration of this xclbin
+        host_words_t cfg(MB_CFG_WORDS, 0);
+        OCL_CHECK(err, cl::Buffer buffer_cfg(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, cfg.size() * sizeof(uint32_t), cfg.data(), &err));
+        OCL_CHECK(err, err = k_config.setArg(0, buffer_cfg));
+        OCL_CHECK(err, err = q.enqueueTask(k_config));
+        OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_cfg}, CL_MIGRATE_MEM_OBJECT_HOST));
+        OCL_CHECK(err, err = q.finish());
+        const size_t word_bytes = cfg[MB_CFG_WORD_BITS] / 8;
+        const size_t lanes = word_bytes / sizeof(uint32_t);
+        if (word_bytes == 0) {
+            std::cout << binaryFile << " reports no word width, skipping it\n";
+            all_ok = false;
+            continue;
+        }
+        std::cout << binaryFile << ": " << cfg[MB_CFG_WORD_BITS] << "-bit ports, burst " << cfg[MB_CFG_BURST_LEN]
+                  << ", " << cfg[MB_CFG_OUTSTANDING] << " outstanding\n";
+
+        for (size_t mb : sizes_mb) {
+            const size_t bytes = mb << 20;
+            const int words = (int)(bytes / word_bytes);
+
+            // Inputs hold distinct counting patterns so every fold is checkable
+            host_words_t in_A(bytes / sizeof(uint32_t)), in_B(bytes / sizeof(uint32_t));
+            host_words_t out(bytes / sizeof(uint32_t), 0), result(lanes, 0);
+            for (size_t i = 0; i < in_A.size(); i++) {
+                in_A[i] = (uint32_t)i;
+                in_B[i] = (uint32_t)(i * 2654435761u);
+            }
+
+            OCL_CHECK(err, cl::Buffer buffer_in_A(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, bytes, in_A.data(), &err));
+            OCL_CHECK(err, cl::Buffer buffer_in_B(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, bytes, in_B.data(), &err));
+            OCL_CHECK(err, cl::Buffer buffer_out(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, bytes, out.data(), &err));
+            OCL_CHECK(err, cl::Buffer buffer_result(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, word_bytes, result.data(), &err));
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in_A, buffer_in_B, buffer_out}, 0));
+            OCL_CHECK(err, err = q.finish());
+
+            // One warmup run, then iterations timed on the device clock
+            auto run = [&](const std::string &name, cl::Kernel &kernel, size_t moved, const std::vector<cl::Memory> &results) {
+                EventProfiler prof;
+                OCL_CHECK(err, err = q.enqueueTask(kernel));
+                for (int it = 0; it < iterations; it++) {
+                    OCL_CHECK(err, err = q.enqueueTask(kernel, nullptr, prof.event(name)));
+                }
+                OCL_CHECK(err, err = q.finish());
+                prof.collect();
+                OCL_CHECK(err, err = q.enqueueMigrateMemObjects(results, CL_MIGRATE_MEM_OBJECT_HOST));
+                OCL_CHECK(err, err = q.finish());
+                rows.push_back({cfg[MB_CFG_WORD_BITS], cfg[MB_CFG_BURST_LEN], cfg[MB_CFG_OUTSTANDING],
+                                name, mb, moved, median_us(prof.exec_times(name)), false});
+            };
+
+            // Read only
+            OCL_CHECK(err, err = k_read.setArg(0, buffer_in_A));
+            OCL_CHECK(err, err = k_read.setArg(1, buffer_result));
+            OCL_CHECK(err, err = k_read.setArg(2, words));
+            OCL_CHECK(err, err = k_read.setArg(3, 1));
+            run("read", k_read, bytes, {buffer_result});
+            rows.back().ok = (std::vector<uint32_t>(result.begin(), result.end()) == xor_fold(in_A.data(), words, 1, lanes));
+
+            // Strided read, one word every stride words
+            const int strided_words = words / stride;
+            OCL_CHECK(err, err = k_read.setArg(2, strided_words));
+            OCL_CHECK(err, err = k_read.setArg(3, stride));
+            run("read stride " + std::to_string(stride), k_read, (size_t)strided_words * word_bytes, {buffer_result});
+            rows.back().ok = (std::vector<uint32_t>(result.begin(), result.end()) == xor_fold(in_A.data(), strided_words, stride, lanes));
+
+            // Two streams, gmem0 and gmem1 together
+            OCL_CHECK(err, err = k_read2.setArg(0, buffer_in_A));
+            OCL_CHECK(err, err = k_read2.setArg(1, buffer_in_B));
+            OCL_CHECK(err, err = k_read2.setArg(2, buffer_result));
+            OCL_CHECK(err, err = k_read2.setArg(3, words));
+            run("read 2 streams", k_read2, 2 * bytes, {buffer_result});
+            {
+                std::vector<uint32_t> expected = xor_fold(in_A.data(), words, 1, lanes);
+                std::vector<uint32_t> fold_B = xor_fold(in_B.data(), words, 1, lanes);
+                for (size_t l = 0; l < lanes; l++) expected[l] ^= fold_B[l];
+                rows.back().ok = (std::vector<uint32_t>(result.begin(), result.end()) == expected);
+            }
+
+            // Write only
+            OCL_CHECK(err, err = k_write.setArg(0, buffer_out));
+            OCL_CHECK(err, err = k_write.setArg(1, words));
+            run("write", k_write, bytes, {buffer_out});
+            {
+                bool ok = true;
+                for (size_t i = 0; i < out.size() && ok; i++) ok = (out[i] == (uint32_t)i);
+                rows.back().ok = ok;
+            }
+
+            // Copy, counted as read + write bytes. in_A is the pattern the write run just left in
+            // out, so out is cleared on the device first or a copy that writes nothing would pass
+            std::fill(out.begin(), out.end(), 0);
+            OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_out}, 0));
+            OCL_CHECK(err, err = q.finish());
+            OCL_CHECK(err, err = k_copy.setArg(0, buffer_in_A));
+            OCL_CHECK(err, err = k_copy.setArg(1, buffer_out));
+            OCL_CHECK(err, err = k_copy.setArg(2, words));
+            run("copy", k_copy, 2 * bytes, {buffer_out});
+            rows.back().ok = std::equal(out.begin(), out.end(), in_A.begin());
+        }
+    }
+
+    // ========== BANDWIDTH TABLE ==========
+    std::cout << "\n----------------- Memory bandwidth (device time"
+              << (emulation ? ", emulation: GB/s not meaningful" : "") << ") -----------------\n";
+    std::cout << std::right << std::setw(6) << "bits" << std::setw(7) << "burst" << std::setw(6) << "outs"
+              << "  " << std::left << std::setw(18) << "test"
+              << std::right << std::setw(8) << "MB" << std::setw(12) << "p50 us" << std::setw(10) << "GB/s"
+              << std::setw(8) << "check" << "\n";
+    for (const MemBenchRow &r : rows) {
+        double gbps = (r.p50_us > 0) ? r.bytes / (r.p50_us * 1e3) : 0.0;
+        std::cout << std::right << std::setw(6) << r.word_bits << std::setw(7) << r.burst_len << std::setw(6) << r.outstanding
+                  << "  " << std::left << std::setw(18) << r.test
+                  << std::right << std::setw(8) << r.buffer_mb
+                  << std::fixed << std::setprecision(1) << std::setw(12) << r.p50_us
+                  << std::setprecision(2) << std::setw(10) << gbps
+                  << std::setw(8) << (r.ok ? "ok" : "FAIL") << "\n";
+        all_ok = all_ok && r.ok;
+    }
+
+    if (!csv_path.empty()) {
+        std::ofstream csv(csv_path);
+        if (!csv.is_open()) {
+            std::cerr << "Error: Unable to open " << csv_path << " for writing." << std::endl;
+        } else {
+            csv << "word_bits,burst_len,outstanding,test,buffer_mb,bytes,p50_us,gbps,ok\n";
+            for (const MemBenchRow &r : rows) {
+                csv << r.word_bits << "," << r.burst_len << "," << r.outstanding << "," << r.test << ","
+                    << r.buffer_mb << "," << r.bytes << "," << r.p50_us << ","
+                    << ((r.p50_us > 0) ? r.bytes / (r.p50_us * 1e3) : 0.0) << "," << (r.ok ? 1 : 0) << "\n";
+            }
+            std::cout << "Bandwidth table written to " << csv_path << "\n";
+        }
+    }
+
+    std::cout << "\nTEST " << (all_ok ? "PASSED" : "FAILED") << std::endl;
+    return (all_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
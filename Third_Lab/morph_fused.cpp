@@ -0,0 +1,233 @@
+#include <stdint.h>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+// Original Image
+#define WIDTH 256
+#define HEIGHT 512
+
+// Transaction Definition
+#define PIXEL_SIZE 8
+#define AXI_WIDTH_BITS 512       // Data width of Memory Access in bits per cycle
+#define AXI_WIDTH_BYTES (AXI_WIDTH_BITS / PIXEL_SIZE)
+#define CHUNKS_PER_ROW (WIDTH / AXI_WIDTH_BYTES)
+
+// Kernel mode, must match common/morphology.hpp
+#define MORPH_MODE_NONE     0
+#define MORPH_MODE_OPEN     1       // erode then dilate
+#define MORPH_MODE_CLOSE    2       // dilate then erode
+
+// Per-stage operation
+#define MORPH_PASS      0
+#define MORPH_ERODE     1
+#define MORPH_DILATE    2
+
+// Stages trail each other by one row and one beat
+#define STAGES 4                    // compare, stencil, morph 1, morph 2
+#define STAGE_LAG (CHUNKS_PER_ROW + 1)
+#define WINDOW_BEATS (2 * CHUNKS_PER_ROW + 3)   // rows above and below plus one beat each side
+
+// Type Definitions
+typedef ap_uint<AXI_WIDTH_BITS> uint512_dt;
+typedef ap_uint<PIXEL_SIZE> pixel_t;
+
+#include "stencil_beat.hpp"
+
+// Helper Functions
+pixel_t Compare(pixel_t A, pixel_t B);
+void shift_in(uint512_dt window[WINDOW_BEATS], uint512_dt beat);
+uint512_dt morph_window(const uint512_dt window[WINDOW_BEATS], int row, int chunk, int op);
+uint512_dt morph_beat(uint512_dt up, uint512_dt mid, uint512_dt down,
+                      pixel_t up_l, pixel_t mid_l, pixel_t down_l,
+                      pixel_t up_r, pixel_t mid_r, pixel_t down_r,
+                      bool has_up, bool has_down, int chunk, int op);
+
+/*
+ * Posterize with fused 3x3 open/close
+ *
+ * Compare -> stencil -> morph 1 -> morph 2 in one II=1 loop over the beats of the frame.
+ * Every stage pushes one beat per cycle into a register window of the last WINDOW_BEATS
+ * beats it produced. The next stage works STAGE_LAG beats (one row and one beat) behind
+ * it, so its 3x3 neighbourhood of beat o sits at fixed window positions:
+ *     window[STAGE_LAG - k] holds beat o + k
+ * i.e. up / mid / down at 2 * CHUNKS_PER_ROW + 1 / CHUNKS_PER_ROW + 1 / 1, one position
+ * further for the beat on the left and one closer for the beat on the right. The windows
+ * are fully partitioned, so no stage reads a RAM word another stage wrote a few cycles
+ * earlier. The cleaned frame costs the same reads and writes as the plain one plus
+ * (STAGES - 1) * STAGE_LAG beats of latency, instead of a second pass over DDR.
+ */
+extern "C" {
+    void IMAGE_DIFF_POSTERIZE_MORPH(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, unsigned int mode)
+    {
+        // INTERFACE DIRECTIVES
+        #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem0
+        #pragma HLS INTERFACE m_axi port = in_B offset = slave bundle = gmem1
+        #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem2
+        #pragma HLS INTERFACE s_axilite port = in_A bundle = control
+        #pragma HLS INTERFACE s_axilite port = in_B bundle = control
+        #pragma HLS INTERFACE s_axilite port = out bundle = control
+        #pragma HLS INTERFACE s_axilite port = mode bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        // Beat windows, [0] is the newest beat of the stage
+        uint512_dt g_win[WINDOW_BEATS];     // compared
+        uint512_dt f_win[WINDOW_BEATS];     // filtered
+        uint512_dt m_win[WINDOW_BEATS];     // after morph 1
+        #pragma HLS ARRAY_PARTITION variable=g_win complete
+        #pragma HLS ARRAY_PARTITION variable=f_win complete
+        #pragma HLS ARRAY_PARTITION variable=m_win complete
+
+        for (int w = 0; w < WINDOW_BEATS; w++) {
+        #pragma HLS UNROLL
+            g_win[w] = 0;
+            f_win[w] = 0;
+            m_win[w] = 0;
+        }
+
+        const int op1 = (mode == MORPH_MODE_OPEN) ? MORPH_ERODE : (mode == MORPH_MODE_CLOSE) ? MORPH_DILATE : MORPH_PASS;
+        const int op2 = (mode == MORPH_MODE_OPEN) ? MORPH_DILATE : (mode == MORPH_MODE_CLOSE) ? MORPH_ERODE : MORPH_PASS;
+        const int frame_beats = HEIGHT * CHUNKS_PER_ROW;
+
+        BEATS: for (int t = 0; t < frame_beats + (STAGES - 1) * STAGE_LAG; t++) {
+        #pragma HLS PIPELINE II=1
+
+            // Compare: beat t
+            uint512_dt res_G = 0;
+            if (t < frame_beats) {
+                uint512_dt val1 = in_A[t];
+                uint512_dt val2 = in_B[t];
+                for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+                #pragma HLS UNROLL
+                    pixel_t p1 = val1.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                    pixel_t p2 = val2.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                    res_G.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = Compare(p1, p2);
+                }
+            }
+            shift_in(g_win, res_G);
+
+            // Stencil: beat t - STAGE_LAG, first and last rows are zero
+            const int f = t - STAGE_LAG;
+            uint512_dt res_F = 0;
+            if (f >= 0 && f < frame_beats) {
+                const int row = f / CHUNKS_PER_ROW, fc = f % CHUNKS_PER_ROW;
+                if (row > 0 && row < HEIGHT - 1) {
+                    pixel_t left_px = (fc > 0) ? (pixel_t)g_win[STAGE_LAG + 1].range(AXI_WIDTH_BITS - 1, AXI_WIDTH_BITS - PIXEL_SIZE) : (pixel_t)0;
+                    pixel_t right_px = (fc < CHUNKS_PER_ROW - 1) ? (pixel_t)g_win[STAGE_LAG - 1].range(PIXEL_SIZE - 1, 0) : (pixel_t)0;
+                    res_F = filter_beat(g_win[STAGE_LAG + CHUNKS_PER_ROW], g_win[STAGE_LAG], g_win[STAGE_LAG - CHUNKS_PER_ROW],
+                                        left_px, right_px, fc);
+                }
+            }
+            shift_in(f_win, res_F);
+
+            // Morph 1 on the filtered beats: beat t - 2 * STAGE_LAG
+            const int m = t - 2 * STAGE_LAG;
+            uint512_dt res_M = 0;
+            if (m >= 0 && m < frame_beats) {
+                res_M = morph_window(f_win, m / CHUNKS_PER_ROW, m % CHUNKS_PER_ROW, op1);
+            }
+            shift_in(m_win, res_M);
+
+            // Morph 2 and write: beat t - 3 * STAGE_LAG
+            const int n = t - 3 * STAGE_LAG;
+            if (n >= 0 && n < frame_beats) {
+                out[n] = morph_window(m_win, n / CHUNKS_PER_ROW, n % CHUNKS_PER_ROW, op2);
+            }
+        }
+    }
+}
+
+
+/* Push the newest beat of a stage into its window */
+void shift_in(uint512_dt window[WINDOW_BEATS], uint512_dt beat) {
+    #pragma HLS INLINE
+    for (int w = WINDOW_BEATS - 1; w > 0; w--) {
+    #pragma HLS UNROLL
+        window[w] = window[w - 1];
+    }
+    window[0] = beat;
+}
+
+
+/* Morph the beat STAGE_LAG behind the newest one of a window
+    - Input  : window of the previous stage, row and chunk of the beat, operation
+    - Output : morph_beat over its 3x3 neighbourhood
+*/
+uint512_dt morph_window(const uint512_dt window[WINDOW_BEATS], int row, int chunk, int op) {
+    #pragma HLS INLINE
+    const int up = STAGE_LAG + CHUNKS_PER_ROW, mid = STAGE_LAG, down = STAGE_LAG - CHUNKS_PER_ROW;
+    return morph_beat(window[up], window[mid], window[down],
+                      window[up + 1].range(AXI_WIDTH_BITS - 1, AXI_WIDTH_BITS - PIXEL_SIZE),
+                      window[mid + 1].range(AXI_WIDTH_BITS - 1, AXI_WIDTH_BITS - PIXEL_SIZE),
+                      window[down + 1].range(AXI_WIDTH_BITS - 1, AXI_WIDTH_BITS - PIXEL_SIZE),
+                      window[up - 1].range(PIXEL_SIZE - 1, 0),
+                      window[mid - 1].range(PIXEL_SIZE - 1, 0),
+                      window[down - 1].range(PIXEL_SIZE - 1, 0),
+                      row > 0, row < HEIGHT - 1, chunk, op);
+}
+
+
+/* 3x3 erode / dilate of one beat
+    - Input  : beats above, at and below, the pixels left and right of each, which rows exist
+    - Output : min (erode) or max (dilate) over the 3x3 window, mid unchanged for MORPH_PASS
+    Neighbours outside the frame are replaced by the pixel itself, which leaves min/max as
+    if they were not there.
+*/
+uint512_dt morph_beat(uint512_dt up, uint512_dt mid, uint512_dt down,
+                      pixel_t up_l, pixel_t mid_l, pixel_t down_l,
+                      pixel_t up_r, pixel_t mid_r, pixel_t down_r,
+                      bool has_up, bool has_down, int chunk, int op) {
+    #pragma HLS INLINE
+    if (op == MORPH_PASS) return mid;
+
+    const bool dilate = (op == MORPH_DILATE);
+    uint512_dt out_val;
+    for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+    #pragma HLS UNROLL
+        const int col = chunk * AXI_WIDTH_BYTES + v;
+        pixel_t window = mid.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+
+        for (int row = 0; row < 3; row++) {
+        #pragma HLS UNROLL
+            if ((row == 0 && !has_up) || (row == 2 && !has_down)) continue;
+            const uint512_dt &line = (row == 0) ? up : (row == 1) ? mid : down;
+            const pixel_t left_px = (row == 0) ? up_l : (row == 1) ? mid_l : down_l;
+            const pixel_t right_px = (row == 0) ? up_r : (row == 1) ? mid_r : down_r;
+
+            pixel_t center = line.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+            pixel_t left = (col == 0) ? center : (v == 0) ? left_px : (pixel_t)line.range(PIXEL_SIZE * v - 1, (v - 1) * PIXEL_SIZE);
+            pixel_t right = (col == WIDTH - 1) ? center : (v == AXI_WIDTH_BYTES - 1) ? right_px : (pixel_t)line.range(PIXEL_SIZE * (v + 2) - 1, (v + 1) * PIXEL_SIZE);
+
+            pixel_t lo = (left < center) ? left : center;
+            lo = (right < lo) ? right : lo;
+            pixel_t hi = (left > center) ? left : center;
+            hi = (right > hi) ? right : hi;
+
+            if (dilate) window = (hi > window) ? hi : window;
+            else window = (lo < window) ? lo : window;
+        }
+
+        out_val.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = window;
+    }
+    return out_val;
+}
+
+
+/* Compare Helper Function
+    - Input  : 2 uint8_t numbers
+    - Output : Quantized absolute difference
+*/
+pixel_t Compare(pixel_t A, pixel_t B){
+    pixel_t C;
+    int16_t temp_d = (int16_t) A - (int16_t) B;
+
+    constexpr uint8_t T1 = 32;
+    constexpr uint8_t T2 = 96;
+
+    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+    if(D < T1) C = (pixel_t) 0;
+    else if(D < T2) C = (pixel_t) 128;
+    else C = (pixel_t) 255;
+
+    return C;
+}
@@ -0,0 +1,91 @@
+#include "any_width_core.hpp"
+
+// Descriptor layout in 32-bit words, must match common/descriptor_ring.hpp
+#define DESC_SEQ      0     // frame number + 1, the descriptor is valid once it equals the next one expected
+#define DESC_SRC_A    1     // offsets in 512-bit beats into the frame pools
+#define DESC_SRC_B    2
+#define DESC_DST      3
+#define DESC_WIDTH    4     // 0 stops the kernel
+#define DESC_HEIGHT   5
+#define DESC_T1       6
+#define DESC_T2       7
+#define DESC_WORDS    8
+
+/* One frame of the ring. Kept out of line: a block with m_axi writes only reports done once
+   the write responses of its bursts are back, so anything the caller writes after it is
+   issued after pool_out has been acknowledged.
+*/
+static void run_frame(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                      int width, int height, uint8_t t1, uint8_t t2)
+{
+    #pragma HLS INLINE off
+    any_width_core(in_A, in_B, out, width, height, t1, t2);
+}
+
+/* PERSISTENT: DESCRIPTOR RING
+    - Input  : ring of ring_slots descriptors, frame pools pool_A / pool_B the descriptors
+               point into
+    - Output : pool_out frames, done[0] = number of frames completed
+
+    Launched once, then runs until it is told to stop. Descriptor n sits in slot
+    n % ring_slots and is valid when its DESC_SEQ word equals n + 1, so the slots can be
+    reused lap after lap without a separate valid flag to clear. The kernel spins on the
+    sequence word of the slot it expects next, runs the any-width datapath on the frame
+    it describes and bumps done[0]. A descriptor with width 0 ends the loop, after which
+    done[0] counts it too, so the host can wait for it like any other frame.
+
+    The host only writes descriptors and reads done[0], the per-frame enqueueTask and
+    argument setup are gone. Issue order on a bundle is not completion order, so done[0] is
+    not written until the frame is acknowledged: run_frame returns only after the pool_out
+    write responses, and the host reading done[0] = n + 1 finds frame n in memory.
+*/
+extern "C" {
+    void IMAGE_DIFF_POSTERIZE_PERSISTENT(volatile uint32_t *ring, const uint512_dt *pool_A, const uint512_dt *pool_B,
+                                         uint512_dt *pool_out, volatile uint32_t *done, int ring_slots)
+    {
+        // INTERFACE DIRECTIVES
+        #pragma HLS INTERFACE m_axi port = ring offset = slave bundle = gmem3 depth = 128
+        #pragma HLS INTERFACE m_axi port = pool_A offset = slave bundle = gmem0
+        #pragma HLS INTERFACE m_axi port = pool_B offset = slave bundle = gmem1
+        #pragma HLS INTERFACE m_axi port = pool_out offset = slave bundle = gmem2
+        #pragma HLS INTERFACE m_axi port = done offset = slave bundle = gmem2 depth = 1
+        #pragma HLS INTERFACE s_axilite port = ring bundle = control
+        #pragma HLS INTERFACE s_axilite port = pool_A bundle = control
+        #pragma HLS INTERFACE s_axilite port = pool_B bundle = control
+        #pragma HLS INTERFACE s_axilite port = pool_out bundle = control
+        #pragma HLS INTERFACE s_axilite port = done bundle = control
+        #pragma HLS INTERFACE s_axilite port = ring_slots bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        uint32_t completed = 0;
+        int slot = 0;
+        done[0] = 0;
+
+        FRAME_LOOP: while (true) {
+            volatile uint32_t *desc = ring + slot * DESC_WORDS;
+
+            // Wait for the host to publish the next descriptor
+            POLL_LOOP: while (desc[DESC_SEQ] != completed + 1) {
+            #pragma HLS PIPELINE II=1
+            }
+
+            uint32_t src_a  = desc[DESC_SRC_A];
+            uint32_t src_b  = desc[DESC_SRC_B];
+            uint32_t dst    = desc[DESC_DST];
+            int width       = desc[DESC_WIDTH];
+            int height      = desc[DESC_HEIGHT];
+            uint8_t t1      = desc[DESC_T1];
+            uint8_t t2      = desc[DESC_T2];
+
+            if (width != 0) {
+                run_frame(pool_A + src_a, pool_B + src_b, pool_out + dst, width, height, t1, t2);
+            }
+
+            completed++;
+            done[0] = completed;
+            if (width == 0) break;
+
+            slot = (slot == ring_slots - 1) ? 0 : slot + 1;
+        }
+    }
+}
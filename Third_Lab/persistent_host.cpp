@@ -0,0 +1,263 @@
+/**
+ * @file persistent_host.cpp
+ * @brief Host driver of the persistent descriptor-ring kernel (persistent.cpp)
+ *
+ * Streams N small frames through IMAGE_DIFF_POSTERIZE_PERSISTENT. The kernel is
+ * launched once, after that every frame costs the host one descriptor, written as its
+ * payload and then its sequence word. The host reads the completion word only when the
+ * ring is full, and once more at the end. If the xclbin also carries
+ * IMAGE_DIFF_POSTERIZE_ANY_WIDTH, the same frames go through it with one setArg +
+ * enqueueTask + finish each. That run is the per-launch baseline the ring is compared
+ * against.
+ *
+ * A few frame pairs are generated into pool slots once. Descriptors cycle through them,
+ * and alternate slots use different thresholds so the descriptor fields are exercised.
+ * Every pool slot's output is checked against IMAGE_DIFF_POSTERIZE_SW.
+ *
+ * Usage: persistent_host <XCLBIN File> [--frames N] [--size WxH] [--slots N]
+ */
+
+#include "xcl2.hpp"
+#include "../common/posterize_sw.hpp"
+#include "../common/workload_gen.hpp"
+#include "../common/verify.hpp"
+#include "../common/any_width.hpp"
+#include "../common/descriptor_ring.hpp"
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define POOL_FRAMES 4           // distinct frame pairs the descriptors cycle through
+#define POOL_ALIGN 4096         // pool frames start on sub-buffer aligned offsets
+
+typedef std::vector<uint8_t, aligned_allocator<uint8_t>> host_frame_t;
+
+static double elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    std::string binaryFile;
+    // Software emulation runs the kernel as C code, keep the run short there
+    const bool emulation = getenv("XCL_EMULATION_MODE") != nullptr;
+    int frames = emulation ? 16 : 2000;
+    int width = 256, height = 64;
+    int slots = 16;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) frames = std::max(POOL_FRAMES, atoi(argv[++i]));
+        else if (arg == "--slots" && i + 1 < argc) slots = std::max(2, atoi(argv[++i]));
+        else if (arg == "--size" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width < ANY_WIDTH_MIN_WIDTH ||
+                width > ANY_WIDTH_MAX_WIDTH || height < 1) {
+                std::cout << "Bad --size " << argv[i] << " (expected WxH, W in [" << ANY_WIDTH_MIN_WIDTH
+                          << ", " << ANY_WIDTH_MAX_WIDTH << "])" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else binaryFile = arg;
+    }
+    if (binaryFile.empty()) {
+        std::cout << "Usage: " << argv[0] << " <XCLBIN File> [--frames N] [--size WxH] [--slots N]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // ========== FRAME POOLS ==========
+    // POOL_FRAMES frames in each pool, every frame padded to whole beats and placed at an
+    // aligned offset so the baseline can address it as a sub-buffer
+    const size_t frame_bytes = any_width_frame_bytes(width, height);
+    const size_t frame_stride = (frame_bytes + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN;
+    const size_t pixels = (size_t)width * height;
+    host_frame_t pool_A(POOL_FRAMES * frame_stride, 0);
+    host_frame_t pool_B(POOL_FRAMES * frame_stride, 0);
+    host_frame_t pool_out(POOL_FRAMES * frame_stride, 0);
+    std::vector<host_frame_t> sw_result(POOL_FRAMES, host_frame_t(pixels));
+    int t1[POOL_FRAMES], t2[POOL_FRAMES];
+
+    SceneParams scene;
+    for (int p = 0; p < POOL_FRAMES; p++) {
+        t1[p] = (p % 2) ? 20 : T1;
+        t2[p] = (p % 2) ? 60 : T2;
+        scene.frame = p;
+        generate_frame_pair(&pool_A[p * frame_stride], &pool_B[p * frame_stride], width, height, scene);
+        IMAGE_DIFF_POSTERIZE_SW(&pool_A[p * frame_stride], &pool_B[p * frame_stride], sw_result[p].data(),
+                                width, height, t1[p], t2[p]);
+    }
+
+    std::vector<FrameDescriptor, aligned_allocator<FrameDescriptor>> ring(slots);
+    std::vector<uint32_t, aligned_allocator<uint32_t>> done(16, 0);
+    std::memset(ring.data(), 0, ring.size() * sizeof(FrameDescriptor));
+
+    // ========== DEVICE ==========
+    cl_int err;
+    cl::Context context;
+    cl::CommandQueue q;         // kernel launches
+    cl::CommandQueue ring_q;    // descriptor and completion traffic while the kernel runs
+    cl::Program program;
+    auto devices = xcl::get_xil_devices();
+    auto fileBuf = xcl::read_binary_file(binaryFile);
+    cl::Program::Binaries bins{{fileBuf.data(), fileBuf.size()}};
+    bool device_found = false;
+    for (unsigned int i = 0; i < devices.size() && !device_found; i++) {
+        OCL_CHECK(err, context = cl::Context(devices[i], nullptr, nullptr, nullptr, &err));
+        OCL_CHECK(err, q = cl::CommandQueue(context, devices[i], CL_QUEUE_PROFILING_ENABLE, &err));
+        OCL_CHECK(err, ring_q = cl::CommandQueue(context, devices[i], CL_QUEUE_PROFILING_ENABLE, &err));
+        program = cl::Program(context, {devices[i]}, bins, nullptr, &err);
+        device_found = (err == CL_SUCCESS);
+    }
+    if (!device_found) {
+        std::cout << "Failed to program any device, exit!\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Kernel persistent_kernel;
+    OCL_CHECK(err, persistent_kernel = cl::Kernel(program, "IMAGE_DIFF_POSTERIZE_PERSISTENT", &err));
+    // Optional per-launch baseline (Third_Lab/any_width.cpp)
+    cl::Kernel launch_kernel(program, "IMAGE_DIFF_POSTERIZE_ANY_WIDTH", &err);
+    const bool has_launch_kernel = (err == CL_SUCCESS);
+
+    OCL_CHECK(err, cl::Buffer buffer_ring(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                                          ring.size() * sizeof(FrameDescriptor), ring.data(), &err));
+    OCL_CHECK(err, cl::Buffer buffer_pool_A(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, pool_A.size(), pool_A.data(), &err));
+    OCL_CHECK(err, cl::Buffer buffer_pool_B(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, pool_B.size(), pool_B.data(), &err));
+    OCL_CHECK(err, cl::Buffer buffer_pool_out(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, pool_out.size(), pool_out.data(), &err));
+    OCL_CHECK(err, cl::Buffer buffer_done(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
+                                          done.size() * sizeof(uint32_t), done.data(), &err));
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_ring, buffer_pool_A, buffer_pool_B, buffer_pool_out, buffer_done}, 0));
+    OCL_CHECK(err, err = q.finish());
+
+    bool all_ok = true;
+    auto check_pool = [&](const char *name) {
+        bool ok = true;
+        for (int p = 0; p < POOL_FRAMES; p++) {
+            VerifyResult verify = verify_frames(sw_result[p].data(), &pool_out[p * frame_stride], width, height);
+            if (!verify.passed()) {
+                std::cout << name << ", pool frame " << p << ": DIFFERS from the CPU reference\n";
+                verify_print(verify, width);
+                ok = false;
+            }
+        }
+        all_ok = all_ok && ok;
+        return ok;
+    };
+
+    // ========== PER-LAUNCH BASELINE ==========
+    // One enqueueTask per frame, each with its own argument setup, as the other hosts do
+    double launch_us = 0.0;
+    bool launch_ok = false;
+    if (has_launch_kernel) {
+        std::vector<cl::Buffer> slot_A, slot_B, slot_out;
+        for (int p = 0; p < POOL_FRAMES; p++) {
+            cl_buffer_region region_in = {p * frame_stride, frame_bytes};
+            OCL_CHECK(err, slot_A.push_back(buffer_pool_A.createSubBuffer(CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region_in, &err)));
+            OCL_CHECK(err, slot_B.push_back(buffer_pool_B.createSubBuffer(CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region_in, &err)));
+            OCL_CHECK(err, slot_out.push_back(buffer_pool_out.createSubBuffer(CL_MEM_WRITE_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region_in, &err)));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int n = 0; n < frames; n++) {
+            int p = n % POOL_FRAMES;
+            OCL_CHECK(err, err = launch_kernel.setArg(0, slot_A[p]));
+            OCL_CHECK(err, err = launch_kernel.setArg(1, slot_B[p]));
+            OCL_CHECK(err, err = launch_kernel.setArg(2, slot_out[p]));
+            OCL_CHECK(err, err = launch_kernel.setArg(3, width));
+            OCL_CHECK(err, err = launch_kernel.setArg(4, height));
+            OCL_CHECK(err, err = q.enqueueTask(launch_kernel));
+            OCL_CHECK(err, err = q.finish());
+        }
+        launch_us = elapsed_us(start);
+
+        // The baseline only runs the default thresholds, the odd pool slots keep T1 / T2 here
+        OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_pool_out}, CL_MIGRATE_MEM_OBJECT_HOST));
+        OCL_CHECK(err, err = q.finish());
+        launch_ok = true;
+        for (int p = 0; p < POOL_FRAMES && p < frames; p += 2) {
+            launch_ok = launch_ok && verify_frames(sw_result[p].data(), &pool_out[p * frame_stride], width, height).passed();
+        }
+        all_ok = all_ok && launch_ok;
+        std::fill(pool_out.begin(), pool_out.end(), 0);
+        OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_pool_out}, 0));
+        OCL_CHECK(err, err = q.finish());
+    } else {
+        std::cout << "xclbin has no IMAGE_DIFF_POSTERIZE_ANY_WIDTH, skipping the per-launch baseline\n";
+    }
+
+    // ========== PERSISTENT KERNEL ==========
+    OCL_CHECK(err, err = persistent_kernel.setArg(0, buffer_ring));
+    OCL_CHECK(err, err = persistent_kernel.setArg(1, buffer_pool_A));
+    OCL_CHECK(err, err = persistent_kernel.setArg(2, buffer_pool_B));
+    OCL_CHECK(err, err = persistent_kernel.setArg(3, buffer_pool_out));
+    OCL_CHECK(err, err = persistent_kernel.setArg(4, buffer_done));
+    OCL_CHECK(err, err = persistent_kernel.setArg(5, slots));
+
+    // Descriptor n goes to slot n % slots. The payload words are written first and the seq
+    // word in a second, blocking write, so the kernel can never match seq on a slot whose
+    // payload is still from the previous lap
+    auto publish = [&](uint32_t n, const FrameDescriptor &d) {
+        int slot = n % slots;
+        size_t offset = slot * sizeof(FrameDescriptor);
+        ring[slot] = d;
+        OCL_CHECK(err, err = ring_q.enqueueWriteBuffer(buffer_ring, CL_TRUE, offset + sizeof(uint32_t),
+                                                       sizeof(FrameDescriptor) - sizeof(uint32_t), &ring[slot].src_a));
+        OCL_CHECK(err, err = ring_q.enqueueWriteBuffer(buffer_ring, CL_TRUE, offset, sizeof(uint32_t), &ring[slot].seq));
+    };
+    auto read_done = [&]() {
+        OCL_CHECK(err, err = ring_q.enqueueReadBuffer(buffer_done, CL_TRUE, 0, sizeof(uint32_t), done.data()));
+        return done[0];
+    };
+
+    uint32_t completed = 0;
+    uint64_t polls = 0;
+    auto start = std::chrono::steady_clock::now();
+    OCL_CHECK(err, err = q.enqueueTask(persistent_kernel));
+    OCL_CHECK(err, err = q.flush());
+    for (int n = 0; n < frames; n++) {
+        // The slot is free once the descriptor a lap back has completed
+        while ((uint32_t)n >= completed + slots) {
+            completed = read_done();
+            polls++;
+        }
+        int p = n % POOL_FRAMES;
+        publish(n, frame_descriptor(n, p * frame_stride, p * frame_stride, p * frame_stride, width, height, t1[p], t2[p]));
+    }
+    while ((uint32_t)frames > completed) {
+        completed = read_done();
+        polls++;
+    }
+    double persistent_us = elapsed_us(start);
+
+    // Stop descriptor, the kernel returns after counting it
+    while ((uint32_t)frames >= completed + slots) completed = read_done();
+    publish(frames, stop_descriptor(frames));
+    OCL_CHECK(err, err = q.finish());
+    completed = read_done();
+
+    OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_pool_out}, CL_MIGRATE_MEM_OBJECT_HOST));
+    OCL_CHECK(err, err = q.finish());
+    bool persistent_ok = (completed == (uint32_t)frames + 1) && check_pool("Persistent kernel");
+    all_ok = all_ok && persistent_ok;
+
+    // ========== REPORT ==========
+    std::cout << "\n------------- " << frames << " frames of " << width << "x" << height << ", " << slots
+              << " descriptor slots" << (emulation ? " (emulation: times not meaningful)" : "") << " -------------\n";
+    std::cout << std::left << std::setw(22) << "mode" << std::right << std::setw(14) << "total ms"
+              << std::setw(14) << "us/frame" << std::setw(8) << "check" << "\n";
+    if (has_launch_kernel) {
+        std::cout << std::left << std::setw(22) << "enqueueTask per frame" << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(14) << launch_us / 1000.0
+                  << std::setw(14) << launch_us / frames << std::setw(8) << (launch_ok ? "ok" : "FAIL") << "\n";
+    }
+    std::cout << std::left << std::setw(22) << "descriptor ring" << std::right << std::fixed
+              << std::setprecision(2) << std::setw(14) << persistent_us / 1000.0
+              << std::setw(14) << persistent_us / frames << std::setw(8) << (persistent_ok ? "ok" : "FAIL") << "\n";
+    std::cout << "Completion polls: " << polls << " (" << std::setprecision(2) << (double)polls / frames << " per frame)\n";
+
+    std::cout << "\nTEST " << (all_ok ? "PASSED" : "FAILED") << std::endl;
+    return (all_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,224 @@
+/**
+ * @file posterize_daemon.cpp
+ * @brief Long-lived server that keeps IMAGE_DIFF_POSTERIZE programmed on the device
+ *
+ * Programming the xclbin takes seconds, so a short job spends most of its time before
+ * the first frame. The daemon pays that once: it loads the xclbin at start, keeps the
+ * kernels and buffers of a PosterizeAccelerator allocated, and serves frames to any
+ * number of clients over a Unix socket with the pixels in shared memory
+ * (protocol in common/daemon_protocol.hpp). Each client gets its own thread; their
+ * frames meet in the accelerator's in-flight queue.
+ *
+ * Built with -DCPU_BACKEND the daemon needs no XRT and computes the frames with the
+ * CPU reference, so clients and the protocol can be tested on any Linux machine.
+ *
+ * With --cache <MB> repeated (A, B) pairs are answered from a result cache
+ * (common/result_cache.hpp) without reaching the backend.
+ *
+ * Usage: posterize_daemon <XCLBIN File | --cpu> [--socket path] [--depth N] [--cache MB]
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // memfd_create
+#endif
+
+#include "../common/daemon_protocol.hpp"
+#include "../common/posterize_sw.hpp"
+#include "../common/result_cache.hpp"
+#ifndef CPU_BACKEND
+#include "../common/posterize_accelerator.hpp"
+#endif
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#define WIDTH  256
+#define HEIGHT 512
+
+// What the daemon computes frames with
+class Backend {
+public:
+    virtual ~Backend() {}
+    virtual bool process(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out) = 0;
+    virtual const char *name() const = 0;
+    virtual void print_stats() const {}
+};
+
+class CpuBackend : public Backend {
+public:
+    bool process(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out) override {
+        IMAGE_DIFF_POSTERIZE_SW(in_A, in_B, out, WIDTH, HEIGHT);
+        return true;
+    }
+    const char *name() const override { return "CPU reference"; }
+};
+
+#ifndef CPU_BACKEND
+class DeviceBackend : public Backend {
+public:
+    explicit DeviceBackend(std::unique_ptr<PosterizeAccelerator> accel) : accel(std::move(accel)) {}
+    bool process(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out) override {
+        return accel->submit(in_A, in_B, out).get();
+    }
+    const char *name() const override { return "device"; }
+
+private:
+    std::unique_ptr<PosterizeAccelerator> accel;
+};
+#endif
+
+// Answers repeated frame pairs from the result cache, everything else goes to the wrapped backend
+class CachedBackend : public Backend {
+public:
+    CachedBackend(std::unique_ptr<Backend> inner, size_t budget_bytes) : inner(std::move(inner)), cache(budget_bytes) {}
+    bool process(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out) override {
+        FrameHash key = frame_pair_hash(in_A, in_B, WIDTH, HEIGHT, T1, T2);
+        const size_t bytes = (size_t)WIDTH * HEIGHT;
+        if (cache.lookup(key, out, bytes)) return true;
+        if (!inner->process(in_A, in_B, out)) return false;
+        cache.insert(key, out, bytes);
+        return true;
+    }
+    const char *name() const override { return inner->name(); }
+    void print_stats() const override { cache.print_stats(); }
+
+private:
+    std::unique_ptr<Backend> inner;
+    ResultCache cache;
+};
+
+static std::string socket_path = DAEMON_SOCKET_PATH;
+
+static void on_signal(int) {
+    unlink(socket_path.c_str());
+    _exit(EXIT_SUCCESS);
+}
+
+/* One client connection
+    Handshake, hand over the shared frames, then one reply per request until the client leaves.
+*/
+static void serve_client(int sock, Backend *backend) {
+    DaemonHello hello;
+    DaemonHelloReply reply = {DAEMON_OK, WIDTH, HEIGHT, daemon_frame_stride(WIDTH, HEIGHT)};
+
+    if (!daemon_recv(sock, &hello, sizeof(hello))) {
+        close(sock);
+        return;
+    }
+    if (hello.magic != DAEMON_MAGIC || hello.version != DAEMON_VERSION) reply.status = DAEMON_BAD_REQUEST;
+    else if (hello.width != WIDTH || hello.height != HEIGHT) reply.status = DAEMON_BAD_SIZE;
+
+    const size_t shm_bytes = 3 * reply.frame_stride;
+    int shm_fd = -1;
+    uint8_t *shm = nullptr;
+    if (reply.status == DAEMON_OK) {
+        shm_fd = memfd_create("posterize_frames", MFD_CLOEXEC);
+        void *p = MAP_FAILED;
+        if (shm_fd >= 0 && ftruncate(shm_fd, shm_bytes) == 0) {
+            p = mmap(nullptr, shm_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+        }
+        if (p == MAP_FAILED) reply.status = DAEMON_NO_MEMORY;
+        else shm = (uint8_t *)p;
+    }
+
+    bool sent = daemon_send_fd(sock, &reply, sizeof(reply), reply.status == DAEMON_OK ? shm_fd : -1);
+    if (shm_fd >= 0) close(shm_fd);
+
+    if (sent && reply.status == DAEMON_OK) {
+        const uint8_t *in_A = shm;
+        const uint8_t *in_B = shm + reply.frame_stride;
+        uint8_t *out = shm + 2 * reply.frame_stride;
+
+        DaemonRequest req;
+        while (daemon_recv(sock, &req, sizeof(req))) {
+            DaemonReply ans = {req.seq, DAEMON_OK, 0};
+            if (req.magic != DAEMON_MAGIC) {
+                ans.status = DAEMON_BAD_REQUEST;
+            } else {
+                auto start = std::chrono::steady_clock::now();
+                if (!backend->process(in_A, in_B, out)) ans.status = DAEMON_DEVICE_ERROR;
+                auto end = std::chrono::steady_clock::now();
+                ans.service_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            }
+            if (!daemon_send(sock, &ans, sizeof(ans))) break;
+        }
+    }
+
+    if (shm) munmap(shm, shm_bytes);
+    close(sock);
+    backend->print_stats();
+}
+
+int main(int argc, char **argv) {
+    std::string binaryFile;
+    bool use_cpu = false;
+    int depth = 4;
+    size_t cache_mb = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--cpu") use_cpu = true;
+        else if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+        else if (arg == "--depth" && i + 1 < argc) depth = atoi(argv[++i]);
+        else if (arg == "--cache" && i + 1 < argc) cache_mb = atol(argv[++i]);
+        else binaryFile = arg;
+    }
+#ifdef CPU_BACKEND
+    use_cpu = true;
+#endif
+    if (!use_cpu && binaryFile.empty()) {
+        std::cout << "Usage: " << argv[0] << " <XCLBIN File | --cpu> [--socket path] [--depth N] [--cache MB]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Program once, up front - this is the cost the daemon exists to amortize
+    std::unique_ptr<Backend> backend;
+    auto start = std::chrono::steady_clock::now();
+    if (use_cpu) {
+        backend.reset(new CpuBackend());
+    }
+#ifndef CPU_BACKEND
+    else {
+        std::unique_ptr<PosterizeAccelerator> accel = PosterizeAccelerator::from_xclbin(binaryFile, WIDTH, HEIGHT, depth);
+        if (!accel) return EXIT_FAILURE;
+        backend.reset(new DeviceBackend(std::move(accel)));
+    }
+#endif
+    if (cache_mb > 0) backend.reset(new CachedBackend(std::move(backend), cache_mb << 20));
+    auto ready = std::chrono::steady_clock::now();
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(socket_path.c_str());
+    if (listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, 16) < 0) {
+        std::cerr << "Cannot listen on " << socket_path << ": " << strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    std::cout << "Serving " << WIDTH << "x" << HEIGHT << " frames on " << socket_path
+              << " with the " << backend->name() << " backend (ready in "
+              << std::chrono::duration<double, std::milli>(ready - start).count() << " ms)" << std::endl;
+
+    for (;;) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "accept failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        std::thread(serve_client, client, backend.get()).detach();
+    }
+
+    close(listener);
+    unlink(socket_path.c_str());
+    return EXIT_FAILURE;
+}
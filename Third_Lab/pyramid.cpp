@@ -0,0 +1,118 @@
+#include <stdint.h>
+#include <ap_int.h>
+
+// Original Image
+#define WIDTH 256
+#define HEIGHT 512
+
+// Transaction Definition
+#define PIXEL_SIZE 8
+#define AXI_WIDTH_BITS 512       // Data width of Memory Access in bits per cycle
+#define AXI_WIDTH_BYTES (AXI_WIDTH_BITS / PIXEL_SIZE)
+#define CHUNKS_PER_ROW (WIDTH / AXI_WIDTH_BYTES)
+
+// Block list, 4 words per block as RectLaunch in common/dirty_rect.hpp
+#define MAX_BLOCKS      512
+#define BLOCK_WORDS     4       // row_start, row_end, chunk_start, chunk_end (ends exclusive)
+
+// Type Definitions
+typedef ap_uint<AXI_WIDTH_BITS> uint512_dt;
+typedef ap_uint<PIXEL_SIZE> pixel_t;
+typedef ap_uint<CHUNKS_PER_ROW> row_mask_t;
+
+// Helper Functions
+pixel_t Compare(pixel_t A, pixel_t B);
+
+#include "rect_walk.hpp"
+
+/* COARSE-TO-FINE POSTERIZE
+    - Input  : in_A, in_B full frames (512-bit packed), n_blocks active output regions
+               found by the host's coarse pass (common/pyramid.hpp)
+    - Output : out, full frame
+    Every beat outside the blocks is written as zero without reading A or B, every beat
+    inside is computed by rect_walk, like IMAGE_DIFF_POSTERIZE_RECT. Each output beat is written once
+    (beats shared by overlapping blocks are computed twice, with the same value).
+*/
+extern "C" {
+    void IMAGE_DIFF_POSTERIZE_PYRAMID(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                                      const int *blocks, int n_blocks)
+    {
+        // INTERFACE DIRECTIVES
+        #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem0
+        #pragma HLS INTERFACE m_axi port = in_B offset = slave bundle = gmem1
+        #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem2
+        #pragma HLS INTERFACE m_axi port = blocks offset = slave bundle = gmem3 depth = 2048
+        #pragma HLS INTERFACE s_axilite port = in_A bundle = control
+        #pragma HLS INTERFACE s_axilite port = in_B bundle = control
+        #pragma HLS INTERFACE s_axilite port = out bundle = control
+        #pragma HLS INTERFACE s_axilite port = blocks bundle = control
+        #pragma HLS INTERFACE s_axilite port = n_blocks bundle = control
+        #pragma HLS INTERFACE s_axilite port = return bundle = control
+
+        if (n_blocks > MAX_BLOCKS) n_blocks = MAX_BLOCKS;
+
+        // Block list and the beats it covers, one bit per beat
+        int block_list[MAX_BLOCKS][BLOCK_WORDS];
+        row_mask_t covered[HEIGHT];
+        #pragma HLS ARRAY_PARTITION variable=block_list complete dim=2
+
+        CLEAR: for (int row = 0; row < HEIGHT; row++) {
+        #pragma HLS PIPELINE II=1
+            covered[row] = 0;
+        }
+
+        LOAD: for (int b = 0; b < n_blocks; b++) {
+        #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_BLOCKS
+            for (int w = 0; w < BLOCK_WORDS; w++) {
+            #pragma HLS PIPELINE II=1
+                block_list[b][w] = blocks[b * BLOCK_WORDS + w];
+            }
+
+            row_mask_t mask = 0;
+            for (int c = 0; c < CHUNKS_PER_ROW; c++) {
+            #pragma HLS UNROLL
+                mask[c] = (c >= block_list[b][2] && c < block_list[b][3]);
+            }
+            MARK: for (int row = block_list[b][0]; row < block_list[b][1]; row++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=1 max=HEIGHT
+                covered[row] |= mask;
+            }
+        }
+
+        // Zero fill, write only
+        ZERO: for (int i = 0; i < HEIGHT * CHUNKS_PER_ROW; i++) {
+        #pragma HLS PIPELINE II=1
+            int row = i / CHUNKS_PER_ROW;
+            int c = i % CHUNKS_PER_ROW;
+            if (!covered[row][c]) out[i] = 0;
+        }
+
+        // Full resolution inside the blocks
+        BLOCKS: for (int b = 0; b < n_blocks; b++) {
+        #pragma HLS LOOP_TRIPCOUNT min=0 max=MAX_BLOCKS
+            rect_walk(in_A, in_B, out, block_list[b][0], block_list[b][1], block_list[b][2], block_list[b][3]);
+        }
+    }
+}
+
+
+/* Compare Helper Function
+    - Input  : 2 uint8_t numbers
+    - Output : Quantized absolute difference
+*/
+pixel_t Compare(pixel_t A, pixel_t B){
+    pixel_t C;
+    int16_t temp_d = (int16_t) A - (int16_t) B;
+
+    constexpr uint8_t T1 = 32;
+    constexpr uint8_t T2 = 96;
+
+    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+    if(D < T1) C = (pixel_t) 0;
+    else if(D < T2) C = (pixel_t) 128;
+    else C = (pixel_t) 255;
+
+    return C;
+}
@@ -0,0 +1,82 @@
+/*
+ * Rectangle update shared by the kernels
+ *
+ * Recomputes output rows [row_start, row_end), beats [chunk_start, chunk_end) of a
+ * frame in place, reading only the part of A and B those beats depend on: one compared
+ * row of halo above and below and one beat of halo on each side. Three compared rows
+ * are kept on chip and rotate up / mid / down, so every input beat is read once.
+ *
+ * Used as the whole body of IMAGE_DIFF_POSTERIZE_RECT (dirty_rect.cpp) and once per
+ * active block by IMAGE_DIFF_POSTERIZE_PYRAMID (pyramid.cpp). The region must lie
+ * inside the frame border, rows 1 .. HEIGHT-2, as common/dirty_rect.hpp produces it.
+ *
+ * The including kernel defines pixel_t, uint512_dt, PIXEL_SIZE, AXI_WIDTH_BITS,
+ * AXI_WIDTH_BYTES, WIDTH, HEIGHT and CHUNKS_PER_ROW and declares Compare first.
+ */
+
+#ifndef RECT_WALK_HPP
+#define RECT_WALK_HPP
+
+#include "stencil_beat.hpp"
+
+/* Recompute one rectangle of out
+    - Input  : in_A, in_B full frames, output rows [row_start, row_end), beats [chunk_start, chunk_end)
+    - Output : those beats of out, every other beat untouched
+*/
+inline void rect_walk(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                      int row_start, int row_end, int chunk_start, int chunk_end) {
+    // Three compared rows of the rectangle, rotating up / mid / down.
+    // Cyclic on the beat index so mid[c-1], mid[c], mid[c+1] come from different banks.
+    uint512_dt g_lines[3][CHUNKS_PER_ROW];
+    #pragma HLS ARRAY_PARTITION variable=g_lines complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=g_lines cyclic factor=3 dim=2
+
+    // Compare one beat of halo on each side, the filter needs the neighbouring pixel
+    const int g_first = (chunk_start > 0) ? chunk_start - 1 : 0;
+    const int g_last = (chunk_end < CHUNKS_PER_ROW) ? chunk_end + 1 : CHUNKS_PER_ROW;
+
+    int slot = 0;   // g_lines row the current compared row goes to
+
+    ROWS: for (int row = row_start - 1; row <= row_end; row++) {
+    #pragma HLS LOOP_TRIPCOUNT min=3 max=HEIGHT
+
+        COMPARE: for (int c = g_first; c < g_last; c++) {
+        #pragma HLS PIPELINE II=1
+        #pragma HLS LOOP_TRIPCOUNT min=1 max=CHUNKS_PER_ROW
+            unsigned int idx = row * CHUNKS_PER_ROW + c;
+            uint512_dt val1 = in_A[idx];
+            uint512_dt val2 = in_B[idx];
+            uint512_dt res_G;
+
+            for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+            #pragma HLS UNROLL
+                pixel_t p1 = val1.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                pixel_t p2 = val2.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                res_G.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = Compare(p1, p2);
+            }
+            g_lines[slot][c] = res_G;
+        }
+
+        // Once three rows are in, filter the middle one
+        if (row >= row_start + 1) {
+            const int s_down = slot;
+            const int s_mid = (slot == 0) ? 2 : slot - 1;
+            const int s_up = (slot == 2) ? 0 : slot + 1;
+
+            FILTER: for (int c = chunk_start; c < chunk_end; c++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=1 max=CHUNKS_PER_ROW
+                // Neighbour pixels across the beat boundary (zero outside the frame)
+                pixel_t left_px = (c > 0) ? (pixel_t)g_lines[s_mid][c - 1].range(AXI_WIDTH_BITS - 1, AXI_WIDTH_BITS - PIXEL_SIZE) : (pixel_t)0;
+                pixel_t right_px = (c < CHUNKS_PER_ROW - 1) ? (pixel_t)g_lines[s_mid][c + 1].range(PIXEL_SIZE - 1, 0) : (pixel_t)0;
+
+                out[(row - 1) * CHUNKS_PER_ROW + c] = filter_beat(g_lines[s_up][c], g_lines[s_mid][c], g_lines[s_down][c],
+                                                                  left_px, right_px, c);
+            }
+        }
+
+        slot = (slot == 2) ? 0 : slot + 1;
+    }
+}
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Frame statistics datapath shared by the kernels
+ *
+ * Histogram, nonzero count and bounding box of the output, fed one 512-bit beat at a
+ * time from wherever a kernel writes its final output beats. The word layout of the
+ * result matches common/frame_stats.hpp.
+ *
+ * Every lane keeps its own histogram so 64 pixels are binned per cycle. A bin update is
+ * a read-modify-write of block RAM that takes a few cycles, so every lane also keeps its
+ * last STATS_FWD_DEPTH (bin, count) updates in registers. A bin hit again within that
+ * window takes the count from the newest matching register instead of the RAM word
+ * that has not been written yet. The RAM is only trusted for hits STATS_DEP_DISTANCE or
+ * more beats apart, and the including kernel declares exactly that distance:
+ *     #pragma HLS DEPENDENCE variable=su.lane_hist inter RAW distance=STATS_DEP_DISTANCE true
+ * The lanes are summed once per frame.
+ *
+ * The including kernel defines pixel_t, uint512_dt, PIXEL_SIZE, AXI_WIDTH_BYTES,
+ * WIDTH and HEIGHT first.
+ */
+
+#ifndef STATS_UNIT_HPP
+#define STATS_UNIT_HPP
+
+// Stats layout, must match common/frame_stats.hpp
+#define STATS_HIST      0       // 256 bins
+#define STATS_NONZERO   256
+#define STATS_MIN_ROW   257     // bounding box of nonzero pixels, all 0xFFFFFFFF when none
+#define STATS_MAX_ROW   258
+#define STATS_MIN_COL   259
+#define STATS_MAX_COL   260
+#define STATS_WORDS     261
+
+// Forwarding window, covers the lane_hist read + increment + write latency
+#define STATS_FWD_DEPTH     3
+#define STATS_DEP_DISTANCE  (STATS_FWD_DEPTH + 1)
+
+typedef struct {
+    uint32_t lane_hist[AXI_WIDTH_BYTES][256];
+    pixel_t fwd_bin[AXI_WIDTH_BYTES][STATS_FWD_DEPTH];     // [v][0] is the newest update
+    uint32_t fwd_count[AXI_WIDTH_BYTES][STATS_FWD_DEPTH];
+    uint32_t nonzero;
+    int min_row, max_row, min_col, max_col;
+} stats_unit_t;
+
+/* Clear for a new frame (256 cycles) */
+inline void stats_clear(stats_unit_t &s) {
+    STATS_CLEAR: for (int b = 0; b < 256; b++) {
+    #pragma HLS PIPELINE II=1
+        for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+        #pragma HLS UNROLL
+            s.lane_hist[v][b] = 0;
+        }
+    }
+    for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+    #pragma HLS UNROLL
+        for (int d = 0; d < STATS_FWD_DEPTH; d++) {
+        #pragma HLS UNROLL
+            s.fwd_bin[v][d] = 0;
+            s.fwd_count[v][d] = 0;
+        }
+    }
+    s.nonzero = 0;
+    s.min_row = HEIGHT;
+    s.max_row = -1;
+    s.min_col = WIDTH;
+    s.max_col = -1;
+}
+
+/* One final output beat
+    - Input  : beat written at row, 64-pixel column chunk
+    Each output beat must be fed exactly once; call from inside the writer's pipelined loop.
+*/
+inline void stats_beat(stats_unit_t &s, uint512_dt beat, int row, int chunk) {
+    #pragma HLS INLINE
+    ap_uint<AXI_WIDTH_BYTES> active = 0;
+    for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+    #pragma HLS UNROLL
+        pixel_t px = beat.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+
+        // Oldest window entry first, so the newest match wins
+        uint32_t count = s.lane_hist[v][px];
+        for (int d = STATS_FWD_DEPTH - 1; d >= 0; d--) {
+        #pragma HLS UNROLL
+            if (s.fwd_bin[v][d] == px) count = s.fwd_count[v][d];
+        }
+        count++;
+        s.lane_hist[v][px] = count;
+
+        for (int d = STATS_FWD_DEPTH - 1; d > 0; d--) {
+        #pragma HLS UNROLL
+            s.fwd_bin[v][d] = s.fwd_bin[v][d - 1];
+            s.fwd_count[v][d] = s.fwd_count[v][d - 1];
+        }
+        s.fwd_bin[v][0] = px;
+        s.fwd_count[v][0] = count;
+        active[v] = (px != 0);
+    }
+
+    // Nonzero count and bounding box from the lane mask
+    ap_uint<8> beat_nonzero = 0;
+    int first_lane = -1, last_lane = -1;
+    for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+    #pragma HLS UNROLL
+        beat_nonzero += active[v];
+        if (active[v]) last_lane = v;
+        if (active[AXI_WIDTH_BYTES - 1 - v]) first_lane = AXI_WIDTH_BYTES - 1 - v;
+    }
+    s.nonzero += beat_nonzero;
+    if (beat_nonzero != 0) {
+        if (row < s.min_row) s.min_row = row;
+        if (row > s.max_row) s.max_row = row;
+        int first_col = chunk * AXI_WIDTH_BYTES + first_lane;
+        int last_col = chunk * AXI_WIDTH_BYTES + last_lane;
+        if (first_col < s.min_col) s.min_col = first_col;
+        if (last_col > s.max_col) s.max_col = last_col;
+    }
+}
+
+/* Zero beats are only counted, they cannot move the bounding box
+    Called outside the beat loop, after its last lane_hist write has landed.
+*/
+inline void stats_zero_beats(stats_unit_t &s, uint32_t beats) {
+    // Bin 0 of lane 0 carries the extra zeros; the merge sums all lanes anyway
+    uint32_t count = s.lane_hist[0][0] + beats * AXI_WIDTH_BYTES;
+    s.lane_hist[0][0] = count;
+    for (int d = 0; d < STATS_FWD_DEPTH; d++) {
+    #pragma HLS UNROLL
+        if (s.fwd_bin[0][d] == 0) s.fwd_count[0][d] = count;
+    }
+}
+
+/* Merge the lanes and write the result words (256 cycles) */
+inline void stats_write(stats_unit_t &s, uint32_t *stats) {
+    STATS_MERGE: for (int b = 0; b < 256; b++) {
+    #pragma HLS PIPELINE II=1
+        uint32_t sum = 0;
+        for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+        #pragma HLS UNROLL
+            sum += s.lane_hist[v][b];
+        }
+        stats[STATS_HIST + b] = sum;
+    }
+
+    bool any = (s.nonzero != 0);
+    stats[STATS_NONZERO] = s.nonzero;
+    stats[STATS_MIN_ROW] = any ? (uint32_t)s.min_row : 0xFFFFFFFFu;
+    stats[STATS_MAX_ROW] = any ? (uint32_t)s.max_row : 0xFFFFFFFFu;
+    stats[STATS_MIN_COL] = any ? (uint32_t)s.min_col : 0xFFFFFFFFu;
+    stats[STATS_MAX_COL] = any ? (uint32_t)s.max_col : 0xFFFFFFFFu;
+}
+
+#endif
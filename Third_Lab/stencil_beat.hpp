@@ -0,0 +1,47 @@
+/*
+ * Stencil filter of one 512-bit beat, shared by the kernels
+ *
+ * F = 5 * center - up - down - left - right, clipped to [0, 255], for the 64 pixels of
+ * a beat of the middle compared row. The caller supplies the beats above and below and
+ * the two pixels just outside the beat, from whatever line buffer or register window it
+ * keeps; they are zero at the frame edge. The left and right frame columns are forced
+ * to zero, the first and last rows are the caller's.
+ *
+ * The including kernel defines pixel_t, uint512_dt, PIXEL_SIZE, AXI_WIDTH_BYTES and
+ * WIDTH first.
+ */
+
+#ifndef STENCIL_BEAT_HPP
+#define STENCIL_BEAT_HPP
+
+/* Filter one beat of the middle row
+    - Input  : compared beats above, at and below, plus the pixels left and right of the beat
+    - Output : 64 filtered pixels, left and right frame columns forced to zero
+*/
+inline uint512_dt filter_beat(uint512_dt up, uint512_dt mid, uint512_dt down, pixel_t left_px, pixel_t right_px, int chunk) {
+    #pragma HLS INLINE
+    uint512_dt out_val;
+    for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
+    #pragma HLS UNROLL
+        pixel_t center = mid.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+        pixel_t above = up.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+        pixel_t below = down.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+        pixel_t left = (v == 0) ? left_px : (pixel_t)mid.range(PIXEL_SIZE * v - 1, (v - 1) * PIXEL_SIZE);
+        pixel_t right = (v == AXI_WIDTH_BYTES - 1) ? right_px : (pixel_t)mid.range(PIXEL_SIZE * (v + 2) - 1, (v + 1) * PIXEL_SIZE);
+
+        int16_t temp_filter = 5 * center    // Center pixel
+                                - above         // Up pixel
+                                - below         // Down pixel
+                                - left          // Left pixel
+                                - right;        // Right pixel
+        pixel_t filtered_pixel = (temp_filter < 0) ? 0 : (temp_filter > 255 ? 255 : temp_filter);
+
+        int col = chunk * AXI_WIDTH_BYTES + v;
+        if (col == 0 || col == WIDTH - 1) filtered_pixel = 0;
+
+        out_val.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = filtered_pixel;
+    }
+    return out_val;
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <ap_int.h>
+#include "../common/posterize_sw.hpp"
+#include "../common/workload_gen.hpp"
+
+typedef ap_uint<512> uint512_dt;
+
+extern "C" void IMAGE_DIFF_POSTERIZE_ANY_WIDTH(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                                               int width, int height);
+
+// Frame sizes around the cases of any_width_core.hpp: Q = ceil(width / 64) beats per row,
+// r = 64 * Q - width padding bytes, centre / up delays of Q / 2 * Q beats from registers
+// (up to 8) or from the delay lines
+static const int sizes[][2] = {
+    {64, 9},        // Q = 1, r = 0, the narrowest frame
+    {65, 5},        // Q = 2, r = 63
+    {127, 11},      // Q = 2, r = 1
+    {130, 7},       // Q = 3
+    {200, 3},       // Q = 4, up delay 8 is the last register one
+    {256, 6},       // Q = 4, r = 0
+    {257, 6},       // Q = 5, up from the delay line, centre from registers
+    {512, 5},       // Q = 8, centre delay 8 from registers
+    {513, 5},       // Q = 9, both from the delay lines
+    {1000, 37},
+    {1001, 1},      // single row, all border
+    {191, 2},       // two rows, all border
+    {1920, 20},
+    {3000, 13},
+    {4096, 4},      // MAX_WIDTH
+};
+
+int main() {
+    bool match = 1;
+
+    for (const auto &size : sizes) {
+        const int width = size[0];
+        const int height = size[1];
+        const int pixels = width * height;
+        const int beats = (pixels + 63) / 64;
+
+        std::vector<uint8_t> A(beats * 64), B(beats * 64), ref(pixels);
+        SceneParams params;
+        params.scene = SCENE_BLOBS;
+        params.seed = width * 7 + height;
+        generate_frame_pair(A.data(), B.data(), width, height, params);
+
+        // Garbage past the frame, the kernel must mask it off
+        for (int i = pixels; i < beats * 64; i++) {
+            A[i] = (uint8_t)(i * 37);
+            B[i] = (uint8_t)(i * 101 + 50);
+        }
+        IMAGE_DIFF_POSTERIZE_SW(A.data(), B.data(), ref.data(), width, height);
+
+        std::vector<uint512_dt> beats_A(beats), beats_B(beats), beats_out(beats);
+        for (int i = 0; i < beats; i++) {
+            for (int v = 0; v < 64; v++) {
+                beats_A[i].range(8 * v + 7, 8 * v) = A[i * 64 + v];
+                beats_B[i].range(8 * v + 7, 8 * v) = B[i * 64 + v];
+                beats_out[i].range(8 * v + 7, 8 * v) = 0xAB;
+            }
+        }
+
+        IMAGE_DIFF_POSTERIZE_ANY_WIDTH(beats_A.data(), beats_B.data(), beats_out.data(), width, height);
+
+        int bad = 0;
+        int pad = 0;
+        for (int i = 0; i < beats * 64; i++) {
+            int px = (int)beats_out[i / 64].range(8 * (i % 64) + 7, 8 * (i % 64));
+            if (i < pixels) {
+                if (px != ref[i]) {
+                    if (bad == 0) printf("Mismatch at index (%d,%d)\n", i / width, i % width);
+                    bad++;
+                }
+            } else if (px != 0) {
+                pad++;
+            }
+        }
+        printf("%dx%d: %d mismatches, %d non-zero padding bytes\n", width, height, bad, pad);
+        if (bad || pad) match = 0;
+    }
+
+    if(match){
+    	printf("Test PASSED!\n");
+    }
+    else{
+    	printf("Test FAILED!\n");
+    }
+    return match ? 0 : 1;
+}
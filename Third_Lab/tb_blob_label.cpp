@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include <hls_stream.h>
+#include <ap_axi_sdata.h>
+#include "../common/posterize_sw.hpp"
+#include "../common/blob_labeler.hpp"
+#include "../common/workload_gen.hpp"
+
+// Both labelers against a flood fill: common/blob_labeler.hpp at several sizes and both
+// connectivities, Third_Lab/blob_label.cpp at its own size (8-connected, threshold 1)
+//     g++ tb_blob_label.cpp blob_label.cpp
+// Must match Third_Lab/blob_label.cpp
+#define WIDTH 256
+#define HEIGHT 512
+#define MAX_BLOBS 256
+#define BLOBS_COUNT 0
+#define BLOBS_DROPPED 1
+#define BLOBS_FIRST 2
+#define BLOB_WORDS 5
+
+typedef ap_uint<512> uint512_dt;
+typedef ap_axiu<512, 0, 0, 0> pkt_t;
+typedef std::tuple<int, int, int, int, uint32_t> blob_key;
+
+extern "C" void BLOB_LABEL(hls::stream<pkt_t> &in, uint32_t *blobs);
+
+// Reference: flood fill from every unvisited foreground pixel
+static std::vector<MotionBlob> flood_fill(const uint8_t *frame, int width, int height, int threshold, int connectivity) {
+    std::vector<uint8_t> seen(width * height, 0);
+    std::vector<MotionBlob> blobs;
+    std::vector<int> stack;
+    for (int i = 0; i < width * height; i++) {
+        if (frame[i] < threshold || seen[i]) continue;
+        MotionBlob b = {i % width, i / width, i % width, i / width, 0};
+        seen[i] = 1;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            int p = stack.back();
+            stack.pop_back();
+            int x = p % width, y = p / width;
+            b.area++;
+            b.x0 = std::min(b.x0, x);
+            b.x1 = std::max(b.x1, x);
+            b.y0 = std::min(b.y0, y);
+            b.y1 = std::max(b.y1, y);
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (dx == 0 && dy == 0) continue;
+                    if (connectivity == 4 && dx != 0 && dy != 0) continue;
+                    int nx = x + dx, ny = y + dy;
+                    if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+                    int q = ny * width + nx;
+                    if (frame[q] >= threshold && !seen[q]) {
+                        seen[q] = 1;
+                        stack.push_back(q);
+                    }
+                }
+            }
+        }
+        blobs.push_back(b);
+    }
+    return blobs;
+}
+
+// Blobs as a sorted list, the labelers emit them in a different order than the flood fill
+static std::vector<blob_key> sorted_keys(const std::vector<MotionBlob> &blobs) {
+    std::vector<blob_key> keys;
+    for (const MotionBlob &b : blobs) keys.emplace_back(b.y0, b.x0, b.x1, b.y1, b.area);
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+// Frame to posterize: scene 0 blobs, 1 noise, 2 and 3 scattered pixels, sparse and dense
+static void make_frame(uint8_t *out, int width, int height, int scene) {
+    std::vector<uint8_t> A(width * height), B(width * height);
+    SceneParams params;
+    params.scene = (scene == 1) ? SCENE_NOISE : SCENE_BLOBS;
+    params.seed = scene + width;
+    generate_frame_pair(A.data(), B.data(), width, height, params);
+    if (scene >= 2) {
+        B = A;
+        srand(width * 31 + height);
+        for (int i = 0; i < width * height / (scene == 2 ? 800 : 20); i++) {
+            int p = rand() % (width * height);
+            B[p] = A[p] + 128;
+        }
+    }
+    IMAGE_DIFF_POSTERIZE_SW(A.data(), B.data(), out, width, height);
+}
+
+int main(){
+    const char *scenes[] = {"blobs", "noise", "sparse", "dense"};
+    bool match = 1;
+
+    // Software labeler: odd widths, widths around the 64-pixel mask, one row and one column
+    static const int sizes[][2] = {{256, 512}, {100, 37}, {63, 65}, {129, 20}, {1920, 1080}, {300, 1}, {1, 200}};
+    for (const auto &size : sizes) {
+        const int width = size[0];
+        const int height = size[1];
+        std::vector<uint8_t> frame(width * height);
+        for (int scene = 0; scene < 4; scene++) {
+            make_frame(frame.data(), width, height, scene);
+            for (int connectivity : {4, 8}) {
+                for (int threshold : {1, 200}) {
+                    BlobConfig cfg;
+                    cfg.connectivity = connectivity;
+                    cfg.threshold = threshold;
+                    std::vector<MotionBlob> got = blob_extract(frame.data(), width, height, cfg);
+                    std::vector<MotionBlob> ref = flood_fill(frame.data(), width, height, threshold, connectivity);
+                    if (sorted_keys(got) != sorted_keys(ref)) {
+                        printf("%dx%d %s, %d-connected, threshold %d: %zu blobs, expected %zu\n",
+                               width, height, scenes[scene], connectivity, threshold, got.size(), ref.size());
+                        match = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    // Kernel, fed the reference output as AXIS beats. The dense frame has more blobs than
+    // MAX_BLOBS, only the count is checked there
+    std::vector<uint8_t> frame(WIDTH * HEIGHT);
+    std::vector<uint32_t> blobs(BLOBS_FIRST + MAX_BLOBS * BLOB_WORDS);
+    for (int scene = 0; scene < 4; scene++) {
+        make_frame(frame.data(), WIDTH, HEIGHT, scene);
+        hls::stream<pkt_t> in;
+        for (int i = 0; i < WIDTH * HEIGHT / 64; i++) {
+            pkt_t pkt;
+            for (int v = 0; v < 64; v++) pkt.data.range(8 * v + 7, 8 * v) = frame[i * 64 + v];
+            pkt.keep = -1;
+            pkt.last = (i == WIDTH * HEIGHT / 64 - 1);
+            in.write(pkt);
+        }
+        BLOB_LABEL(in, blobs.data());
+
+        std::vector<MotionBlob> ref = flood_fill(frame.data(), WIDTH, HEIGHT, 1, 8);
+        std::vector<MotionBlob> got;
+        for (uint32_t i = 0; i < blobs[BLOBS_COUNT] && i < MAX_BLOBS; i++) {
+            const uint32_t *w = &blobs[BLOBS_FIRST + i * BLOB_WORDS];
+            got.push_back({(int)w[0], (int)w[1], (int)w[2], (int)w[3], w[4]});
+        }
+        printf("%s: %u blobs, %u dropped, expected %zu\n", scenes[scene], blobs[BLOBS_COUNT], blobs[BLOBS_DROPPED], ref.size());
+        if (blobs[BLOBS_COUNT] + blobs[BLOBS_DROPPED] != ref.size()) {
+            match = 0;
+        } else if (blobs[BLOBS_DROPPED] == 0 && sorted_keys(got) != sorted_keys(ref)) {
+            printf("%s: blob boxes or areas differ\n", scenes[scene]);
+            match = 0;
+        }
+    }
+
+    if(match){
+    	printf("Test PASSED!\n");
+    }
+    else{
+    	printf("Test FAILED!\n");
+    }
+    return match ? 0 : 1;
+}
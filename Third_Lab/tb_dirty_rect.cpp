@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <ap_int.h>
+#include "../common/posterize_sw.hpp"
+#include "../common/dirty_rect.hpp"
+#include "../common/workload_gen.hpp"
+
+// Must match Third_Lab/dirty_rect.cpp
+#define WIDTH 256
+#define HEIGHT 512
+#define CHUNKS_PER_ROW (WIDTH / 64)
+
+typedef ap_uint<512> uint512_dt;
+
+extern "C" void IMAGE_DIFF_POSTERIZE_RECT(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                                          int row_start, int row_end, int chunk_start, int chunk_end);
+
+static void pack(const uint8_t *pixels, uint512_dt *beats) {
+    for (int i = 0; i < WIDTH * HEIGHT / 64; i++) {
+        for (int v = 0; v < 64; v++) {
+            beats[i].range(8 * v + 7, 8 * v) = pixels[i * 64 + v];
+        }
+    }
+}
+
+static void unpack(const uint512_dt *beats, uint8_t *pixels) {
+    for (int i = 0; i < WIDTH * HEIGHT / 64; i++) {
+        for (int v = 0; v < 64; v++) {
+            pixels[i * 64 + v] = (uint8_t)beats[i].range(8 * v + 7, 8 * v);
+        }
+    }
+}
+
+// First pixel where got and ref differ, -1 when equal
+static int first_mismatch(const std::vector<uint8_t> &got, const std::vector<uint8_t> &ref) {
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        if (got[i] != ref[i]) return i;
+    }
+    return -1;
+}
+
+int main(){
+    std::vector<uint8_t> A_old(WIDTH * HEIGHT), A(WIDTH * HEIGHT), B(WIDTH * HEIGHT);
+    std::vector<uint8_t> ref_old(WIDTH * HEIGHT), ref(WIDTH * HEIGHT), hw(WIDTH * HEIGHT);
+    std::vector<uint512_dt> beats_A(WIDTH * HEIGHT / 64), beats_B(WIDTH * HEIGHT / 64), beats_out(WIDTH * HEIGHT / 64);
+    bool match = 1;
+
+    SceneParams params;
+    params.scene = SCENE_BLOBS;
+    generate_frame_pair(A_old.data(), B.data(), WIDTH, HEIGHT, params);
+    IMAGE_DIFF_POSTERIZE_SW(A_old.data(), B.data(), ref_old.data(), WIDTH, HEIGHT);
+    pack(B.data(), beats_B.data());
+
+    // Changed rectangles: the whole frame, ones touching each edge, one inside a beat
+    const DirtyRect rects[] = {
+        {0, 0, WIDTH, HEIGHT},
+        {0, 0, 70, 3},
+        {200, HEIGHT - 32, WIDTH - 200, 32},
+        {WIDTH - 1, 100, 1, 1},
+        {0, 250, 1, 40},
+        {10, 300, 20, 20},
+    };
+
+    for (const DirtyRect &r : rects) {
+        // A changes only inside r, out holds the result of the previous A
+        A = A_old;
+        for (int y = r.y; y < r.y + r.h; y++) {
+            for (int x = r.x; x < r.x + r.w; x++) {
+                A[y * WIDTH + x] = (uint8_t)(A[y * WIDTH + x] + 40 + ((x * 3 + y) & 63));
+            }
+        }
+        IMAGE_DIFF_POSTERIZE_SW(A.data(), B.data(), ref.data(), WIDTH, HEIGHT);
+        pack(A.data(), beats_A.data());
+        pack(ref_old.data(), beats_out.data());
+
+        RectLaunch launch;
+        if (!dirty_rect_launch(r, WIDTH, HEIGHT, launch)) {
+            printf("Rect %d,%d,%d,%d has no output region\n", r.x, r.y, r.w, r.h);
+            match = 0;
+            continue;
+        }
+        IMAGE_DIFF_POSTERIZE_RECT(beats_A.data(), beats_B.data(), beats_out.data(),
+                                  launch.row_start, launch.row_end, launch.chunk_start, launch.chunk_end);
+        unpack(beats_out.data(), hw.data());
+
+        int bad = first_mismatch(hw, ref);
+        if (bad >= 0) {
+            printf("Rect %d,%d,%d,%d: mismatch at index (%d,%d)\n", r.x, r.y, r.w, r.h, bad / WIDTH, bad % WIDTH);
+            match = 0;
+        }
+    }
+
+    // Empty rectangles: outside the frame there is nothing to launch, and launches with no
+    // rows or no beats must leave out untouched
+    DirtyRect outside = {WIDTH + 10, 20, 5, 5};
+    RectLaunch unused;
+    if (dirty_rect_launch(outside, WIDTH, HEIGHT, unused)) {
+        printf("Rect outside the frame produced a launch\n");
+        match = 0;
+    }
+    const RectLaunch empty[] = {
+        {100, 100, 0, CHUNKS_PER_ROW},
+        {1, HEIGHT - 1, 2, 2},
+    };
+    pack(A_old.data(), beats_A.data());
+    for (const RectLaunch &launch : empty) {
+        pack(ref_old.data(), beats_out.data());
+        IMAGE_DIFF_POSTERIZE_RECT(beats_A.data(), beats_B.data(), beats_out.data(),
+                                  launch.row_start, launch.row_end, launch.chunk_start, launch.chunk_end);
+        unpack(beats_out.data(), hw.data());
+        if (first_mismatch(hw, ref_old) >= 0) {
+            printf("Empty launch rows [%d,%d) beats [%d,%d) wrote to out\n",
+                   launch.row_start, launch.row_end, launch.chunk_start, launch.chunk_end);
+            match = 0;
+        }
+    }
+
+    if(match){
+    	printf("Test PASSED!\n");
+    }
+    else{
+    	printf("Test FAILED!\n");
+    }
+    return match ? 0 : 1;
+}
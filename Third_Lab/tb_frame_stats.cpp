@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <ap_int.h>
+#include "../common/posterize_sw.hpp"
+#include "../common/frame_stats.hpp"
+#include "../common/workload_gen.hpp"
+
+// Frame statistics of the memory-mapped kernels, built with -DFRAME_STATS:
+//     v_limit.cpp     g++ -DFRAME_STATS [-DPERF_COUNTERS] tb_frame_stats.cpp v_limit.cpp
+//     code_plus.cpp   g++ -DFRAME_STATS -DCODE_PLUS tb_frame_stats.cpp code_plus.cpp
+// Must match the kernel's frame size
+#ifdef CODE_PLUS
+#define WIDTH 256
+#define HEIGHT 256
+#else
+#define WIDTH 128
+#define HEIGHT 128
+#endif
+#define BEATS (WIDTH * HEIGHT / 64)
+
+typedef ap_uint<512> uint512_dt;
+typedef ap_uint<64> perf_t;
+
+#ifdef CODE_PLUS
+extern "C" void IMAGE_DIFF_POSTERIZE(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, unsigned int size, uint32_t *stats);
+#elif defined(PERF_COUNTERS)
+extern "C" void IMAGE_DIFF_POSTERIZE(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, perf_t *perf, uint32_t *stats);
+#else
+extern "C" void IMAGE_DIFF_POSTERIZE(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, uint32_t *stats);
+#endif
+
+static void run_kernel(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, uint32_t *stats) {
+#ifdef CODE_PLUS
+    IMAGE_DIFF_POSTERIZE(in_A, in_B, out, WIDTH * HEIGHT, stats);
+#elif defined(PERF_COUNTERS)
+    perf_t perf[8];
+    IMAGE_DIFF_POSTERIZE(in_A, in_B, out, perf, stats);
+#else
+    IMAGE_DIFF_POSTERIZE(in_A, in_B, out, stats);
+#endif
+}
+
+// Reference statistics counted beat by beat from the kernel's own output, lane by lane the
+// way the stats unit sees it
+static void stats_from_beats(const uint512_dt *out, uint32_t stats[STATS_WORDS]) {
+    frame_stats_begin(stats);
+    for (int i = 0; i < BEATS; i++) {
+        for (int v = 0; v < 64; v++) {
+            uint32_t px = (uint32_t)out[i].range(8 * v + 7, 8 * v);
+            uint32_t row = (i * 64 + v) / WIDTH;
+            uint32_t col = (i * 64 + v) % WIDTH;
+            stats[STATS_HIST + px]++;
+            if (px == 0) continue;
+            stats[STATS_NONZERO]++;
+            if (stats[STATS_MIN_ROW] == STATS_NONE) stats[STATS_MIN_ROW] = row;
+            stats[STATS_MAX_ROW] = row;
+            if (stats[STATS_MIN_COL] == STATS_NONE || col < stats[STATS_MIN_COL]) stats[STATS_MIN_COL] = col;
+            if (stats[STATS_MAX_COL] == STATS_NONE || col > stats[STATS_MAX_COL]) stats[STATS_MAX_COL] = col;
+        }
+    }
+}
+
+int main(){
+    std::vector<uint8_t> A(WIDTH * HEIGHT), B(WIDTH * HEIGHT), ref(WIDTH * HEIGHT);
+    std::vector<uint512_dt> beats_A(BEATS), beats_B(BEATS), beats_out(BEATS);
+    const char *names[] = {"noise", "quiet", "blobs", "beat stripes", "small patch"};
+    bool match = 1;
+
+    for (int frame = 0; frame < 5; frame++) {
+        SceneParams params;
+        params.scene = (frame == 0) ? SCENE_NOISE : SCENE_BLOBS;
+        params.seed = frame + 1;
+        generate_frame_pair(A.data(), B.data(), WIDTH, HEIGHT, params);
+        if (frame == 1) B = A;      // every lane of every beat hits bin 0
+        if (frame == 3) {
+            // Changes repeating every 2, 3 and 4 beats, so the same bins come back at every
+            // distance the histogram forwarding has to cover
+            for (int i = 0; i < WIDTH * HEIGHT; i++) {
+                int beat = i / 64;
+                B[i] = A[i];
+                if (beat % 2 == 0) B[i] = A[i] + 50;
+                if (beat % 3 == 0) B[i] = A[i] + 120;
+                if (beat % 4 == 1 && (i % 7) == 0) B[i] = A[i] + 200;
+            }
+        }
+        if (frame == 4) {
+            B = A;
+            for (int r = 40; r < 50; r++) {
+                for (int c = 70; c < 90; c++) B[r * WIDTH + c] = A[r * WIDTH + c] + 100;
+            }
+        }
+
+        for (int i = 0; i < BEATS; i++) {
+            for (int v = 0; v < 64; v++) {
+                beats_A[i].range(8 * v + 7, 8 * v) = A[i * 64 + v];
+                beats_B[i].range(8 * v + 7, 8 * v) = B[i * 64 + v];
+            }
+        }
+
+        uint32_t stats[STATS_WORDS], ref_stats[STATS_WORDS];
+        run_kernel(beats_A.data(), beats_B.data(), beats_out.data(), stats);
+
+        IMAGE_DIFF_POSTERIZE_SW(A.data(), B.data(), ref.data(), WIDTH, HEIGHT);
+        for (int i = 0; i < WIDTH * HEIGHT; i++) {
+            if ((int)beats_out[i / 64].range(8 * (i % 64) + 7, 8 * (i % 64)) != ref[i]) {
+                printf("%s: output mismatch at index (%d,%d)\n", names[frame], i / WIDTH, i % WIDTH);
+                match = 0;
+                break;
+            }
+        }
+
+        stats_from_beats(beats_out.data(), ref_stats);
+        for (int w = 0; w < STATS_WORDS; w++) {
+            if (stats[w] != ref_stats[w]) {
+                printf("%s: stats word %d is %u, expected %u\n", names[frame], w, stats[w], ref_stats[w]);
+                match = 0;
+                break;
+            }
+        }
+        printf("%s: %u nonzero\n", names[frame], stats[STATS_NONZERO]);
+    }
+
+    if(match){
+    	printf("Test PASSED!\n");
+    }
+    else{
+    	printf("Test FAILED!\n");
+    }
+    return match ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include <ap_int.h>
+#include "../common/morphology.hpp"
+#include "../common/workload_gen.hpp"
+
+// Every morphology mode of the fused kernel against the separable reference of
+// common/morphology.hpp, which is itself checked against the full 3x3 window
+//     g++ tb_morph_fused.cpp morph_fused.cpp
+// Must match Third_Lab/morph_fused.cpp
+#define WIDTH 256
+#define HEIGHT 512
+#define BEATS (WIDTH * HEIGHT / 64)
+
+typedef ap_uint<512> uint512_dt;
+
+extern "C" void IMAGE_DIFF_POSTERIZE_MORPH(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out, unsigned int mode);
+
+// Reference of the reference: min / max over the 3x3 window, clipped at the frame edge
+static int brute_force_errors(const uint8_t *in, const uint8_t *out, int width, int height, bool dilate) {
+    int errors = 0;
+    for (int r = 0; r < height; r++) {
+        for (int c = 0; c < width; c++) {
+            int v = in[r * width + c];
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int y = r + dy, x = c + dx;
+                    if (y < 0 || x < 0 || y >= height || x >= width) continue;
+                    v = dilate ? std::max(v, (int)in[y * width + x]) : std::min(v, (int)in[y * width + x]);
+                }
+            }
+            if (v != out[r * width + c]) errors++;
+        }
+    }
+    return errors;
+}
+
+int main(){
+    const char *scenes[] = {"blobs", "noise", "quiet", "specks"};
+    const char *modes[] = {"none", "open", "close"};
+    bool match = 1;
+
+    // Separable erode / dilate against the 3x3 window, including sizes narrower than a beat
+    static const int sizes[][2] = {{37, 23}, {64, 3}, {1, 9}, {130, 1}};
+    for (const auto &size : sizes) {
+        std::vector<uint8_t> in(size[0] * size[1]), out(size[0] * size[1]);
+        srand(size[0] * 131 + size[1]);
+        for (uint8_t &px : in) px = (uint8_t)rand();
+        for (int dilate = 0; dilate < 2; dilate++) {
+            morph3x3_sw(in.data(), out.data(), size[0], size[1], dilate);
+            int errors = brute_force_errors(in.data(), out.data(), size[0], size[1], dilate);
+            if (errors) {
+                printf("%dx%d %s: %d pixels differ from the 3x3 window\n", size[0], size[1], dilate ? "dilate" : "erode", errors);
+                match = 0;
+            }
+        }
+    }
+
+    std::vector<uint8_t> A(WIDTH * HEIGHT), B(WIDTH * HEIGHT), ref(WIDTH * HEIGHT);
+    std::vector<uint512_dt> beats_A(BEATS), beats_B(BEATS), beats_out(BEATS);
+    for (int scene = 0; scene < 4; scene++) {
+        SceneParams params;
+        params.scene = (scene == 1) ? SCENE_NOISE : SCENE_BLOBS;
+        params.seed = scene + 1;
+        generate_frame_pair(A.data(), B.data(), WIDTH, HEIGHT, params);
+        if (scene == 2) B = A;
+        if (scene == 3) {
+            // Single pixels and one-pixel gaps, at the frame and beat edges too, that
+            // opening removes and closing fills
+            B = A;
+            for (int i = 0; i < WIDTH * HEIGHT; i += 61) B[i] = A[i] + 128;
+            for (int r = 0; r < HEIGHT; r += 37) {
+                for (int c = 0; c < WIDTH; c++) {
+                    if (c % 64 != 63) B[r * WIDTH + c] = A[r * WIDTH + c] + 100;
+                }
+            }
+        }
+        for (int i = 0; i < BEATS; i++) {
+            for (int v = 0; v < 64; v++) {
+                beats_A[i].range(8 * v + 7, 8 * v) = A[i * 64 + v];
+                beats_B[i].range(8 * v + 7, 8 * v) = B[i * 64 + v];
+            }
+        }
+
+        for (int mode = MORPH_MODE_NONE; mode <= MORPH_MODE_CLOSE; mode++) {
+            IMAGE_DIFF_POSTERIZE_MORPH(beats_A.data(), beats_B.data(), beats_out.data(), mode);
+            IMAGE_DIFF_POSTERIZE_MORPH_SW(A.data(), B.data(), ref.data(), WIDTH, HEIGHT, mode);
+
+            int bad = 0;
+            int nonzero = 0;
+            for (int i = 0; i < WIDTH * HEIGHT; i++) {
+                int px = (int)beats_out[i / 64].range(8 * (i % 64) + 7, 8 * (i % 64));
+                if (ref[i] != 0) nonzero++;
+                if (px != ref[i]) {
+                    if (bad == 0) printf("%s, %s: mismatch at index (%d,%d)\n", scenes[scene], modes[mode], i / WIDTH, i % WIDTH);
+                    bad++;
+                }
+            }
+            printf("%s, %s: %d nonzero, %d mismatches\n", scenes[scene], modes[mode], nonzero, bad);
+            if (bad) match = 0;
+        }
+    }
+
+    if(match){
+    	printf("Test PASSED!\n");
+    }
+    else{
+    	printf("Test FAILED!\n");
+    }
+    return match ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <ap_int.h>
+#include "../common/posterize_sw.hpp"
+#include "../common/workload_gen.hpp"
+#include "../common/descriptor_ring.hpp"
+
+// C simulation of the descriptor ring: the kernel runs in its own thread, main() plays the
+// host side of persistent_host.cpp on shared memory. Build with -pthread.
+#define WIDTH 1000
+#define HEIGHT 9
+#define SLOTS 4              // ring slots, fewer than frames so slots are reused
+#define POOL_FRAMES 3        // not a multiple of SLOTS, so slot and pool index drift apart
+#define FRAMES 25
+
+typedef ap_uint<512> uint512_dt;
+
+extern "C" void IMAGE_DIFF_POSTERIZE_PERSISTENT(volatile uint32_t *ring, const uint512_dt *pool_A, const uint512_dt *pool_B,
+                                                uint512_dt *pool_out, volatile uint32_t *done, int ring_slots);
+
+static volatile uint32_t ring[SLOTS * sizeof(FrameDescriptor) / sizeof(uint32_t)];
+static volatile uint32_t done[1];
+
+// Same order as the host: payload words, then the sequence word
+static void publish(uint32_t n, const FrameDescriptor &d) {
+    uint32_t words[sizeof(FrameDescriptor) / sizeof(uint32_t)];
+    memcpy(words, &d, sizeof(d));
+    volatile uint32_t *slot = ring + (n % SLOTS) * (sizeof(FrameDescriptor) / sizeof(uint32_t));
+    for (size_t i = 1; i < sizeof(FrameDescriptor) / sizeof(uint32_t); i++) slot[i] = words[i];
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    slot[0] = words[0];
+}
+
+int main(){
+    const int pixels = WIDTH * HEIGHT;
+    const int frame_beats = (pixels + 63) / 64;
+    const int t1[POOL_FRAMES] = {32, 20, 40};
+    const int t2[POOL_FRAMES] = {96, 60, 100};
+    bool match = 1;
+
+    std::vector<uint8_t> A(POOL_FRAMES * frame_beats * 64, 0), B(POOL_FRAMES * frame_beats * 64, 0);
+    for (int p = 0; p < POOL_FRAMES; p++) {
+        SceneParams params;
+        params.scene = SCENE_BLOBS;
+        params.seed = p + 1;
+        generate_frame_pair(&A[p * frame_beats * 64], &B[p * frame_beats * 64], WIDTH, HEIGHT, params);
+    }
+
+    std::vector<uint512_dt> pool_A(POOL_FRAMES * frame_beats), pool_B(POOL_FRAMES * frame_beats);
+    std::vector<uint512_dt> pool_out(POOL_FRAMES * frame_beats);
+    for (int i = 0; i < POOL_FRAMES * frame_beats; i++) {
+        for (int v = 0; v < 64; v++) {
+            pool_A[i].range(8 * v + 7, 8 * v) = A[i * 64 + v];
+            pool_B[i].range(8 * v + 7, 8 * v) = B[i * 64 + v];
+        }
+    }
+
+    std::thread kernel([&]() {
+        IMAGE_DIFF_POSTERIZE_PERSISTENT(ring, pool_A.data(), pool_B.data(), pool_out.data(), done, SLOTS);
+    });
+
+    // Frame n may only go into its slot once the descriptor a lap back has completed
+    uint32_t completed = 0;
+    const size_t frame_bytes = (size_t)frame_beats * 64;
+    for (int n = 0; n <= FRAMES; n++) {
+        while ((uint32_t)n >= completed + SLOTS) completed = done[0];
+        int p = n % POOL_FRAMES;
+        if (n < FRAMES) {
+            publish(n, frame_descriptor(n, p * frame_bytes, p * frame_bytes, p * frame_bytes, WIDTH, HEIGHT, t1[p], t2[p]));
+        } else {
+            publish(n, stop_descriptor(n));
+        }
+    }
+    kernel.join();
+
+    if (done[0] != FRAMES + 1) {
+        printf("Completion word %u, expected %d\n", done[0], FRAMES + 1);
+        match = 0;
+    }
+
+    // Every pool slot against the CPU reference with its own thresholds
+    std::vector<uint8_t> ref(pixels);
+    for (int p = 0; p < POOL_FRAMES; p++) {
+        IMAGE_DIFF_POSTERIZE_SW(&A[p * frame_bytes], &B[p * frame_bytes], ref.data(), WIDTH, HEIGHT, t1[p], t2[p]);
+        for (int i = 0; i < pixels; i++) {
+            const uint512_dt &beat = pool_out[p * frame_beats + i / 64];
+            if ((int)beat.range(8 * (i % 64) + 7, 8 * (i % 64)) != ref[i]) {
+                printf("Mismatch in pool frame %d at index (%d,%d)\n", p, i / WIDTH, i % WIDTH);
+                match = 0;
+                break;
+            }
+        }
+    }
+
+    if(match){
+    	printf("Test PASSED!\n");
+    }
+    else{
+    	printf("Test FAILED!\n");
+    }
+    return match ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <ap_int.h>
+#include "../common/posterize_sw.hpp"
+#include "../common/pyramid.hpp"
+#include "../common/workload_gen.hpp"
+
+// Coarse-to-fine kernel against IMAGE_DIFF_POSTERIZE_SW_PYRAMID, bit for bit, at several
+// sampling factors and block sizes. With factor 1 both must also equal the full frame.
+// Must match Third_Lab/pyramid.cpp
+#define WIDTH 256
+#define HEIGHT 512
+#define BEATS (WIDTH * HEIGHT / 64)
+
+typedef ap_uint<512> uint512_dt;
+
+extern "C" void IMAGE_DIFF_POSTERIZE_PYRAMID(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out,
+                                             const int *blocks, int n_blocks);
+
+int main(){
+    const char *scenes[] = {"blobs", "noise", "sensor"};
+    static const int blocks[][2] = {{64, 16}, {128, 8}, {64, 1}};
+    bool match = 1;
+
+    std::vector<uint8_t> A(WIDTH * HEIGHT), B(WIDTH * HEIGHT), ref(WIDTH * HEIGHT), full(WIDTH * HEIGHT);
+    std::vector<uint512_dt> beats_A(BEATS), beats_B(BEATS), beats_out(BEATS);
+    for (int scene = 0; scene < 3; scene++) {
+        SceneParams params;
+        params.scene = (scene == 0) ? SCENE_BLOBS : (scene == 1) ? SCENE_NOISE : SCENE_SENSOR;
+        params.seed = scene + 1;
+        generate_frame_pair(A.data(), B.data(), WIDTH, HEIGHT, params);
+        IMAGE_DIFF_POSTERIZE_SW(A.data(), B.data(), full.data(), WIDTH, HEIGHT);
+        for (int i = 0; i < BEATS; i++) {
+            for (int v = 0; v < 64; v++) {
+                beats_A[i].range(8 * v + 7, 8 * v) = A[i * 64 + v];
+                beats_B[i].range(8 * v + 7, 8 * v) = B[i * 64 + v];
+            }
+        }
+
+        for (const auto &block : blocks) {
+            for (int factor : {1, 4, 8}) {
+                PyramidConfig cfg;
+                cfg.factor = factor;
+                cfg.block_w = block[0];
+                cfg.block_h = block[1];
+                std::vector<DirtyRect> rects;
+                IMAGE_DIFF_POSTERIZE_SW_PYRAMID(A.data(), B.data(), ref.data(), WIDTH, HEIGHT, cfg, &rects);
+                std::vector<int> list = pyramid_block_list(rects, WIDTH, HEIGHT);
+                if (list.size() / 4 > PYRAMID_MAX_BLOCKS) {
+                    printf("%s, %dx%d blocks, factor %d: %zu blocks, over the kernel's list, skipped\n",
+                           scenes[scene], block[0], block[1], factor, list.size() / 4);
+                    continue;
+                }
+
+                // Stale output everywhere, every beat must be written
+                for (int i = 0; i < BEATS; i++) beats_out[i] = ~uint512_dt(0);
+                IMAGE_DIFF_POSTERIZE_PYRAMID(beats_A.data(), beats_B.data(), beats_out.data(), list.data(), list.size() / 4);
+
+                int bad = 0;
+                int missed = 0;
+                for (int i = 0; i < WIDTH * HEIGHT; i++) {
+                    int px = (int)beats_out[i / 64].range(8 * (i % 64) + 7, 8 * (i % 64));
+                    if (px != ref[i]) {
+                        if (bad == 0) printf("%s, %dx%d blocks, factor %d: mismatch at index (%d,%d)\n",
+                                             scenes[scene], block[0], block[1], factor, i / WIDTH, i % WIDTH);
+                        bad++;
+                    }
+                    if (ref[i] != full[i]) missed++;
+                }
+                printf("%s, %dx%d blocks, factor %d: %zu blocks, coverage %.2f, %d pixels missed by the coarse pass\n",
+                       scenes[scene], block[0], block[1], factor, list.size() / 4, pyramid_coverage(rects, WIDTH, HEIGHT), missed);
+                if (bad || (factor == 1 && missed)) match = 0;
+            }
+        }
+    }
+
+    // Hand-picked blocks on a noise frame, where every halo pixel matters: inside a block
+    // the output is the full frame, everywhere else zero
+    SceneParams params;
+    params.scene = SCENE_NOISE;
+    generate_frame_pair(A.data(), B.data(), WIDTH, HEIGHT, params);
+    IMAGE_DIFF_POSTERIZE_SW(A.data(), B.data(), full.data(), WIDTH, HEIGHT);
+    for (int i = 0; i < BEATS; i++) {
+        for (int v = 0; v < 64; v++) {
+            beats_A[i].range(8 * v + 7, 8 * v) = A[i * 64 + v];
+            beats_B[i].range(8 * v + 7, 8 * v) = B[i * 64 + v];
+        }
+        beats_out[i] = ~uint512_dt(0);
+    }
+    const int list[] = {
+        1, HEIGHT - 1, 1, 3,        // middle beats, every row
+        5, 9, 3, 4,                 // last beat
+        200, 201, 0, 1,             // one row, first beat
+        300, 340, 2, 4,
+        310, 320, 1, 3,             // overlaps the one above
+    };
+    const int n_blocks = sizeof(list) / sizeof(list[0]) / 4;
+    IMAGE_DIFF_POSTERIZE_PYRAMID(beats_A.data(), beats_B.data(), beats_out.data(), list, n_blocks);
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        int row = i / WIDTH, c = (i % WIDTH) / 64;
+        bool covered = false;
+        for (int b = 0; b < n_blocks; b++) {
+            if (row >= list[4 * b] && row < list[4 * b + 1] && c >= list[4 * b + 2] && c < list[4 * b + 3]) covered = true;
+        }
+        int px = (int)beats_out[i / 64].range(8 * (i % 64) + 7, 8 * (i % 64));
+        if (px != (covered ? full[i] : 0)) {
+            printf("Hand-picked blocks: mismatch at index (%d,%d)\n", row, i % WIDTH);
+            match = 0;
+            break;
+        }
+    }
+
+    if(match){
+    	printf("Test PASSED!\n");
+    }
+    else{
+    	printf("Test FAILED!\n");
+    }
+    return match ? 0 : 1;
+}
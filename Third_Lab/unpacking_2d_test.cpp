@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cstdint>
+#include "../common/pack.hpp"
 
 #define DATAWIDTH 32
 #define BUFFER_HEIGHT 3
@@ -20,35 +21,16 @@ int main()
     uint8_t uncpacked[BUFFER_HEIGHT][BUFFER_WIDTH];
     
     uint8_t counter = 1;
-    uint32_t pack = 0;
-    int pack_index = 0;
     for(int i=0; i<HEIGHT; i++){
         for(int j=0; j < WIDTH; j++){
             original[i][j] = counter;
             counter ++;
-            pack = pack | (original[i][j] << (((j + i*WIDTH) % VECTOR_SIZE) * 8));
-            if( ((j + i*WIDTH + 1) % VECTOR_SIZE) == 0 ){
-                packed_data[pack_index] = pack;
-                pack = 0;
-                pack_index++;
-            }
         }
     }
+    pack_words(&original[0][0], NUM_PACKETS * VECTOR_SIZE, packed_data);
 
-    // Unpack the data
-    int pixel_idx = 0;
-    for(int i = 0; i < BUFFER_HEIGHT; i++){
-        uint32_t data_packet = packed_data[pixel_idx / VECTOR_SIZE];
-        for(int j = 0; j < BUFFER_WIDTH; j++){
-            int offset = (pixel_idx % VECTOR_SIZE) * 8;
-            uncpacked[i][j] = (data_packet >> offset) & 0xFF;
-            pixel_idx++;
-            if((pixel_idx % VECTOR_SIZE) == 0){
-                data_packet = packed_data[pixel_idx / VECTOR_SIZE];
-            }
-        }
-        pixel_idx += (WIDTH - BUFFER_WIDTH);
-    }
+    // Unpack the top-left window
+    gather_window(packed_data, WIDTH, 0, 0, BUFFER_WIDTH, BUFFER_HEIGHT, &uncpacked[0][0]);
 
     // Print results
     std::cout << "Original Data:" << std::endl;
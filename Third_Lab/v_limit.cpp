@@ -29,15 +29,51 @@ const unsigned int h_steps = (WIDTH - BUFFER_WIDTH_BYTES) / (AXI_WIDTH_BYTES) +
 typedef ap_uint<AXI_WIDTH_BITS> uint512_dt;
 typedef ap_uint<PIXEL_SIZE> pixel_t;
 
+// Optional performance counters (build with -DPERF_COUNTERS)
+// Indices must match common/perf_counters.hpp
+#ifdef PERF_COUNTERS
+#define PERF_TOTAL_CYCLES       0   // free-running, kernel start to done
+#define PERF_READ_STALL_CYCLES  1   // F stage waiting on stream_G (G waiting on m_axi reads)
+#define PERF_WRITE_STALL_CYCLES 2   // pipeline frozen by out write back-pressure (and fill/drain)
+#define PERF_BEATS_READ         3   // 512-bit beats read from in_A + in_B
+#define PERF_BEATS_WRITTEN      4   // 512-bit beats written to out
+#define PERF_NUM_COUNTERS       5
+typedef ap_uint<64> perf_t;
+#endif
+
+// Optional frame statistics of the output (build with -DFRAME_STATS), gathered as the
+// beats are written so the host can skip reading back frames without changes
+#ifdef FRAME_STATS
+#include "stats_unit.hpp"
+#endif
+
 // Helper Functions
 pixel_t Compare(pixel_t A, pixel_t B);
+void posterize_core(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out
+#ifdef PERF_COUNTERS
+                    , hls::stream<perf_t> &core_counts
+#endif
+#ifdef FRAME_STATS
+                    , uint32_t *stats
+#endif
+                    );
+#ifdef PERF_COUNTERS
+void perf_counter(hls::stream<perf_t> &core_counts, perf_t *perf);
+#endif
 
 const unsigned int c_size = BUFFER_WIDTH_BYTES;
 const unsigned int c_len = HEIGHT*WIDTH / c_size;
 
 // MAIN
 extern "C" {
-    void IMAGE_DIFF_POSTERIZE(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out)
+    void IMAGE_DIFF_POSTERIZE(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out
+#ifdef PERF_COUNTERS
+                              , perf_t *perf
+#endif
+#ifdef FRAME_STATS
+                              , uint32_t *stats
+#endif
+                              )
     {
         // INTERFACE DIRECTIVES
         #pragma HLS INTERFACE m_axi port = in_A offset = slave bundle = gmem0
@@ -48,64 +84,142 @@ extern "C" {
         #pragma HLS INTERFACE s_axilite port = out bundle = control
         #pragma HLS INTERFACE s_axilite port = return bundle = control
 
+#ifdef FRAME_STATS
+        // Histogram, nonzero count and bounding box, STATS_WORDS words written at the end
+        #pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem2 depth = 261
+        #pragma HLS INTERFACE s_axilite port = stats bundle = control
+#endif
 
-        // Local Buffers
-        pixel_t Prior_chunk_1[BUFFER_WIDTH_BYTES];
-        pixel_t Prior_chunk_2[BUFFER_WIDTH_BYTES];
-        pixel_t Filtered_chunk[BUFFER_WIDTH_BYTES];
-        pixel_t inter_pixels[2][V_LIMIT];
+#ifdef PERF_COUNTERS
+        // The Vitis kernel flow only passes buffers and by-value scalars, so by default the
+        // counters are written once at the end into a 5 word buffer whose address sits in the
+        // s_axilite map. -DPERF_COUNTERS_AXILITE maps them into the control registers instead
+        // (IP flow, read them with xrt::ip / devmem). perf is written by its own DATAFLOW
+        // process, so it gets its own bundle rather than sharing gmem2 with posterize_core.
+#ifdef PERF_COUNTERS_AXILITE
+        #pragma HLS INTERFACE s_axilite port = perf bundle = control
+#else
+        #pragma HLS INTERFACE m_axi port = perf offset = slave bundle = gmem4 depth = 5
+        #pragma HLS INTERFACE s_axilite port = perf bundle = control
+#endif
 
-        #pragma HLS ARRAY_PARTITION variable=inter_pixels complete dim=1
-        #pragma HLS ARRAY_PARTITION variable=Prior_chunk_1 complete
-        #pragma HLS ARRAY_PARTITION variable=Prior_chunk_2 complete
-        #pragma HLS ARRAY_PARTITION variable=Filtered_chunk complete
-        #pragma HLS ARRAY_PARTITION variable=inter_pixels complete
+        // Counter runs next to the datapath, the core hands over its counts when it is done
+        hls::stream<perf_t> core_counts;
+        #pragma HLS STREAM variable=core_counts depth=4
+        #pragma HLS DATAFLOW
 
-        // Stream Declaration
-        hls::stream<uint512_dt> stream_G;  // We don't mind that it is HEIGHT sized, finally becomes just a stream of fixed depth.
+        posterize_core(in_A, in_B, out, core_counts
+#ifdef FRAME_STATS
+                       , stats
+#endif
+                       );
+        perf_counter(core_counts, perf);
+#else
+        posterize_core(in_A, in_B, out
+#ifdef FRAME_STATS
+                       , stats
+#endif
+                       );
+#endif
+    }
+}
 
-        // Calculate number of vertical steps
-        const int v_steps = (HEIGHT % V_LIMIT) ? (HEIGHT / V_LIMIT) + 1 : (HEIGHT / V_LIMIT);
 
-        for (int v_step = 0; v_step < v_steps; v_step++){
+/* CORE: COMPARE + FILTER
+    - Input  : in_A, in_B frames (512-bit packed)
+    - Output : filtered frame, plus the datapath counts when PERF_COUNTERS is set
+               and the frame statistics when FRAME_STATS is set
+*/
+void posterize_core(const uint512_dt *in_A, const uint512_dt *in_B, uint512_dt *out
+#ifdef PERF_COUNTERS
+                    , hls::stream<perf_t> &core_counts
+#endif
+#ifdef FRAME_STATS
+                    , uint32_t *stats
+#endif
+                    )
+{
+#ifdef PERF_COUNTERS
+    perf_t read_stall = 0;      // spins on an empty stream_G
+    perf_t busy = 0;            // cycles the write side did useful work
+    perf_t beats_read = 0;
+    perf_t beats_written = 0;
+#endif
 
-            // Handle row range for this vertical step
-            int ref_row = (v_step == 0) ? 0 : v_step * V_LIMIT - 2;
-            unsigned int last_row = (v_step + 1) * V_LIMIT;
+#ifdef FRAME_STATS
+    stats_unit_t su;
+    #pragma HLS ARRAY_PARTITION variable=su.lane_hist complete dim=1
+    #pragma HLS DEPENDENCE variable=su.lane_hist inter RAW distance=STATS_DEP_DISTANCE true
+    #pragma HLS ARRAY_PARTITION variable=su.fwd_bin complete dim=0
+    #pragma HLS ARRAY_PARTITION variable=su.fwd_count complete dim=0
+    stats_clear(su);
+#endif
 
-            // Clamp to image height
-            if (last_row > HEIGHT) last_row = HEIGHT;
+    // Local Buffers
+    pixel_t Prior_chunk_1[BUFFER_WIDTH_BYTES];
+    pixel_t Prior_chunk_2[BUFFER_WIDTH_BYTES];
+    pixel_t Filtered_chunk[BUFFER_WIDTH_BYTES];
+    pixel_t inter_pixels[2][V_LIMIT];
 
-            // Special case for single step to include last row and start from 0
-            if (v_steps == 1) {
-                last_row = HEIGHT;
-                ref_row = 0;
-            }
+    #pragma HLS ARRAY_PARTITION variable=inter_pixels complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=Prior_chunk_1 complete
+    #pragma HLS ARRAY_PARTITION variable=Prior_chunk_2 complete
+    #pragma HLS ARRAY_PARTITION variable=Filtered_chunk complete
+    #pragma HLS ARRAY_PARTITION variable=inter_pixels complete
+
+    // Stream Declaration
+    hls::stream<uint512_dt> stream_G;  // We don't mind that it is HEIGHT sized, finally becomes just a stream of fixed depth.
 
+    // Calculate number of vertical steps
+    const int v_steps = (HEIGHT % V_LIMIT) ? (HEIGHT / V_LIMIT) + 1 : (HEIGHT / V_LIMIT);
 
-            // Shift the buffer horizontally
-            for (int h_step = 0; h_step < h_steps; h_step++) {
+    for (int v_step = 0; v_step < v_steps; v_step++){
 
-            // Stream to connect Stage 1 of Comparison and Stage 2 of filtering
-            #pragma HLS DATAFLOW
-            #pragma HLS STREAM variable=stream_G depth = 100    
+        // Handle row range for this vertical step
+        int ref_row = (v_step == 0) ? 0 : v_step * V_LIMIT - 2;
+        unsigned int last_row = (v_step + 1) * V_LIMIT;
 
-                int curr_buf = h_step % 2;
-                int prev_buf = 1 - curr_buf;
+        // Clamp to image height
+        if (last_row > HEIGHT) last_row = HEIGHT;
 
-                // Loop the buffer and compare over all image rows
-                for (int row = ref_row; row < last_row; row++) {
-                    unsigned int href_point = h_step * AXI_WIDTH_BYTES;
-                    unsigned int ref_point = (row*WIDTH + href_point)/AXI_WIDTH_BYTES;
+        // Special case for single step to include last row and start from 0
+        if (v_steps == 1) {
+            last_row = HEIGHT;
+            ref_row = 0;
+        }
 
 
-                    for (int i = 0; i < BUFFER_WIDTH_CHUNKS; i++) {
-                    #pragma HLS PIPELINE II=1
+        // Shift the buffer horizontally
+        for (int h_step = 0; h_step < h_steps; h_step++) {
+
+        // Stream to connect Stage 1 of Comparison and Stage 2 of filtering
+        #pragma HLS DATAFLOW
+        #pragma HLS STREAM variable=stream_G depth = 100    
 
-                        uint512_dt val1 = in_A[ref_point + i];
-                        uint512_dt val2 = in_B[ref_point + i];
-                        uint512_dt res_G;
+            int curr_buf = h_step % 2;
+            int prev_buf = 1 - curr_buf;
+
+            // Loop the buffer and compare over all image rows
+            for (int row = ref_row; row < last_row; row++) {
+                unsigned int href_point = h_step * AXI_WIDTH_BYTES;
+                unsigned int ref_point = (row*WIDTH + href_point)/AXI_WIDTH_BYTES;
+
+
+                for (int i = 0; i < BUFFER_WIDTH_CHUNKS; i++) {
+                #pragma HLS PIPELINE II=1
+
+                    uint512_dt val1 = in_A[ref_point + i];
+                    uint512_dt val2 = in_B[ref_point + i];
+                    uint512_dt res_G;
+#ifdef PERF_COUNTERS
+                    beats_read += 2;
+#endif
 
+                    // Identical words (XOR-fold to zero) compare to all zeros, the lanes are bypassed
+                    if ((val1 ^ val2) == 0) {
+                        res_G = 0;
+                    }
+                    else {
                         // Compute Compare (Posterize) on all AXI PIXELS (64 elements) in parallel
                         for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
                             #pragma HLS UNROLL
@@ -120,109 +234,192 @@ extern "C" {
                             // Re-pack
                             res_G.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = g_val;
                         }
-
-                        // Push G result to the stream for the next stage
-                        stream_G.write(res_G);
                     }
+
+                    // Push G result to the stream for the next stage
+                    stream_G.write(res_G);
                 }
+            }
+
+            for(int k=0; k<BUFFER_WIDTH_BYTES; k++) {
+                #pragma HLS UNROLL
+                Prior_chunk_1[k] = 0;
+                Prior_chunk_2[k] = 0;
+            }
+
+            // The buffer rows hold only zeros (identical A and B rows, or the zero padding)
+            bool prior_zero_1 = true;
+            bool prior_zero_2 = true;
+
+            // Filter the buffer over rows and output
+            for (int row = ref_row; row < last_row; row++) {
+
+                // Declaring here for hinting a temporary storage
+                pixel_t Current_chunk[BUFFER_WIDTH_BYTES];
+                #pragma HLS ARRAY_PARTITION variable=Current_chunk complete
+
+                unsigned int href_point = h_step * AXI_WIDTH_BYTES;
+                bool current_zero = true;
+
+                // Row chunk unpacking
+#ifdef PERF_COUNTERS
+                // One read_nb per pipelined iteration: an empty stream_G counts a stall and the
+                // chunk index only advances on a successful read, so the loop keeps II=1
+                int chunk = 0;
+                READ_LOOP: while (chunk < BUFFER_WIDTH_CHUNKS) {
+                #pragma HLS PIPELINE II=1
+                    uint512_dt temp_val;
+                    if (!stream_G.read_nb(temp_val)) {
+                        read_stall++;
+                        continue;
+                    }
+                    busy++;
+#else
+                READ_LOOP: for (int chunk = 0; chunk < BUFFER_WIDTH_CHUNKS; chunk++) {
+                #pragma HLS PIPELINE II=1
+                    uint512_dt temp_val = stream_G.read();
+#endif
+                    current_zero = current_zero && (temp_val == 0);
 
-                for(int k=0; k<BUFFER_WIDTH_BYTES; k++) {
+                    for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
                     #pragma HLS UNROLL
-                    Prior_chunk_1[k] = 0;
-                    Prior_chunk_2[k] = 0;
+                        Current_chunk[chunk*AXI_WIDTH_BYTES + v] = temp_val.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                    }
+#ifdef PERF_COUNTERS
+                    chunk++;
+#endif
                 }
 
-                // Filter the buffer over rows and output
-                for (int row = ref_row; row < last_row; row++) {
+                if (row >= ref_row + 2) {  // All lines available, normal operation
 
-                    // Declaring here for hinting a temporary storage
-                    pixel_t Current_chunk[BUFFER_WIDTH_BYTES];
-                    #pragma HLS ARRAY_PARTITION variable=Current_chunk complete
+                    // Filtering Logic
+                    if(href_point == 0){
+                        // First pixel of the chunk at the left border
+                        Filtered_chunk[0] = 0;
+                    }
+                    else{
+                        if(WIDTH >128)
+                        Filtered_chunk[0] = inter_pixels[prev_buf][row - 2 - ref_row];
+                    }
 
-                    unsigned int href_point = h_step * AXI_WIDTH_BYTES;
+                    // Up, centre and down rows all zero: the stencil gives zero, skip it
+                    bool zero_rows = current_zero && prior_zero_1 && prior_zero_2;
 
-                    // Row chunk unpacking
-                    for (int chunk = 0; chunk < BUFFER_WIDTH_CHUNKS; chunk++) {
-                    #pragma HLS PIPELINE II=1
-
-                        uint512_dt temp_val = stream_G.read();
+                    for (int col = 1; col < BUFFER_WIDTH_BYTES; col++) {
+                    #pragma HLS UNROLL
 
-                        for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
-                        #pragma HLS UNROLL
-                            Current_chunk[chunk*AXI_WIDTH_BYTES + v] = temp_val.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE);
+                        if (col == BUFFER_WIDTH_BYTES - 1 || zero_rows){
+                            Filtered_chunk[col] = 0;
+                        }
+                        else {
+                            int16_t temp_filter = 5 * Prior_chunk_1[col]        // Center pixel
+                                                    - Current_chunk[col]        // Down pixel
+                                                    - Prior_chunk_2[col]        // Up pixel
+                                                    - Prior_chunk_1[col - 1]    // Left pixel
+                                                    - Prior_chunk_1[col + 1];   // Right pixel
+
+                            // Clamping the result to [0, 255]
+                            pixel_t filtered_pixel = (pixel_t) (temp_filter < 0) ? 0 : (temp_filter > 255 ? 255 : temp_filter);
+
+                            // Write back to output buffer
+                            Filtered_chunk[col] = filtered_pixel;
                         }
                     }
 
-                    if (row >= ref_row + 2) {  // All lines available, normal operation
+                    // Middle pixel of the chunk
+                    if(WIDTH > 128)
+                        inter_pixels[curr_buf][row - 2 - ref_row] = Filtered_chunk[BUFFER_WIDTH_BYTES/BUFFER_WIDTH_CHUNKS];
 
-                        // Filtering Logic
-                        if(href_point == 0){
-                            // First pixel of the chunk at the left border
-                            Filtered_chunk[0] = 0;
-                        }
-                        else{
-                            if(WIDTH >128)
-                            Filtered_chunk[0] = inter_pixels[prev_buf][row - 2 - ref_row];
-                        }
+                    // Write the filtered chunk to output stream
+                    uint512_dt out_val;
+                    unsigned int write_row_offset = ((row - 1) * WIDTH + href_point) / AXI_WIDTH_BYTES;
 
-                        for (int col = 1; col < BUFFER_WIDTH_BYTES; col++) {
+                    for (int chunk = 0; chunk < BUFFER_WIDTH_CHUNKS; chunk++) {
+                    #pragma HLS PIPELINE II=1
+                        // Output packing
+                        for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
                         #pragma HLS UNROLL
-
-                            if (col == BUFFER_WIDTH_BYTES - 1){
-                                Filtered_chunk[col] = 0;
-                            }
-                            else {
-                                int16_t temp_filter = 5 * Prior_chunk_1[col]        // Center pixel
-                                                        - Current_chunk[col]        // Down pixel
-                                                        - Prior_chunk_2[col]        // Up pixel
-                                                        - Prior_chunk_1[col - 1]    // Left pixel
-                                                        - Prior_chunk_1[col + 1];   // Right pixel
-
-                                // Clamping the result to [0, 255]
-                                pixel_t filtered_pixel = (pixel_t) (temp_filter < 0) ? 0 : (temp_filter > 255 ? 255 : temp_filter);
-
-                                // Write back to output buffer
-                                Filtered_chunk[col] = filtered_pixel;
-                            }
+                            out_val.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = Filtered_chunk[chunk*AXI_WIDTH_BYTES + v];
                         }
 
-                        // Middle pixel of the chunk
-                        if(WIDTH > 128)
-                            inter_pixels[curr_buf][row - 2 - ref_row] = Filtered_chunk[BUFFER_WIDTH_BYTES/BUFFER_WIDTH_CHUNKS];
-
-                        // Write the filtered chunk to output stream
-                        uint512_dt out_val;
-                        unsigned int write_row_offset = ((row - 1) * WIDTH + href_point) / AXI_WIDTH_BYTES;
-
-                        for (int chunk = 0; chunk < BUFFER_WIDTH_CHUNKS; chunk++) {
-                        #pragma HLS PIPELINE II=1
-                            // Output packing
-                            for (int v = 0; v < AXI_WIDTH_BYTES; v++) {
-                            #pragma HLS UNROLL
-                                out_val.range(PIXEL_SIZE * (v + 1) - 1, v * PIXEL_SIZE) = Filtered_chunk[chunk*AXI_WIDTH_BYTES + v];
-                            }
-
-                            out[write_row_offset + chunk] = out_val;
-                        }
+                        out[write_row_offset + chunk] = out_val;
+#ifdef PERF_COUNTERS
+                        busy++;
+                        beats_written++;
+#endif
+#ifdef FRAME_STATS
+                        // Tiles overlap by one beat and the next tile rewrites the second one,
+                        // so only the beat that stays in out is counted
+                        if (chunk == 0 || h_step == h_steps - 1)
+                            stats_beat(su, out_val, row - 1, h_step + chunk);
+#endif
                     }
+                }
 
-                    // Refresh the Chunks
-                    for (int v = 0; v < BUFFER_WIDTH_BYTES; v++) {
-                    #pragma HLS UNROLL
-                        Prior_chunk_2[v] = Prior_chunk_1[v];
-                        Prior_chunk_1[v] = Current_chunk[v];
-                    }
+                // Refresh the Chunks
+                for (int v = 0; v < BUFFER_WIDTH_BYTES; v++) {
+                #pragma HLS UNROLL
+                    Prior_chunk_2[v] = Prior_chunk_1[v];
+                    Prior_chunk_1[v] = Current_chunk[v];
                 }
+                prior_zero_2 = prior_zero_1;
+                prior_zero_1 = current_zero;
             }
         }
+    }
 
-        // Make the first and last row zeros
-        for(int chunk=0; chunk < WIDTH/AXI_WIDTH_BYTES; chunk++){
-            out[chunk] = 0;
-            out[(HEIGHT-1)*(WIDTH/AXI_WIDTH_BYTES) + chunk] = 0;
-        }
+    // Make the first and last row zeros
+    for(int chunk=0; chunk < WIDTH/AXI_WIDTH_BYTES; chunk++){
+        out[chunk] = 0;
+        out[(HEIGHT-1)*(WIDTH/AXI_WIDTH_BYTES) + chunk] = 0;
+#ifdef PERF_COUNTERS
+        busy += 2;
+        beats_written += 2;
+#endif
     }
+
+#ifdef FRAME_STATS
+    stats_zero_beats(su, 2 * (WIDTH / AXI_WIDTH_BYTES));
+    stats_write(su, stats);
+#endif
+
+#ifdef PERF_COUNTERS
+    core_counts.write(read_stall);
+    core_counts.write(busy);
+    core_counts.write(beats_read);
+    core_counts.write(beats_written);
+#endif
+}
+
+
+#ifdef PERF_COUNTERS
+/* PERF COUNTER
+    - Input  : datapath counts, arriving once the core is done
+    - Output : perf[PERF_NUM_COUNTERS]
+    Counts every clock until the first count shows up on the stream. Whatever the core did not
+    spend busy or waiting on stream_G is a cycle its pipeline was frozen, mostly by m_axi write
+    back-pressure on out (plus loop fill/drain).
+*/
+void perf_counter(hls::stream<perf_t> &core_counts, perf_t *perf) {
+    perf_t cycles = 0;
+    perf_t read_stall;
+
+    FREE_RUN: while (!core_counts.read_nb(read_stall)) {
+    #pragma HLS PIPELINE II=1
+        cycles++;
+    }
+
+    perf_t busy = core_counts.read();
+    perf_t beats_read = core_counts.read();
+    perf_t beats_written = core_counts.read();
+
+    perf[PERF_TOTAL_CYCLES] = cycles;
+    perf[PERF_READ_STALL_CYCLES] = read_stall;
+    perf[PERF_WRITE_STALL_CYCLES] = (cycles > busy + read_stall) ? (perf_t)(cycles - busy - read_stall) : (perf_t)0;
+    perf[PERF_BEATS_READ] = beats_read;
+    perf[PERF_BEATS_WRITTEN] = beats_written;
 }
+#endif
 
 
 /* Compare Helper Function
@@ -0,0 +1,130 @@
+/*
+ * Wide elementwise map shared by the pointwise kernels
+ *
+ * The burst read -> unrolled lanes -> burst write skeleton of the vadd example with the
+ * per-lane operation left open: wide_map<Op, LANE_BITS> splits each 512-bit beat into
+ * 512 / LANE_BITS lanes and applies Op to every lane pair in the same cycle. Chunks of
+ * BUFFER_SIZE beats go through a DATAFLOW region, so reading chunk n + 1 overlaps the
+ * lanes and the write-back of chunk n. A new pointwise op only needs a functor:
+ *
+ *     struct MyOp {
+ *         template <int W> ap_uint<W> operator()(ap_uint<W> a, ap_uint<W> b) const { ... }
+ *     };
+ *     wide_map<MyOp, 8>(in_A, in_B, out, pixels);
+ *
+ * The ops below are the pointwise parts of IMAGE_DIFF_POSTERIZE and the vadd example.
+ */
+
+#ifndef WIDE_MAP_HPP
+#define WIDE_MAP_HPP
+
+#include <ap_int.h>
+
+#define WIDE_MAP_DATAWIDTH 512      // Data width of Memory Access in bits
+#define WIDE_MAP_BUFFER_SIZE 144    // 512-bit beats per DATAFLOW chunk
+
+#ifndef T1
+#define T1 32
+#endif
+#ifndef T2
+#define T2 96
+#endif
+
+typedef ap_uint<WIDE_MAP_DATAWIDTH> wide_beat_t;
+
+// Wrapping add (vadd)
+struct AddOp {
+    template <int W> ap_uint<W> operator()(ap_uint<W> a, ap_uint<W> b) const { return a + b; }
+};
+
+// |a - b|
+struct AbsDiffOp {
+    template <int W> ap_uint<W> operator()(ap_uint<W> a, ap_uint<W> b) const { return (a > b) ? (ap_uint<W>)(a - b) : (ap_uint<W>)(b - a); }
+};
+
+// Changed / unchanged mask: all ones where |a - b| >= T1
+struct ThresholdOp {
+    template <int W> ap_uint<W> operator()(ap_uint<W> a, ap_uint<W> b) const {
+        ap_uint<W> d = AbsDiffOp()(a, b);
+        return (d >= T1) ? (ap_uint<W>)-1 : (ap_uint<W>)0;
+    }
+};
+
+// Compare of IMAGE_DIFF_POSTERIZE: 0 / 128 / 255
+struct PosterizeOp {
+    template <int W> ap_uint<W> operator()(ap_uint<W> a, ap_uint<W> b) const {
+        ap_uint<W> d = AbsDiffOp()(a, b);
+        if (d < T1) return 0;
+        else if (d < T2) return 128;
+        else return 255;
+    }
+};
+
+/* WIDE MAP
+    - Input  : A_in, B_in, size elements of LANE_BITS bits (packed 512 / LANE_BITS per beat)
+    - Output : out[i] = Op(A_in[i], B_in[i]) for every element, whole beats written
+*/
+template <typename Op, int LANE_BITS>
+void wide_map(const wide_beat_t *A_in, const wide_beat_t *B_in, wide_beat_t *out, int size) {
+    const int LANES = WIDE_MAP_DATAWIDTH / LANE_BITS;
+    static_assert(WIDE_MAP_DATAWIDTH % LANE_BITS == 0, "lanes must tile the 512-bit beat");
+
+    const Op op = Op();
+
+    wide_beat_t A_local[WIDE_MAP_BUFFER_SIZE];    // Local memory to store A locally
+    wide_beat_t B_local[WIDE_MAP_BUFFER_SIZE];
+    wide_beat_t result_local[WIDE_MAP_BUFFER_SIZE]; // Local Memory to store result
+
+    // Number of 512-bit reads from global memory
+    int size_in_beats = (size - 1) / LANES + 1;
+
+    // Per iteration of this loop map BUFFER_SIZE beats
+    for (int i = 0; i < size_in_beats; i += WIDE_MAP_BUFFER_SIZE) {
+    #pragma HLS DATAFLOW
+    #pragma HLS stream variable = A_local depth = WIDE_MAP_BUFFER_SIZE
+    #pragma HLS stream variable = B_local depth = WIDE_MAP_BUFFER_SIZE
+
+        int chunk_size = WIDE_MAP_BUFFER_SIZE;
+
+        // boundary checks
+        if ((i + WIDE_MAP_BUFFER_SIZE) > size_in_beats)
+            chunk_size = size_in_beats - i;
+
+    // burst read both vectors from global memory to local memory
+    rd:
+        for (int j = 0; j < chunk_size; j++) {
+        #pragma HLS pipeline
+        #pragma HLS LOOP_TRIPCOUNT min = 1 max = 144
+            A_local[j] = A_in[i + j];
+            B_local[j] = B_in[i + j];
+        }
+
+    // apply the op on all lanes of a beat in parallel
+    map:
+        for (int j = 0; j < chunk_size; j++) {
+        #pragma HLS pipeline
+        #pragma HLS LOOP_TRIPCOUNT min = 1 max = 144
+            wide_beat_t tmpV1 = A_local[j];
+            wide_beat_t tmpV2 = B_local[j];
+            wide_beat_t tmpOut = 0;
+
+            for (int lane = 0; lane < LANES; lane++) {
+            #pragma HLS UNROLL
+                ap_uint<LANE_BITS> tmp1 = tmpV1.range(LANE_BITS * (lane + 1) - 1, lane * LANE_BITS);
+                ap_uint<LANE_BITS> tmp2 = tmpV2.range(LANE_BITS * (lane + 1) - 1, lane * LANE_BITS);
+                tmpOut.range(LANE_BITS * (lane + 1) - 1, lane * LANE_BITS) = op(tmp1, tmp2);
+            }
+            result_local[j] = tmpOut;
+        }
+
+    // burst write the result
+    store:
+        for (int j = 0; j < chunk_size; j++) {
+        #pragma HLS pipeline
+        #pragma HLS LOOP_TRIPCOUNT min = 1 max = 144
+            out[i + j] = result_local[j];
+        }
+    }
+}
+
+#endif
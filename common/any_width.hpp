@@ -0,0 +1,54 @@
+/**
+ * @file any_width.hpp
+ * @brief Host side of the any-width kernel (Third_Lab/any_width.cpp)
+ *
+ * IMAGE_DIFF_POSTERIZE_ANY_WIDTH takes the frame size at run time and streams the
+ * packed frame as whole 512-bit beats, so the width does not have to be a multiple
+ * of 64 pixels. Its last beat is read and written in full: frames handed to it are
+ * allocated in whole beats (any_width_frame_bytes) with the padding left at zero.
+ *
+ * Command line:
+ *     --any-width <W>x<H>     run the any-width kernel at this size (repeatable)
+ */
+
+#ifndef ANY_WIDTH_HPP
+#define ANY_WIDTH_HPP
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define ANY_WIDTH_BEAT_BYTES 64
+#define ANY_WIDTH_MIN_WIDTH  64       // must match MIN_WIDTH / MAX_WIDTH of the kernel
+#define ANY_WIDTH_MAX_WIDTH  4096
+
+/* Bytes of a width x height frame rounded up to whole beats */
+inline size_t any_width_frame_bytes(int width, int height) {
+    size_t pixels = (size_t)width * height;
+    return (pixels + ANY_WIDTH_BEAT_BYTES - 1) / ANY_WIDTH_BEAT_BYTES * ANY_WIDTH_BEAT_BYTES;
+}
+
+/* Takes --any-width out of args, sizes outside the kernel bounds are dropped */
+inline void parse_any_width_args(std::vector<std::string> &args, std::vector<std::pair<int, int>> &sizes) {
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--any-width" && i + 1 < args.size()) {
+            int w = 0, h = 0;
+            if (sscanf(args[++i].c_str(), "%dx%d", &w, &h) == 2 && w >= ANY_WIDTH_MIN_WIDTH &&
+                w <= ANY_WIDTH_MAX_WIDTH && h > 0) {
+                sizes.push_back({w, h});
+            } else {
+                std::cerr << "Ignoring --any-width " << args[i] << " (expected WxH, W in ["
+                          << ANY_WIDTH_MIN_WIDTH << ", " << ANY_WIDTH_MAX_WIDTH << "])" << std::endl;
+            }
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file benchmark.hpp
+ * @brief Repeated-run throughput measurement for the host executables
+ *
+ * A single frame mixes cold caches, first-touch page faults and driver warmup
+ * into the numbers. The benchmark mode runs a number of untimed warmup
+ * iterations first and then N timed ones, and reports per-iteration latency
+ * percentiles together with MPix/s and GB/s derived from the median.
+ *
+ * Command line (anywhere after the XCLBIN file):
+ *     --bench              enable the benchmark mode
+ *     --warmup <N>         untimed iterations before measuring (default 10)
+ *     --iters <N>          timed iterations (default 100)
+ *     --size <W>x<H>       frame size for the CPU reference run (repeatable,
+ *                          default is the compiled WIDTH x HEIGHT)
+ */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct BenchConfig {
+    bool enabled = false;
+    int warmup = 10;
+    int iterations = 100;
+    std::vector<std::pair<int, int>> sizes;   // {width, height}
+};
+
+/* Picks the benchmark options out of argv.
+    Returns the remaining (positional) arguments so the host can keep its usual checks.
+    An option missing its value returns no arguments at all, so the host prints its usage
+    instead of taking the next word (or nothing) as the XCLBIN path.
+*/
+inline std::vector<std::string> parse_bench_args(int argc, char **argv, BenchConfig &cfg) {
+    std::vector<std::string> positional;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--warmup" || arg == "--iters" || arg == "--size") && i + 1 >= argc) {
+            std::cerr << "Missing value after " << arg << std::endl;
+            return {};
+        }
+        if (arg == "--bench") {
+            cfg.enabled = true;
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            cfg.warmup = std::max(0, atoi(argv[++i]));
+        } else if (arg == "--iters" && i + 1 < argc) {
+            cfg.iterations = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--size" && i + 1 < argc) {
+            int w = 0, h = 0;
+            if (sscanf(argv[++i], "%dx%d", &w, &h) == 2 && w > 0 && h > 0) {
+                cfg.sizes.push_back({w, h});
+            } else {
+                std::cerr << "Ignoring malformed --size " << argv[i] << " (expected WxH)" << std::endl;
+            }
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    return positional;
+}
+
+/* Runs fn() warmup times untimed, then iterations times timed.
+    - Output : wall-clock seconds of every timed iteration
+*/
+template <typename Fn>
+std::vector<double> bench_run(Fn &&fn, int warmup, int iterations) {
+    for (int i = 0; i < warmup; i++) fn();
+
+    std::vector<double> seconds;
+    seconds.reserve(iterations);
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        seconds.push_back(std::chrono::duration<double>(end - start).count());
+    }
+    return seconds;
+}
+
+inline double bench_percentile(std::vector<double> v, int p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (v.size() * p + 99) / 100;
+    return v[rank == 0 ? 0 : rank - 1];
+}
+
+inline void bench_header() {
+    std::cout << std::left << std::setw(36) << "Benchmark"
+              << std::right << std::setw(8) << "iters"
+              << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms" << std::setw(12) << "min ms"
+              << std::setw(12) << "MPix/s" << std::setw(10) << "GB/s" << "\n";
+}
+
+/* One report line
+    - pixels : pixels produced per iteration (for MPix/s)
+    - bytes  : bytes moved per iteration (for GB/s), 0 to leave the column empty
+*/
+inline void bench_report(const std::string &name, const std::vector<double> &seconds,
+                         size_t pixels, size_t bytes) {
+    double p50 = bench_percentile(seconds, 50);
+    double p99 = bench_percentile(seconds, 99);
+    double min = seconds.empty() ? 0.0 : *std::min_element(seconds.begin(), seconds.end());
+
+    std::cout << std::left << std::setw(36) << name
+              << std::right << std::setw(8) << seconds.size()
+              << std::fixed << std::setprecision(3)
+              << std::setw(12) << p50 * 1e3 << std::setw(12) << p99 * 1e3 << std::setw(12) << min * 1e3
+              << std::setw(12) << std::setprecision(1) << (p50 > 0 ? pixels / p50 / 1e6 : 0.0);
+    if (bytes) {
+        std::cout << std::setw(10) << std::setprecision(2) << (p50 > 0 ? bytes / p50 / 1e9 : 0.0);
+    } else {
+        std::cout << std::setw(10) << "-";
+    }
+    std::cout << "\n";
+}
+
+// Converts device event durations (ns) into the seconds bench_report() expects
+inline std::vector<double> ns_to_seconds(const std::vector<uint64_t> &ns) {
+    std::vector<double> s;
+    s.reserve(ns.size());
+    for (uint64_t v : ns) s.push_back(v * 1e-9);
+    return s;
+}
+
+#endif
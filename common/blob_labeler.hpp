@@ -0,0 +1,288 @@
+/**
+ * @file blob_labeler.hpp
+ * @brief Streaming connected-component labeling of the posterized output
+ *
+ * Motion blobs are the connected groups of changed (nonzero) output pixels. The
+ * labeler sees the frame one row at a time, in the order the kernel writes it, and
+ * keeps only the previous row:
+ *
+ *   1. A row is cut into runs of foreground pixels. 64 pixels are classified at a
+ *      time with SSE2 into a bit mask, and the runs are read off the mask with
+ *      count-trailing-zeros, so empty and fully set stretches cost one test.
+ *   2. Every run that touches a run of the previous row joins its component
+ *      (union-find over run labels); a run touching nothing starts a new one.
+ *   3. A component with no run in the new row cannot grow any more: its bounding
+ *      box and area are final and it is emitted. The surviving components are
+ *      renumbered, so the label table never holds more than two rows of runs.
+ *
+ * Third_Lab/blob_label.cpp is the same algorithm with fixed-size tables, fed from
+ * the AXIS output of the posterize kernel.
+ *
+ * Command line:
+ *     --blobs                   label the device output and print the blobs
+ *     --blob-threshold <N>      foreground is value >= N (default 1, any change)
+ *     --blob-min-area <N>       drop blobs smaller than N pixels (default 1)
+ */
+
+#ifndef BLOB_LABELER_HPP
+#define BLOB_LABELER_HPP
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+struct MotionBlob {
+    int x0, y0;         // bounding box, inclusive
+    int x1, y1;
+    uint32_t area;      // foreground pixels
+};
+
+struct BlobConfig {
+    uint8_t threshold = 1;      // foreground is value >= threshold
+    int connectivity = 8;       // 4 or 8
+    uint32_t min_area = 1;
+};
+
+// Foreground pixels [start, end) of one row
+struct BlobRun {
+    int start, end;
+    uint32_t label;
+};
+
+/* Foreground mask of 64 pixels
+    - Input  : n <= 64 pixels
+    - Output : bit i set when line[i] >= threshold
+*/
+inline uint64_t blob_mask64(const uint8_t *line, int n, uint8_t threshold) {
+    uint64_t mask = 0;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i t = _mm_set1_epi8((char)threshold);
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(line + i));
+        // x >= t  <=>  max(x, t) == x  (unsigned)
+        uint32_t bits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(x, t), x));
+        mask |= (uint64_t)bits << i;
+    }
+#endif
+    for (; i < n; i++) {
+        if (line[i] >= threshold) mask |= 1ull << i;
+    }
+    return mask;
+}
+
+/* Runs of one row
+    - Input  : width pixels
+    - Output : runs in increasing column order (previous contents replaced)
+*/
+inline void blob_row_runs(const uint8_t *line, int width, uint8_t threshold, std::vector<BlobRun> &runs) {
+    runs.clear();
+    bool in_run = false;
+    int start = 0;
+    for (int base = 0; base < width; base += 64) {
+        const int n = std::min(64, width - base);
+        const uint64_t mask = blob_mask64(line + base, n, threshold);
+        const uint64_t full = (n == 64) ? ~0ull : ((1ull << n) - 1);
+
+        // Nothing starts or ends inside this block
+        if ((!in_run && mask == 0) || (in_run && mask == full)) continue;
+
+        int pos = 0;
+        while (pos < n) {
+            if (!in_run) {
+                uint64_t rest = mask >> pos;
+                if (rest == 0) break;
+                pos += __builtin_ctzll(rest);
+                start = base + pos;
+                in_run = true;
+            } else {
+                uint64_t rest = (~mask & full) >> pos;
+                if (rest == 0) break;
+                pos += __builtin_ctzll(rest);
+                runs.push_back({start, base + pos, 0});
+                in_run = false;
+            }
+        }
+    }
+    if (in_run) runs.push_back({start, width, 0});
+}
+
+class BlobLabeler {
+public:
+    explicit BlobLabeler(int width, const BlobConfig &cfg = BlobConfig())
+        : width_(width), cfg_(cfg) {}
+
+    /* Next output row, rows must come in order starting at 0 */
+    void push_row(const uint8_t *line) {
+        blob_row_runs(line, width_, cfg_.threshold, cur_);
+        link_row();
+        close_row();
+        row_++;
+    }
+
+    /* Ends the frame
+        - Output : every blob of at least min_area pixels, ordered by top row then left column
+    */
+    std::vector<MotionBlob> finish() {
+        for (const BlobRun &r : prev_) emit(find(r.label));
+        prev_.clear();
+        parent_.clear();
+        acc_.clear();
+        last_row_.clear();
+        row_ = 0;
+
+        std::vector<MotionBlob> out;
+        out.swap(done_);
+        std::sort(out.begin(), out.end(), [](const MotionBlob &a, const MotionBlob &b) {
+            return (a.y0 != b.y0) ? a.y0 < b.y0 : a.x0 < b.x0;
+        });
+        return out;
+    }
+
+private:
+    static const int EMITTED = -2;
+
+    uint32_t find(uint32_t l) {
+        while (parent_[l] != l) {
+            parent_[l] = parent_[parent_[l]];   // path halving
+            l = parent_[l];
+        }
+        return l;
+    }
+
+    // The smaller label stays root so the result does not depend on merge order
+    uint32_t unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return a;
+        if (b < a) std::swap(a, b);
+        parent_[b] = a;
+        MotionBlob &ra = acc_[a];
+        const MotionBlob &rb = acc_[b];
+        ra.x0 = std::min(ra.x0, rb.x0);
+        ra.y0 = std::min(ra.y0, rb.y0);
+        ra.x1 = std::max(ra.x1, rb.x1);
+        ra.y1 = std::max(ra.y1, rb.y1);
+        ra.area += rb.area;
+        last_row_[a] = std::max(last_row_[a], last_row_[b]);
+        return a;
+    }
+
+    // Join every run of the new row with the runs above it
+    void link_row() {
+        const int d = (cfg_.connectivity == 8) ? 1 : 0;     // diagonal neighbours count
+        size_t i = 0;
+        for (BlobRun &r : cur_) {
+            while (i < prev_.size() && prev_[i].end + d <= r.start) i++;
+
+            uint32_t label = UINT32_MAX;
+            for (size_t k = i; k < prev_.size() && prev_[k].start < r.end + d; k++) {
+                label = (label == UINT32_MAX) ? find(prev_[k].label) : unite(label, prev_[k].label);
+            }
+            if (label == UINT32_MAX) {
+                label = (uint32_t)parent_.size();
+                parent_.push_back(label);
+                acc_.push_back({r.start, row_, r.end - 1, row_, 0});
+                last_row_.push_back(row_);
+            }
+
+            MotionBlob &b = acc_[label];
+            b.x0 = std::min(b.x0, r.start);
+            b.x1 = std::max(b.x1, r.end - 1);
+            b.y1 = row_;
+            b.area += (uint32_t)(r.end - r.start);
+            last_row_[label] = row_;
+            r.label = label;
+        }
+    }
+
+    // Emit what the new row did not reach, renumber the rest
+    void close_row() {
+        for (const BlobRun &r : prev_) {
+            uint32_t root = find(r.label);
+            if (last_row_[root] != row_) emit(root);
+        }
+
+        remap_.assign(parent_.size(), UINT32_MAX);
+        next_acc_.clear();
+        for (BlobRun &r : cur_) {
+            uint32_t root = find(r.label);
+            if (remap_[root] == UINT32_MAX) {
+                remap_[root] = (uint32_t)next_acc_.size();
+                next_acc_.push_back(acc_[root]);
+            }
+            r.label = remap_[root];
+        }
+        acc_.swap(next_acc_);
+        parent_.resize(acc_.size());
+        for (uint32_t l = 0; l < parent_.size(); l++) parent_[l] = l;
+        last_row_.assign(acc_.size(), row_);
+        prev_.swap(cur_);
+    }
+
+    void emit(uint32_t root) {
+        if (last_row_[root] == EMITTED) return;
+        last_row_[root] = EMITTED;
+        if (acc_[root].area >= cfg_.min_area) done_.push_back(acc_[root]);
+    }
+
+    int width_;
+    BlobConfig cfg_;
+    int row_ = 0;
+    std::vector<BlobRun> prev_, cur_;
+    std::vector<uint32_t> parent_;      // union-find over the labels of prev_ and cur_
+    std::vector<MotionBlob> acc_;       // per label, valid at the roots
+    std::vector<int> last_row_;         // last row with a run, EMITTED once reported
+    std::vector<MotionBlob> done_;
+    std::vector<uint32_t> remap_;       // renumbering scratch, kept to avoid per-row allocation
+    std::vector<MotionBlob> next_acc_;
+};
+
+/* Blobs of a whole frame
+    - Input  : width x height output pixels
+    - Output : blobs ordered by top row then left column
+*/
+inline std::vector<MotionBlob> blob_extract(const uint8_t *frame, int width, int height, const BlobConfig &cfg = BlobConfig()) {
+    BlobLabeler labeler(width, cfg);
+    for (int row = 0; row < height; row++) {
+        labeler.push_row(frame + (size_t)row * width);
+    }
+    return labeler.finish();
+}
+
+inline void blob_print(const std::vector<MotionBlob> &blobs, size_t max_report = 10) {
+    std::cout << "Blobs: " << blobs.size() << "\n";
+    for (size_t i = 0; i < blobs.size() && i < max_report; i++) {
+        const MotionBlob &b = blobs[i];
+        std::cout << "  (" << b.x0 << "," << b.y0 << ")-(" << b.x1 << "," << b.y1 << ") area " << b.area << "\n";
+    }
+    if (blobs.size() > max_report) {
+        std::cout << "  ... " << blobs.size() - max_report << " more\n";
+    }
+}
+
+/* Takes the blob options out of args, enabled is set by --blobs */
+inline void parse_blob_args(std::vector<std::string> &args, BlobConfig &cfg, bool &enabled) {
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--blobs") {
+            enabled = true;
+        } else if (args[i] == "--blob-threshold" && i + 1 < args.size()) {
+            cfg.threshold = (uint8_t)std::max(1, std::min(255, atoi(args[++i].c_str())));
+        } else if (args[i] == "--blob-min-area" && i + 1 < args.size()) {
+            cfg.min_area = (uint32_t)std::max(1, atoi(args[++i].c_str()));
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+#endif
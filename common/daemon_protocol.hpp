@@ -0,0 +1,233 @@
+/**
+ * @file daemon_protocol.hpp
+ * @brief Wire protocol and client side of the posterize daemon (Third_Lab/posterize_daemon.cpp)
+ *
+ * The daemon programs the device once and keeps kernels and buffers allocated.
+ * A client connects to its Unix socket and sends a DaemonHello with the frame size.
+ * The daemon answers with a DaemonHelloReply and, as SCM_RIGHTS ancillary data, the fd
+ * of a shared memory region laid out as
+ *
+ *     [ frame A | frame B | output ]      each frame_stride bytes (page aligned)
+ *
+ * After that every DaemonRequest on the socket means "A and B are in place, fill the
+ * output" and is answered by a DaemonReply once the output is written. Pixels never
+ * go through the socket, a frame costs two small messages.
+ */
+
+#ifndef DAEMON_PROTOCOL_HPP
+#define DAEMON_PROTOCOL_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <iostream>
+#include <string>
+
+#define DAEMON_SOCKET_PATH  "/tmp/posterize_daemon.sock"
+#define DAEMON_MAGIC        0x50535444u   // "PSTD"
+#define DAEMON_VERSION      1
+#define DAEMON_PAGE         4096
+
+enum DaemonStatus : int32_t {
+    DAEMON_OK = 0,
+    DAEMON_BAD_REQUEST = 1,     // wrong magic / version
+    DAEMON_BAD_SIZE = 2,        // frame size differs from the one the kernel was built for
+    DAEMON_NO_MEMORY = 3,
+    DAEMON_DEVICE_ERROR = 4
+};
+
+struct DaemonHello {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width, height;
+};
+
+struct DaemonHelloReply {
+    int32_t status;
+    int32_t width, height;
+    uint64_t frame_stride;       // bytes between A, B and output inside the shared region
+};
+
+struct DaemonRequest {
+    uint32_t magic;
+    uint32_t seq;
+};
+
+struct DaemonReply {
+    uint32_t seq;
+    int32_t status;
+    uint64_t service_ns;         // time the daemon spent on the frame
+};
+
+inline uint64_t daemon_frame_stride(int width, int height) {
+    uint64_t bytes = (uint64_t)width * height;
+    return (bytes + DAEMON_PAGE - 1) / DAEMON_PAGE * DAEMON_PAGE;
+}
+
+// Full-length send / recv on a stream socket, false on error or peer close
+inline bool daemon_send(int fd, const void *buf, size_t len) {
+    const char *p = (const char *)buf;
+    while (len > 0) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+inline bool daemon_recv(int fd, void *buf, size_t len) {
+    char *p = (char *)buf;
+    while (len > 0) {
+        ssize_t n = ::recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Sends len bytes of buf with fd attached (fd < 0 sends no descriptor)
+inline bool daemon_send_fd(int sock, const void *buf, size_t len, int fd) {
+    struct iovec iov;
+    iov.iov_base = const_cast<void *>(buf);
+    iov.iov_len = len;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(sizeof(int))];
+    if (fd >= 0) {
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    return ::sendmsg(sock, &msg, MSG_NOSIGNAL) == (ssize_t)len;
+}
+
+// Receives len bytes into buf, *fd gets the attached descriptor or -1
+inline bool daemon_recv_fd(int sock, void *buf, size_t len, int *fd) {
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = len;
+
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    *fd = -1;
+    if (::recvmsg(sock, &msg, MSG_WAITALL) != (ssize_t)len) return false;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    return true;
+}
+
+/* Client end of one daemon connection
+    Frames are written straight into frame_A() / frame_B() (shared with the daemon),
+    process() blocks until output() holds the result.
+*/
+class PosterizeClient {
+public:
+    PosterizeClient() {}
+    ~PosterizeClient() { close(); }
+    PosterizeClient(const PosterizeClient &) = delete;
+    PosterizeClient &operator=(const PosterizeClient &) = delete;
+
+    bool connect(int width, int height, const std::string &path = DAEMON_SOCKET_PATH) {
+        close();
+        sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (sock < 0) return fail("socket");
+
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        if (::connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) return fail("connect to " + path);
+
+        DaemonHello hello = {DAEMON_MAGIC, DAEMON_VERSION, width, height};
+        DaemonHelloReply reply;
+        int shm_fd = -1;
+        if (!daemon_send(sock, &hello, sizeof(hello)) || !daemon_recv_fd(sock, &reply, sizeof(reply), &shm_fd)) {
+            return fail("handshake");
+        }
+        if (reply.status != DAEMON_OK || shm_fd < 0) {
+            std::cerr << "Daemon refused the connection (status " << reply.status << ", serves "
+                      << reply.width << "x" << reply.height << ")" << std::endl;
+            if (shm_fd >= 0) ::close(shm_fd);
+            close();
+            return false;
+        }
+
+        stride = reply.frame_stride;
+        frame_w = width;
+        frame_h = height;
+        shm_bytes = 3 * stride;
+        void *p = ::mmap(nullptr, shm_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+        ::close(shm_fd);
+        if (p == MAP_FAILED) return fail("mmap shared frames");
+        shm = (uint8_t *)p;
+        return true;
+    }
+
+    uint8_t *frame_A() { return shm; }
+    uint8_t *frame_B() { return shm + stride; }
+    const uint8_t *output() const { return shm + 2 * stride; }
+
+    /* Runs one frame
+        - Output : DAEMON_OK with output() filled; service_ns (optional) gets the daemon side time
+    */
+    int process(uint64_t *service_ns = nullptr) {
+        if (sock < 0) return DAEMON_BAD_REQUEST;
+        DaemonRequest req = {DAEMON_MAGIC, ++seq};
+        DaemonReply reply;
+        if (!daemon_send(sock, &req, sizeof(req)) || !daemon_recv(sock, &reply, sizeof(reply))) {
+            fail("request");
+            return DAEMON_DEVICE_ERROR;
+        }
+        if (service_ns) *service_ns = reply.service_ns;
+        return reply.status;
+    }
+
+    void close() {
+        if (shm) ::munmap(shm, shm_bytes);
+        if (sock >= 0) ::close(sock);
+        shm = nullptr;
+        sock = -1;
+    }
+
+private:
+    bool fail(const std::string &what) {
+        std::cerr << "PosterizeClient: " << what << " failed: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    int sock = -1;
+    uint8_t *shm = nullptr;
+    size_t shm_bytes = 0;
+    uint64_t stride = 0;
+    int frame_w = 0, frame_h = 0;
+    uint32_t seq = 0;
+};
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file descriptor_ring.hpp
+ * @brief Work descriptors of the persistent kernel (Third_Lab/persistent.cpp)
+ *
+ * The persistent kernel is launched once and then takes its frames from a ring of
+ * descriptors in device memory. Descriptor n goes into slot n % slots and becomes
+ * valid when its seq field is n + 1. The kernel reports progress in a completion
+ * word: the number of descriptors it has finished. A slot (and the frames its
+ * descriptor points to) can be reused once completion >= n + 1.
+ *
+ * Descriptors are 32 bytes and 32-byte aligned. Nothing guarantees that a host write
+ * reaches device memory as one beat, so a descriptor is published in two writes: the
+ * payload words (src_a .. t2) first, then seq once the payload write has completed.
+ * The kernel only reads the payload after it has seen the new seq.
+ */
+
+#ifndef DESCRIPTOR_RING_HPP
+#define DESCRIPTOR_RING_HPP
+
+#include <stdint.h>
+
+#define DESC_BEAT_BYTES 64      // frame offsets are in 512-bit beats
+
+// Layout must match the DESC_* words of Third_Lab/persistent.cpp
+struct FrameDescriptor {
+    uint32_t seq;           // n + 1
+    uint32_t src_a;         // beat offset into pool_A
+    uint32_t src_b;         // beat offset into pool_B
+    uint32_t dst;           // beat offset into pool_out
+    uint32_t width;         // 0 stops the kernel
+    uint32_t height;
+    uint32_t t1;
+    uint32_t t2;
+};
+static_assert(sizeof(FrameDescriptor) == 32, "descriptor must be 8 words");
+
+/* Descriptor of frame n, frames at byte offsets a, b, out of their pools (beat aligned) */
+inline FrameDescriptor frame_descriptor(uint32_t n, size_t a, size_t b, size_t out,
+                                        int width, int height, int t1, int t2) {
+    FrameDescriptor d;
+    d.seq = n + 1;
+    d.src_a = (uint32_t)(a / DESC_BEAT_BYTES);
+    d.src_b = (uint32_t)(b / DESC_BEAT_BYTES);
+    d.dst = (uint32_t)(out / DESC_BEAT_BYTES);
+    d.width = (uint32_t)width;
+    d.height = (uint32_t)height;
+    d.t1 = (uint32_t)t1;
+    d.t2 = (uint32_t)t2;
+    return d;
+}
+
+/* Descriptor n that ends the kernel loop */
+inline FrameDescriptor stop_descriptor(uint32_t n) {
+    return frame_descriptor(n, 0, 0, 0, 0, 0, 0, 0);
+}
+
+#endif
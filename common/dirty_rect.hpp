@@ -0,0 +1,135 @@
+/**
+ * @file dirty_rect.hpp
+ * @brief Incremental recompute of IMAGE_DIFF_POSTERIZE for a list of changed rectangles
+ *
+ * A pixel of A only reaches the output through G at the same position, and G only
+ * reaches the output through the 5-point stencil. A change inside a rectangle can
+ * therefore only move the output inside that rectangle grown by one pixel (the
+ * stencil halo), clipped to the interior because the border stays zero. Recomputing
+ * just that region and patching the previous output gives the same frame as a full
+ * run, at a cost proportional to the changed area.
+ *
+ * The CPU path patches pixel exact regions. The kernel (Third_Lab/dirty_rect.cpp)
+ * works on whole 512-bit beats, so its launch arguments are the region widened to
+ * beat boundaries.
+ *
+ * Command line:
+ *     --dirty <x>,<y>,<w>,<h>     rectangle of A that changed (repeatable)
+ */
+
+#ifndef DIRTY_RECT_HPP
+#define DIRTY_RECT_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "posterize_sw.hpp"
+
+struct DirtyRect {
+    int x, y, w, h;
+};
+
+/* Output region a change inside r can reach
+    - Output : false when nothing inside the interior is affected
+*/
+inline bool dirty_output_region(const DirtyRect &r, int width, int height, DirtyRect &region) {
+    int x0 = std::max(1, r.x - 1);
+    int y0 = std::max(1, r.y - 1);
+    int x1 = std::min(width - 1, r.x + r.w + 1);     // exclusive
+    int y1 = std::min(height - 1, r.y + r.h + 1);
+    if (x0 >= x1 || y0 >= y1) return false;
+    region = {x0, y0, x1 - x0, y1 - y0};
+    return true;
+}
+
+/* Computes one output region from scratch
+    - Input  : A and B, region o inside the frame border (as dirty_output_region returns)
+    - Output : the pixels of o in out, nothing else is touched
+*/
+inline void posterize_region_sw(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out,
+                                int width, const DirtyRect &o, std::vector<uint8_t> &lines,
+                                uint8_t t1 = T1, uint8_t t2 = T2) {
+    // G over the region plus its halo, kept as a 3 row rolling buffer like the full frame path
+    const int gx = o.x - 1;
+    const int gw = o.w + 2;
+    lines.resize(3 * (size_t)gw);
+    uint8_t *g[3] = {&lines[0], &lines[gw], &lines[2 * (size_t)gw]};
+
+    size_t first = (size_t)(o.y - 1) * width + gx;
+    posterize_row_sw(in_A + first, in_B + first, g[0], gw, t1, t2);
+    posterize_row_sw(in_A + first + width, in_B + first + width, g[1], gw, t1, t2);
+
+    for (int row = o.y; row < o.y + o.h; row++) {
+        size_t next = (size_t)(row + 1) * width + gx;
+        posterize_row_sw(in_A + next, in_B + next, g[2], gw, t1, t2);
+
+        uint8_t *dst = out + (size_t)row * width + gx;
+        for (int col = 1; col < gw - 1; col++) {
+            int16_t temp = 5 * g[1][col] - g[0][col] - g[2][col] - g[1][col - 1] - g[1][col + 1];
+            dst[col] = (temp < 0) ? 0 : ((temp > 255) ? 255 : temp);
+        }
+
+        uint8_t *oldest = g[0];
+        g[0] = g[1];
+        g[1] = g[2];
+        g[2] = oldest;
+    }
+}
+
+/* Recomputes only the output regions of the dirty rectangles
+    - Input  : current A and B, output of the previous frame in out
+    - Output : out patched in place, equal to a full IMAGE_DIFF_POSTERIZE_SW of A and B
+*/
+inline void IMAGE_DIFF_POSTERIZE_SW_RECTS(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out,
+                                          int width, int height, const std::vector<DirtyRect> &rects,
+                                          uint8_t t1 = T1, uint8_t t2 = T2) {
+    std::vector<uint8_t> lines;
+
+    for (const DirtyRect &r : rects) {
+        DirtyRect o;
+        if (dirty_output_region(r, width, height, o)) {
+            posterize_region_sw(in_A, in_B, out, width, o, lines, t1, t2);
+        }
+    }
+}
+
+// Launch arguments of IMAGE_DIFF_POSTERIZE_RECT: output rows and 512-bit beat columns, end exclusive
+struct RectLaunch {
+    int row_start, row_end;
+    int chunk_start, chunk_end;
+};
+
+inline bool dirty_rect_launch(const DirtyRect &r, int width, int height, RectLaunch &launch, int lanes = 64) {
+    DirtyRect o;
+    if (!dirty_output_region(r, width, height, o)) return false;
+    launch.row_start = o.y;
+    launch.row_end = o.y + o.h;
+    launch.chunk_start = o.x / lanes;
+    launch.chunk_end = (o.x + o.w + lanes - 1) / lanes;
+    return true;
+}
+
+// Picks every --dirty x,y,w,h out of args, consumed entries are removed
+inline void parse_dirty_args(std::vector<std::string> &args, std::vector<DirtyRect> &rects) {
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--dirty" && i + 1 < args.size()) {
+            DirtyRect r;
+            if (sscanf(args[++i].c_str(), "%d,%d,%d,%d", &r.x, &r.y, &r.w, &r.h) == 4 &&
+                r.x >= 0 && r.y >= 0 && r.w > 0 && r.h > 0) {
+                rects.push_back(r);
+            } else {
+                std::cerr << "Ignoring malformed --dirty " << args[i] << " (expected x,y,w,h)" << std::endl;
+            }
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * @file event_profiler.hpp
+ * @brief Device-side timing of OpenCL commands from event profiling counters
+ *
+ * EventTimer measures how long the host spends inside an enqueue call, which for
+ * enqueueTask is only the time it takes to hand the command to the runtime.
+ * EventProfiler keeps the cl::Event of every migrate / kernel command instead and
+ * reads the CL_PROFILING_COMMAND_QUEUED/SUBMIT/START/END timestamps once the queue
+ * has drained, so each stage reports when it really ran on the device.
+ *
+ * Samples are aggregated per stage over any number of iterations and reported as
+ * p50/p90/p99 plus a log2 histogram of the execution time. The queue must be
+ * created with CL_QUEUE_PROFILING_ENABLE (all hosts in this repo already do).
+ */
+
+#ifndef EVENT_PROFILER_HPP
+#define EVENT_PROFILER_HPP
+
+#include "xcl2.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define PROFILER_HIST_BINS 24   // log2 buckets in us: [0,1), [1,2), [2,4) ... [2^22, inf)
+
+class EventProfiler {
+public:
+    // One command as seen by the device, all values in nanoseconds
+    struct Sample {
+        uint64_t queued_to_submit;  // waiting in the host queue
+        uint64_t submit_to_start;   // waiting on the device (dependencies, scheduler)
+        uint64_t start_to_end;      // actual execution of the command
+        uint64_t queued_to_end;     // everything the caller observes
+    };
+
+    // Returns the event the next command of <stage> should signal. Pass it straight
+    // to the enqueue call, the pointer is only valid until the next event().
+    cl::Event *event(const std::string &stage) {
+        pending.push_back(Pending{stage_index(stage), cl::Event()});
+        return &pending.back().ev;
+    }
+
+    // Reads the timestamps of all pending events. Call after q.finish().
+    void collect() {
+        for (auto &p : pending) {
+            cl_int err;
+            cl_ulong queued, submit, start, end;
+            OCL_CHECK(err, queued = p.ev.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>(&err));
+            OCL_CHECK(err, submit = p.ev.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>(&err));
+            OCL_CHECK(err, start  = p.ev.getProfilingInfo<CL_PROFILING_COMMAND_START>(&err));
+            OCL_CHECK(err, end    = p.ev.getProfilingInfo<CL_PROFILING_COMMAND_END>(&err));
+
+            Sample s;
+            s.queued_to_submit = submit - queued;
+            s.submit_to_start  = start - submit;
+            s.start_to_end     = end - start;
+            s.queued_to_end    = end - queued;
+            stages[p.stage].samples.push_back(s);
+        }
+        pending.clear();
+    }
+
+    // Sorted start_to_end times (ns) of one stage, empty if the stage is unknown
+    std::vector<uint64_t> exec_times(const std::string &stage) const {
+        for (const Stage &st : stages)
+            if (st.name == stage) return field(st, &Sample::start_to_end);
+        return {};
+    }
+
+    void clear() {
+        pending.clear();
+        stages.clear();
+    }
+
+    void print() const {
+        std::cout << std::left << std::setw(32) << "Stage (device time, us)"
+                  << std::right << std::setw(8) << "count"
+                  << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99"
+                  << std::setw(14) << "p50 q->end" << "\n";
+        for (const auto &st : stages) {
+            std::vector<uint64_t> exec = field(st, &Sample::start_to_end);
+            std::vector<uint64_t> total = field(st, &Sample::queued_to_end);
+            std::cout << std::left << std::setw(32) << st.name
+                      << std::right << std::setw(8) << exec.size()
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(12) << percentile(exec, 50) / 1000.0
+                      << std::setw(12) << percentile(exec, 90) / 1000.0
+                      << std::setw(12) << percentile(exec, 99) / 1000.0
+                      << std::setw(14) << percentile(total, 50) / 1000.0 << "\n";
+        }
+    }
+
+    bool export_json(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Unable to open " << path << " for writing." << std::endl;
+            return false;
+        }
+
+        out << "{\n  \"unit\": \"ns\",\n  \"stages\": [\n";
+        for (size_t i = 0; i < stages.size(); i++) {
+            const Stage &st = stages[i];
+            out << "    {\n      \"name\": \"" << st.name << "\",\n"
+                << "      \"count\": " << st.samples.size() << ",\n";
+            write_field(out, "queued_to_submit", field(st, &Sample::queued_to_submit));
+            write_field(out, "submit_to_start",  field(st, &Sample::submit_to_start));
+            write_field(out, "start_to_end",     field(st, &Sample::start_to_end));
+            write_field(out, "queued_to_end",    field(st, &Sample::queued_to_end));
+
+            // Execution time histogram, bucket b holds [2^(b-1), 2^b) us
+            uint64_t hist[PROFILER_HIST_BINS] = {0};
+            for (const Sample &s : st.samples) hist[hist_bin(s.start_to_end)]++;
+            out << "      \"start_to_end_log2_us_hist\": [";
+            for (int b = 0; b < PROFILER_HIST_BINS; b++) out << (b ? ", " : "") << hist[b];
+            out << "]\n    }" << (i + 1 < stages.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return true;
+    }
+
+private:
+    struct Stage {
+        std::string name;
+        std::vector<Sample> samples;
+    };
+    struct Pending {
+        size_t stage;
+        cl::Event ev;
+    };
+
+    std::vector<Stage> stages;      // kept in first-use order so reports follow the pipeline
+    std::vector<Pending> pending;   // commands enqueued since the last collect()
+
+    size_t stage_index(const std::string &name) {
+        for (size_t i = 0; i < stages.size(); i++)
+            if (stages[i].name == name) return i;
+        stages.push_back(Stage{name, {}});
+        return stages.size() - 1;
+    }
+
+    static std::vector<uint64_t> field(const Stage &st, uint64_t Sample::*member) {
+        std::vector<uint64_t> v;
+        v.reserve(st.samples.size());
+        for (const Sample &s : st.samples) v.push_back(s.*member);
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+
+    // Nearest-rank percentile on an already sorted vector
+    static uint64_t percentile(const std::vector<uint64_t> &sorted, int p) {
+        if (sorted.empty()) return 0;
+        size_t rank = (sorted.size() * p + 99) / 100;
+        return sorted[rank == 0 ? 0 : rank - 1];
+    }
+
+    static int hist_bin(uint64_t ns) {
+        uint64_t us = ns / 1000;
+        int b = 0;
+        while (us && b < PROFILER_HIST_BINS - 1) { us >>= 1; b++; }
+        return b;
+    }
+
+    static void write_field(std::ofstream &out, const char *name, const std::vector<uint64_t> &sorted) {
+        uint64_t sum = 0;
+        for (uint64_t v : sorted) sum += v;
+        out << "      \"" << name << "\": {"
+            << "\"min\": " << (sorted.empty() ? 0 : sorted.front())
+            << ", \"p50\": " << percentile(sorted, 50)
+            << ", \"p90\": " << percentile(sorted, 90)
+            << ", \"p99\": " << percentile(sorted, 99)
+            << ", \"max\": " << (sorted.empty() ? 0 : sorted.back())
+            << ", \"mean\": " << (sorted.empty() ? 0 : sum / sorted.size()) << "},\n";
+    }
+};
+
+#endif
@@ -0,0 +1,378 @@
+/**
+ * @file frame_io.hpp
+ * @brief Memory-mapped PGM / PPM / raw frame reader and large-write frame writer
+ *
+ * Lets the hosts replay captured footage instead of generated data.
+ *
+ * Reading maps the whole file and hands out pointers into the mapping. The mapping is
+ * private and writable: XRT pins CL_MEM_USE_HOST_PTR memory for DMA with write access,
+ * which fails on read-only pages, and copy-on-write keeps the file itself untouched.
+ * A frame is returned without any copy when it is 8-bit grey and starts on a
+ * FRAME_IO_ALIGN boundary, which is what CL_MEM_USE_HOST_PTR wants. That holds for
+ *   - raw sequences whose frame size is a multiple of the page size, and
+ *   - PGM files written by FrameWriter, which pads the header with a comment so
+ *     the pixels start exactly at FRAME_IO_ALIGN.
+ * Anything else (foreign PGMs, 16-bit PGMs, PPM colour) is converted once into one
+ * of two aligned scratch frames owned by the reader, so an A/B pair taken from the
+ * same sequence stays valid together.
+ *
+ * Writing uses one write() per frame straight from the caller's buffer, so there
+ * is no stdio buffering copy and the kernel sees large sequential writes.
+ */
+
+#ifndef FRAME_IO_HPP
+#define FRAME_IO_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define FRAME_IO_ALIGN 4096   // page size, also the alignment XRT wants for host pointers
+
+enum FrameFormat {
+    FRAME_RAW,      // headerless 8-bit grey frames back to back
+    FRAME_PGM,      // P5, maxval 255 or 65535
+    FRAME_PPM       // P6, maxval 255 (converted to luma)
+};
+
+class FrameReader {
+public:
+    FrameReader() {}
+    ~FrameReader() { close(); }
+    FrameReader(const FrameReader &) = delete;
+    FrameReader &operator=(const FrameReader &) = delete;
+
+    /* Opens a PGM or PPM file, the geometry comes from the header.
+        Returns false (and prints why) on failure.
+    */
+    bool open_image(const std::string &path) {
+        if (!map(path)) return false;
+
+        // Netpbm header: magic, width, height, maxval, each separated by whitespace / comments
+        size_t pos = 2;
+        if (size < 2 || base[0] != 'P' || (base[1] != '5' && base[1] != '6')) {
+            return fail(path, "not a binary PGM (P5) or PPM (P6) file");
+        }
+        format = (base[1] == '5') ? FRAME_PGM : FRAME_PPM;
+
+        long fields[3];
+        for (int f = 0; f < 3; f++) {
+            if (!next_header_int(pos, fields[f])) return fail(path, "truncated header");
+        }
+        pos++;  // exactly one whitespace byte ends the header
+
+        frame_w = (int)fields[0];
+        frame_h = (int)fields[1];
+        maxval = (int)fields[2];
+        channels = (format == FRAME_PPM) ? 3 : 1;
+        sample_bytes = (maxval > 255) ? 2 : 1;
+        data_offset = pos;
+        frame_stride = (size_t)frame_w * frame_h * channels * sample_bytes;
+        frame_step = data_offset + frame_stride;
+        frames = 1;
+
+        if (frame_w <= 0 || frame_h <= 0 || maxval <= 0 || maxval > 65535) return fail(path, "bad header values");
+        if (format == FRAME_PPM && maxval > 255) return fail(path, "16-bit PPM is not supported");
+        if (data_offset + frame_stride > size) return fail(path, "file shorter than its header says");
+
+        // Multi-image file (e.g. written by FrameWriter): count the images with an identical header
+        while ((size_t)(frames + 1) * frame_step <= size &&
+               memcmp(base + (size_t)frames * frame_step, base, data_offset) == 0) {
+            frames++;
+        }
+        return true;
+    }
+
+    /* Opens a headerless sequence of width x height 8-bit frames.
+        A trailing partial frame is ignored.
+    */
+    bool open_raw(const std::string &path, int width, int height) {
+        if (!map(path)) return false;
+        format = FRAME_RAW;
+        frame_w = width;
+        frame_h = height;
+        maxval = 255;
+        channels = 1;
+        sample_bytes = 1;
+        data_offset = 0;
+        frame_stride = (size_t)width * height;
+        frame_step = frame_stride;
+        frames = frame_stride ? (int)(size / frame_stride) : 0;
+        if (frames == 0) return fail(path, "smaller than one frame");
+        return true;
+    }
+
+    // Picks open_image() or open_raw() by extension (.pgm/.ppm, anything else is raw)
+    bool open(const std::string &path, int raw_width, int raw_height) {
+        std::string ext = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+        if (ext == ".pgm" || ext == ".ppm" || ext == ".pnm") return open_image(path);
+        return open_raw(path, raw_width, raw_height);
+    }
+
+    int width() const { return frame_w; }
+    int height() const { return frame_h; }
+    int count() const { return frames; }
+
+    // True when frame(i) is a pointer into the mapping, no copy involved
+    bool zero_copy(int i) const {
+        const uint8_t *p = base + data_offset + (size_t)i * frame_step;
+        return channels == 1 && sample_bytes == 1 && ((uintptr_t)p % FRAME_IO_ALIGN) == 0;
+    }
+
+    /* Frame i as 8-bit grey, FRAME_IO_ALIGN aligned
+        A converted frame stays valid for one more converting frame() call, or until close().
+    */
+    uint8_t *frame(int i) {
+        if (i < 0 || i >= frames) return nullptr;
+        uint8_t *src = base + data_offset + (size_t)i * frame_step;
+
+        // Ask the kernel to start paging in the next frame while this one is used
+        if (i + 1 < frames) {
+            uintptr_t next = (uintptr_t)(src + frame_step) & ~(uintptr_t)(FRAME_IO_ALIGN - 1);
+            madvise((void *)next, frame_stride, MADV_WILLNEED);
+        }
+
+        if (zero_copy(i)) return src;
+
+        const size_t pixels = (size_t)frame_w * frame_h;
+        uint8_t *&dst = scratch[next_scratch];
+        next_scratch ^= 1;
+        if (!dst) {
+            if (posix_memalign((void **)&dst, FRAME_IO_ALIGN, pixels ? pixels : 1) != 0) {
+                dst = nullptr;
+                return nullptr;
+            }
+        }
+
+        if (channels == 1 && sample_bytes == 1) {
+            memcpy(dst, src, pixels);
+        } else if (channels == 1) {
+            // 16-bit big-endian PGM, keep the top 8 bits of the scaled sample
+            for (size_t p = 0; p < pixels; p++) {
+                unsigned v = (src[2 * p] << 8) | src[2 * p + 1];
+                dst[p] = (uint8_t)((v * 255u + maxval / 2) / maxval);
+            }
+        } else {
+            // PPM colour to luma, BT.601 integer weights (77, 150, 29) / 256
+            for (size_t p = 0; p < pixels; p++) {
+                const uint8_t *rgb = src + 3 * p;
+                unsigned y = (77u * rgb[0] + 150u * rgb[1] + 29u * rgb[2] + 128u) >> 8;
+                if (maxval != 255) y = (y * 255u + maxval / 2) / maxval;
+                dst[p] = (uint8_t)(y > 255 ? 255 : y);
+            }
+        }
+        return dst;
+    }
+
+    void close() {
+        if (base) munmap((void *)base, size);
+        base = nullptr;
+        size = 0;
+        free(scratch[0]);
+        free(scratch[1]);
+        scratch[0] = scratch[1] = nullptr;
+        frames = 0;
+    }
+
+private:
+    uint8_t *base = nullptr;
+    size_t size = 0;
+    uint8_t *scratch[2] = {nullptr, nullptr};
+    int next_scratch = 0;
+    FrameFormat format = FRAME_RAW;
+    int frame_w = 0, frame_h = 0, maxval = 255;
+    int channels = 1, sample_bytes = 1;
+    size_t data_offset = 0;     // header bytes before the pixels of each image
+    size_t frame_stride = 0;    // pixel bytes of one frame
+    size_t frame_step = 0;      // distance between two frames in the file
+    int frames = 0;
+
+    bool map(const std::string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: cannot open " << path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            std::cerr << "Error: " << path << " is empty or unreadable" << std::endl;
+            return false;
+        }
+        size = (size_t)st.st_size;
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            std::cerr << "Error: mmap of " << path << " failed: " << strerror(errno) << std::endl;
+            size = 0;
+            return false;
+        }
+        base = (uint8_t *)p;
+        madvise(p, size, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    bool fail(const std::string &path, const char *why) {
+        std::cerr << "Error: " << path << ": " << why << std::endl;
+        close();
+        return false;
+    }
+
+    // Skips whitespace and '#' comments, then parses one decimal number
+    bool next_header_int(size_t &pos, long &value) {
+        while (pos < size) {
+            if (base[pos] == '#') {
+                while (pos < size && base[pos] != '\n') pos++;
+            } else if (base[pos] == ' ' || base[pos] == '\t' || base[pos] == '\n' || base[pos] == '\r') {
+                pos++;
+            } else {
+                break;
+            }
+        }
+        if (pos >= size || base[pos] < '0' || base[pos] > '9') return false;
+        value = 0;
+        while (pos < size && base[pos] >= '0' && base[pos] <= '9') {
+            value = value * 10 + (base[pos] - '0');
+            if (value > (1L << 30)) return false;
+            pos++;
+        }
+        return true;
+    }
+};
+
+class FrameWriter {
+public:
+    FrameWriter() {}
+    ~FrameWriter() { close(); }
+    FrameWriter(const FrameWriter &) = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+
+    /* Creates (truncates) <path>.
+        FRAME_PGM writes a P5 header padded to FRAME_IO_ALIGN so FrameReader can map the
+        pixels zero-copy later; frames written after the first form a multi-image PGM.
+        FRAME_RAW writes the frames back to back.
+    */
+    bool open(const std::string &path, FrameFormat fmt, int width, int height) {
+        close();
+        if (fmt == FRAME_PPM) {
+            std::cerr << "Error: FrameWriter only writes grey frames (PGM or raw)" << std::endl;
+            return false;
+        }
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Error: cannot create " << path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        format = fmt;
+        frame_w = width;
+        frame_h = height;
+        return true;
+    }
+
+    // Writes one frame of width*height bytes, one write() for the pixels
+    bool write_frame(const uint8_t *pixels) {
+        if (fd < 0) return false;
+        if (format == FRAME_PGM) {
+            char header[FRAME_IO_ALIGN];
+            size_t len = pgm_header(header, frame_w, frame_h);
+            if (!write_all(header, len)) return false;
+        }
+        return write_all(pixels, (size_t)frame_w * frame_h);
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+private:
+    int fd = -1;
+    FrameFormat format = FRAME_RAW;
+    int frame_w = 0, frame_h = 0;
+
+    /* P5 header whose length is exactly FRAME_IO_ALIGN
+        "P5\n# pad...\n<w> <h>\n255\n", the comment absorbs the remaining bytes.
+    */
+    static size_t pgm_header(char *out, int width, int height) {
+        char dims[64];
+        int dims_len = snprintf(dims, sizeof(dims), "%d %d\n255\n", width, height);
+        const int magic_len = 3;                       // "P5\n"
+        int pad = FRAME_IO_ALIGN - magic_len - dims_len - 2;  // "#" ... "\n"
+        memcpy(out, "P5\n#", 4);
+        memset(out + 4, ' ', pad);
+        out[4 + pad] = '\n';
+        memcpy(out + 5 + pad, dims, dims_len);
+        return FRAME_IO_ALIGN;
+    }
+
+    bool write_all(const void *buf, size_t len) {
+        const uint8_t *p = (const uint8_t *)buf;
+        while (len > 0) {
+            ssize_t n = ::write(fd, p, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: write failed: " << strerror(errno) << std::endl;
+                return false;
+            }
+            p += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+};
+
+struct FrameIOConfig {
+    std::string input_a;        // PGM/PPM/raw file for A (raw uses the compiled frame size)
+    std::string input_b;
+    int index_a = 0;            // frame index inside the file
+    int index_b = 0;
+    std::string output;         // .pgm or raw file for the device result
+};
+
+/* Picks --input-a <file[:index]>, --input-b <file[:index]> and --output <file> out of args
+    Consumed entries are removed, everything else is left for the caller.
+*/
+inline void parse_frame_io_args(std::vector<std::string> &args, FrameIOConfig &cfg) {
+    auto split_index = [](const std::string &spec, std::string &path, int &index) {
+        size_t colon = spec.rfind(':');
+        if (colon != std::string::npos && colon + 1 < spec.size() &&
+            spec.find_first_not_of("0123456789", colon + 1) == std::string::npos) {
+            path = spec.substr(0, colon);
+            index = atoi(spec.c_str() + colon + 1);
+        } else {
+            path = spec;
+            index = 0;
+        }
+    };
+
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--input-a" && i + 1 < args.size()) {
+            split_index(args[++i], cfg.input_a, cfg.index_a);
+        } else if (args[i] == "--input-b" && i + 1 < args.size()) {
+            split_index(args[++i], cfg.input_b, cfg.index_b);
+        } else if (args[i] == "--output" && i + 1 < args.size()) {
+            cfg.output = args[++i];
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+// Output format from the extension, .pgm gets a padded header, anything else is raw
+inline FrameFormat frame_format_for(const std::string &path) {
+    return (path.size() >= 4 && path.substr(path.size() - 4) == ".pgm") ? FRAME_PGM : FRAME_RAW;
+}
+
+#endif
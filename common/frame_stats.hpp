@@ -0,0 +1,95 @@
+/**
+ * @file frame_stats.hpp
+ * @brief Per-frame activity statistics of the filtered output
+ *
+ * Histogram of the output values, number of nonzero (changed) pixels and the
+ * bounding box of the nonzero pixels, in the word layout the stats kernels write
+ * (Third_Lab/axis_chain.cpp, and v_limit.cpp / code_plus.cpp built with -DFRAME_STATS).
+ * The CPU version is the reference for those kernels; IMAGE_DIFF_POSTERIZE_SW can
+ * collect the same numbers row by row while it filters.
+ */
+
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+
+// Word offsets, must match the kernels
+#ifndef STATS_WORDS
+#define STATS_HIST      0       // 256 bins
+#define STATS_NONZERO   256
+#define STATS_MIN_ROW   257     // bounding box of nonzero pixels, all 0xFFFFFFFF when none
+#define STATS_MAX_ROW   258
+#define STATS_MIN_COL   259
+#define STATS_MAX_COL   260
+#define STATS_WORDS     261
+#endif
+
+#define STATS_NONE 0xFFFFFFFFu
+
+// Starts an empty frame: zero histogram, no bounding box
+inline void frame_stats_begin(uint32_t stats[STATS_WORDS]) {
+    memset(stats, 0, STATS_WORDS * sizeof(uint32_t));
+    stats[STATS_MIN_ROW] = stats[STATS_MAX_ROW] = STATS_NONE;
+    stats[STATS_MIN_COL] = stats[STATS_MAX_COL] = STATS_NONE;
+}
+
+/* Adds one output row, called while the row is still in cache
+    - Input  : width output pixels of row
+    - Output : stats updated (rows must arrive in increasing order)
+*/
+inline void frame_stats_row(uint32_t stats[STATS_WORDS], const uint8_t *line, int row, int width) {
+    int first = -1, last = -1;
+    for (int col = 0; col < width; col++) {
+        stats[STATS_HIST + line[col]]++;
+        if (line[col]) {
+            if (first < 0) first = col;
+            last = col;
+        }
+    }
+    if (first < 0) return;
+
+    if (stats[STATS_MIN_ROW] == STATS_NONE) {
+        stats[STATS_MIN_ROW] = row;
+        stats[STATS_MIN_COL] = first;
+        stats[STATS_MAX_COL] = last;
+    }
+    stats[STATS_MAX_ROW] = row;
+    if ((uint32_t)first < stats[STATS_MIN_COL]) stats[STATS_MIN_COL] = first;
+    if ((uint32_t)last > stats[STATS_MAX_COL]) stats[STATS_MAX_COL] = last;
+}
+
+inline void frame_stats_end(uint32_t stats[STATS_WORDS]) {
+    uint32_t nonzero = 0;
+    for (int b = 1; b < 256; b++) nonzero += stats[STATS_HIST + b];
+    stats[STATS_NONZERO] = nonzero;
+}
+
+/* Statistics of a filtered frame
+    - Input  : width x height output pixels
+    - Output : stats[STATS_WORDS]
+*/
+inline void frame_stats_sw(const uint8_t *out, int width, int height, uint32_t stats[STATS_WORDS]) {
+    frame_stats_begin(stats);
+    for (int row = 0; row < height; row++) {
+        frame_stats_row(stats, out + (size_t)row * width, row, width);
+    }
+    frame_stats_end(stats);
+}
+
+inline void frame_stats_print(const uint32_t stats[STATS_WORDS]) {
+    std::cout << "Changed pixels: " << stats[STATS_NONZERO];
+    if (stats[STATS_NONZERO]) {
+        std::cout << ", bounding box rows " << stats[STATS_MIN_ROW] << ".." << stats[STATS_MAX_ROW]
+                  << ", cols " << stats[STATS_MIN_COL] << ".." << stats[STATS_MAX_COL];
+    }
+    std::cout << "\nHistogram (nonzero bins):";
+    for (int b = 1; b < 256; b++) {
+        if (stats[STATS_HIST + b]) std::cout << " " << b << ":" << stats[STATS_HIST + b];
+    }
+    std::cout << std::endl;
+}
+
+#endif
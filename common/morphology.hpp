@@ -0,0 +1,108 @@
+/**
+ * @file morphology.hpp
+ * @brief 3x3 erode/dilate speckle cleanup of the posterized output, CPU reference
+ *
+ * Open (erode then dilate) removes isolated changed pixels, close (dilate then erode)
+ * fills single-pixel holes inside blobs. Both use the full 3x3 square; neighbours
+ * outside the frame are ignored, so the frame edge neither grows nor eats a blob.
+ * The square is separable: a horizontal min/max over 3 pixels followed by a vertical
+ * one over 3 rows gives the same result as the 9-pixel window.
+ *
+ * Third_Lab/morph_fused.cpp runs the same two stages inside the posterize pipeline,
+ * on line buffers after the stencil, so the cleaned frame comes out of a single pass.
+ *
+ * Command line:
+ *     --morph open|close        also run the fused kernel and check it against this code
+ */
+
+#ifndef MORPHOLOGY_HPP
+#define MORPHOLOGY_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "posterize_sw.hpp"
+
+// Kernel "mode" argument, must match Third_Lab/morph_fused.cpp
+#define MORPH_MODE_NONE     0
+#define MORPH_MODE_OPEN     1
+#define MORPH_MODE_CLOSE    2
+
+/* One 3x3 erode (min) or dilate (max) pass
+    - Input  : width x height pixels
+    - Output : width x height pixels, must not alias in
+*/
+inline void morph3x3_sw(const uint8_t *in, uint8_t *out, int width, int height, bool dilate) {
+    auto op = [dilate](uint8_t a, uint8_t b) { return dilate ? std::max(a, b) : std::min(a, b); };
+
+    // Horizontal pass into a rolling window of three rows
+    std::vector<uint8_t> rows(3 * (size_t)width);
+    auto horizontal = [&](int row) {
+        const uint8_t *src = in + (size_t)row * width;
+        uint8_t *dst = rows.data() + (size_t)(row % 3) * width;
+        if (width == 1) {
+            dst[0] = src[0];
+            return;
+        }
+        dst[0] = op(src[0], src[1]);
+        for (int col = 1; col < width - 1; col++) {
+            dst[col] = op(op(src[col - 1], src[col]), src[col + 1]);
+        }
+        dst[width - 1] = op(src[width - 2], src[width - 1]);
+    };
+
+    horizontal(0);
+    for (int row = 0; row < height; row++) {
+        if (row + 1 < height) horizontal(row + 1);
+        const uint8_t *mid = rows.data() + (size_t)(row % 3) * width;
+        const uint8_t *up = (row > 0) ? rows.data() + (size_t)((row - 1) % 3) * width : mid;
+        const uint8_t *down = (row + 1 < height) ? rows.data() + (size_t)((row + 1) % 3) * width : mid;
+        uint8_t *dst = out + (size_t)row * width;
+        for (int col = 0; col < width; col++) {
+            dst[col] = op(op(up[col], mid[col]), down[col]);
+        }
+    }
+}
+
+/* Open or close
+    - Input  : width x height pixels, MORPH_MODE_*
+    - Output : cleaned pixels (may alias in)
+*/
+inline void morph_sw(const uint8_t *in, uint8_t *out, int width, int height, int mode) {
+    if (mode == MORPH_MODE_NONE) {
+        if (out != in) std::copy(in, in + (size_t)width * height, out);
+        return;
+    }
+    std::vector<uint8_t> tmp((size_t)width * height);
+    const bool open = (mode == MORPH_MODE_OPEN);
+    morph3x3_sw(in, tmp.data(), width, height, !open);
+    morph3x3_sw(tmp.data(), out, width, height, open);
+}
+
+/* Reference for the fused kernel: posterize, then open or close */
+inline void IMAGE_DIFF_POSTERIZE_MORPH_SW(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out,
+                                          int width, int height, int mode) {
+    IMAGE_DIFF_POSTERIZE_SW(in_A, in_B, out, width, height);
+    morph_sw(out, out, width, height, mode);
+}
+
+/* Takes --morph out of args, mode stays MORPH_MODE_NONE without it */
+inline void parse_morph_args(std::vector<std::string> &args, int &mode) {
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--morph" && i + 1 < args.size()) {
+            const std::string &m = args[++i];
+            if (m == "open") mode = MORPH_MODE_OPEN;
+            else if (m == "close") mode = MORPH_MODE_CLOSE;
+            else std::cerr << "Ignoring unknown --morph " << m << " (expected open or close)" << std::endl;
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file pack.hpp
+ * @brief Packing of 8-bit pixels into 32/64/512-bit words and 2D window gather
+ *
+ * All labs use the same layout: pixel i of a row-major frame sits in bits
+ * [8*(i%L)+7 : 8*(i%L)] of word i/L, L = pixels per word (the kernels' range() calls).
+ * On a little-endian host that is exactly the byte order of the pixel array, so
+ * packing and unpacking are plain memcpy (which libc already runs with the widest
+ * vector moves) and a 2D sub-window is one memcpy per row. Big-endian hosts get a
+ * byte swap per word instead of the per-byte shift/OR loops.
+ *
+ * The last word is zero padded when the pixel count is not a multiple of L.
+ */
+
+#ifndef PACK_HPP
+#define PACK_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// 512-bit word as the host sees an ap_uint<512> beat: 64 pixels, pixel 0 in the lowest byte
+struct alignas(64) word512_t {
+    uint8_t bytes[64];
+};
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define PACK_BIG_ENDIAN 1
+#endif
+
+template <typename Word>
+inline size_t pack_word_count(size_t pixels) {
+    return (pixels + sizeof(Word) - 1) / sizeof(Word);
+}
+
+#ifdef PACK_BIG_ENDIAN
+inline uint32_t pack_bswap(uint32_t w) { return __builtin_bswap32(w); }
+inline uint64_t pack_bswap(uint64_t w) { return __builtin_bswap64(w); }
+inline word512_t pack_bswap(word512_t w) { return w; }   // byte array, already in pixel order
+#endif
+
+/* Pack pixels into words
+    - Input  : count pixels
+    - Output : pack_word_count<Word>(count) words, tail zero padded
+*/
+template <typename Word>
+inline void pack_words(const uint8_t *pixels, size_t count, Word *words) {
+    const size_t n = pack_word_count<Word>(count);
+    memcpy(words, pixels, count);
+    memset((uint8_t *)words + count, 0, n * sizeof(Word) - count);
+#ifdef PACK_BIG_ENDIAN
+    for (size_t w = 0; w < n; w++) words[w] = pack_bswap(words[w]);
+#endif
+}
+
+/* Unpack words into pixels
+    - Input  : words holding at least count pixels
+    - Output : count pixels (padding of the last word dropped)
+*/
+template <typename Word>
+inline void unpack_words(const Word *words, size_t count, uint8_t *pixels) {
+#ifdef PACK_BIG_ENDIAN
+    for (size_t p = 0; p < count; p += sizeof(Word)) {
+        Word w = pack_bswap(words[p / sizeof(Word)]);
+        memcpy(pixels + p, &w, (count - p < sizeof(Word)) ? count - p : sizeof(Word));
+    }
+#else
+    memcpy(pixels, words, count);
+#endif
+}
+
+/* Gather a 2D sub-window out of a packed frame
+    - Input  : words of a frame width pixels wide, window origin (x, y) and size w x h
+    - Output : w x h pixels at dst, dst_stride bytes between rows (0 = w)
+*/
+template <typename Word>
+inline void gather_window(const Word *words, int width, int x, int y, int w, int h,
+                          uint8_t *dst, int dst_stride = 0) {
+    if (dst_stride == 0) dst_stride = w;
+#ifdef PACK_BIG_ENDIAN
+    for (int row = 0; row < h; row++) {
+        size_t first = (size_t)(y + row) * width + x;
+        for (int col = 0; col < w; col++) {
+            size_t i = first + col;
+            Word word = pack_bswap(words[i / sizeof(Word)]);
+            dst[(size_t)row * dst_stride + col] = ((const uint8_t *)&word)[i % sizeof(Word)];
+        }
+    }
+#else
+    const uint8_t *src = (const uint8_t *)words;
+    for (int row = 0; row < h; row++) {
+        memcpy(dst + (size_t)row * dst_stride, src + (size_t)(y + row) * width + x, w);
+    }
+#endif
+}
+
+/* Scatter a w x h window back into a packed frame (inverse of gather_window) */
+template <typename Word>
+inline void scatter_window(Word *words, int width, int x, int y, int w, int h,
+                           const uint8_t *src, int src_stride = 0) {
+    if (src_stride == 0) src_stride = w;
+#ifdef PACK_BIG_ENDIAN
+    for (int row = 0; row < h; row++) {
+        size_t first = (size_t)(y + row) * width + x;
+        for (int col = 0; col < w; col++) {
+            size_t i = first + col;
+            Word word = pack_bswap(words[i / sizeof(Word)]);
+            ((uint8_t *)&word)[i % sizeof(Word)] = src[(size_t)row * src_stride + col];
+            words[i / sizeof(Word)] = pack_bswap(word);
+        }
+    }
+#else
+    uint8_t *dst = (uint8_t *)words;
+    for (int row = 0; row < h; row++) {
+        memcpy(dst + (size_t)(y + row) * width + x, src + (size_t)row * src_stride, w);
+    }
+#endif
+}
+
+#endif
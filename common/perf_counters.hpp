@@ -0,0 +1,114 @@
+/**
+ * @file perf_counters.hpp
+ * @brief Host side of the in-kernel performance counters (-DPERF_COUNTERS)
+ *
+ * The Third_Lab kernel built with PERF_COUNTERS writes five 64-bit counters at
+ * the end of every run: total cycles, cycles the filter stage waited on
+ * stream_G (i.e. on the m_axi reads of in_A/in_B), cycles the pipeline was
+ * frozen by write back-pressure on out, and the 512-bit beats read and written.
+ *
+ * In software emulation the kernel is plain C, the free-running counter sees no
+ * clock and stream_G is always full, so those registers carry no timing. The
+ * model below walks the same loop nest as v_limit.cpp with a simple m_axi
+ * latency model, so the host can print the same breakdown in emulation.
+ */
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+
+// Indices must match the kernel (Third_Lab/v_limit.cpp)
+#ifndef PERF_NUM_COUNTERS
+#define PERF_TOTAL_CYCLES       0
+#define PERF_READ_STALL_CYCLES  1
+#define PERF_WRITE_STALL_CYCLES 2
+#define PERF_BEATS_READ         3
+#define PERF_BEATS_WRITTEN      4
+#define PERF_NUM_COUNTERS       5
+#endif
+
+struct PerfModelConfig {
+    int lanes = 64;               // pixels per 512-bit beat
+    int window_chunks = 2;        // BUFFER_WIDTH_CHUNKS, beats per row burst
+    int v_limit = 256;            // V_LIMIT, rows per vertical step
+    int read_latency = 64;        // cycles from AR to first R beat
+    int write_latency = 32;       // cycles from AW/W to B response
+    int outstanding = 16;         // bursts in flight per m_axi port
+    int pipeline_depth = 8;       // fill/drain of each pipelined loop
+};
+
+/* Cycle model of v_limit.cpp
+    Every row of the window is its own burst (rows are WIDTH apart in memory), so a
+    burst of window_chunks beats needs at least read_latency/outstanding cycles to be
+    re-issued. Anything above the beats themselves is a stall.
+*/
+inline void perf_model(int width, int height, uint64_t perf[PERF_NUM_COUNTERS],
+                       const PerfModelConfig &cfg = PerfModelConfig()) {
+    const int window_bytes = cfg.window_chunks * cfg.lanes;
+    const int h_steps = (width - window_bytes) / cfg.lanes + 1;
+    const int v_steps = (height + cfg.v_limit - 1) / cfg.v_limit;
+    const uint64_t read_issue = (cfg.read_latency + cfg.outstanding - 1) / cfg.outstanding;
+    const uint64_t write_issue = (cfg.write_latency + cfg.outstanding - 1) / cfg.outstanding;
+    const uint64_t beats = cfg.window_chunks;
+
+    uint64_t busy = 0, read_stall = 0, write_stall = 0;
+    uint64_t beats_read = 0, beats_written = 0;
+
+    for (int v_step = 0; v_step < v_steps; v_step++) {
+        int ref_row = (v_step == 0) ? 0 : v_step * cfg.v_limit - 2;
+        int last_row = (v_step + 1) * cfg.v_limit;
+        if (last_row > height) last_row = height;
+        if (v_steps == 1) { ref_row = 0; last_row = height; }
+        const uint64_t rows = last_row - ref_row;
+
+        for (int h_step = 0; h_step < h_steps; h_step++) {
+            beats_read += 2 * rows * beats;
+            busy += rows * beats;                                   // F reads of stream_G
+            read_stall += rows * (read_issue > beats ? read_issue - beats : 0) + cfg.read_latency;
+
+            beats_written += (rows - 2) * beats;
+            busy += (rows - 2) * beats;
+            write_stall += (rows - 2) * (write_issue > beats ? write_issue - beats : 0) + 2 * cfg.pipeline_depth;
+        }
+    }
+
+    // First and last row cleared with single beat writes
+    const uint64_t border = 2 * (uint64_t)(width / cfg.lanes);
+    beats_written += border;
+    busy += border;
+    write_stall += border * (write_issue > 1 ? write_issue - 1 : 0);
+
+    perf[PERF_TOTAL_CYCLES] = busy + read_stall + write_stall;
+    perf[PERF_READ_STALL_CYCLES] = read_stall;
+    perf[PERF_WRITE_STALL_CYCLES] = write_stall;
+    perf[PERF_BEATS_READ] = beats_read;
+    perf[PERF_BEATS_WRITTEN] = beats_written;
+}
+
+inline void perf_print(const uint64_t perf[PERF_NUM_COUNTERS], double clock_mhz, bool modeled) {
+    const uint64_t total = perf[PERF_TOTAL_CYCLES];
+    const uint64_t read_stall = perf[PERF_READ_STALL_CYCLES];
+    const uint64_t write_stall = perf[PERF_WRITE_STALL_CYCLES];
+    const uint64_t busy = (total > read_stall + write_stall) ? total - read_stall - write_stall : 0;
+    auto pct = [total](uint64_t v) { return total ? 100.0 * v / total : 0.0; };
+
+    std::cout << "Kernel counters" << (modeled ? " (C-sim model)" : "") << ":\n"
+              << std::fixed << std::setprecision(1)
+              << "  Total cycles            " << std::setw(12) << total
+              << "  (" << std::setprecision(3) << total / clock_mhz << " us @ "
+              << std::setprecision(0) << clock_mhz << " MHz)\n" << std::setprecision(1)
+              << "  Busy                    " << std::setw(12) << busy << "  " << pct(busy) << "%\n"
+              << "  Read stall (stream_G)   " << std::setw(12) << read_stall << "  " << pct(read_stall) << "%\n"
+              << "  Write back-pressure     " << std::setw(12) << write_stall << "  " << pct(write_stall) << "%\n"
+              << "  Beats read / written    " << std::setw(12) << perf[PERF_BEATS_READ]
+              << " / " << perf[PERF_BEATS_WRITTEN] << "\n";
+
+    const char *bound = "compute";
+    if (read_stall + write_stall > busy) bound = (read_stall >= write_stall) ? "memory (reads)" : "memory (writes)";
+    std::cout << "  Bound by                " << std::setw(12) << bound << "\n";
+}
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file posterize_accelerator.hpp
+ * @brief Embeddable, asynchronous front end of the IMAGE_DIFF_POSTERIZE kernel
+ *
+ * Owns one command queue and a fixed ring of "slots". Every slot has its own aligned
+ * host frames, cl::Buffers created on them once, and its own cl::Kernel with the
+ * arguments already set, so a frame costs two memcpy in, one memcpy out and three
+ * enqueues - no buffer or kernel objects are created per call.
+ *
+ *     auto accel = PosterizeAccelerator::from_xclbin("krnl.xclbin", 256, 512, 4);
+ *     std::future<bool> done = accel->submit(frame_A, frame_B, out);
+ *     ...
+ *     bool ok = done.get();      // out is filled once the future is ready
+ *
+ * submit() may be called from any number of threads. At most `depth` frames are in
+ * flight; a caller beyond that blocks until a slot frees up (back-pressure). The
+ * queue is out-of-order with event dependencies inside a frame, so the transfers of
+ * one slot overlap the kernel run of another.
+ */
+
+#ifndef POSTERIZE_ACCELERATOR_HPP
+#define POSTERIZE_ACCELERATOR_HPP
+
+#include "xcl2.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define ACCEL_DEFAULT_DEPTH 4
+
+class PosterizeAccelerator {
+public:
+    /* Shares an already programmed context
+        - size_arg : the kernel takes the pixel count as 4th argument (Second_Lab kernels)
+    */
+    PosterizeAccelerator(const cl::Context &context, const cl::Device &device, const cl::Program &program,
+                         int width, int height, int depth = ACCEL_DEFAULT_DEPTH, bool size_arg = false,
+                         const char *kernel_name = "IMAGE_DIFF_POSTERIZE")
+        : frame_bytes((size_t)width * height), slots(depth > 0 ? depth : 1) {
+        cl_int err;
+        queue = cl::CommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, &err);
+        if (!check(err, "create command queue")) return;
+
+        for (size_t s = 0; s < slots.size(); s++) {
+            Slot &slot = slots[s];
+            slot.in_A.resize(frame_bytes);
+            slot.in_B.resize(frame_bytes);
+            slot.out.resize(frame_bytes);
+
+            slot.buffer_in_A = cl::Buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, frame_bytes, slot.in_A.data(), &err);
+            if (!check(err, "create input buffer A")) return;
+            slot.buffer_in_B = cl::Buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, frame_bytes, slot.in_B.data(), &err);
+            if (!check(err, "create input buffer B")) return;
+            slot.buffer_out = cl::Buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, frame_bytes, slot.out.data(), &err);
+            if (!check(err, "create output buffer")) return;
+
+            slot.kernel = cl::Kernel(program, kernel_name, &err);
+            if (!check(err, "create kernel")) return;
+            if (!check(slot.kernel.setArg(0, slot.buffer_in_A), "set argument 0") ||
+                !check(slot.kernel.setArg(1, slot.buffer_in_B), "set argument 1") ||
+                !check(slot.kernel.setArg(2, slot.buffer_out), "set argument 2")) return;
+            if (size_arg && !check(slot.kernel.setArg(3, (unsigned int)frame_bytes), "set argument 3")) return;
+
+            free_slots.push_back((int)s);
+        }
+
+        valid = true;
+        completer = std::thread(&PosterizeAccelerator::complete_loop, this);
+    }
+
+    // Loads the xclbin on the first device that accepts it, nullptr on failure
+    static std::unique_ptr<PosterizeAccelerator> from_xclbin(const std::string &xclbin, int width, int height,
+                                                             int depth = ACCEL_DEFAULT_DEPTH, bool size_arg = false) {
+        cl_int err;
+        auto devices = xcl::get_xil_devices();
+        auto fileBuf = xcl::read_binary_file(xclbin);
+        cl::Program::Binaries bins{{fileBuf.data(), fileBuf.size()}};
+
+        for (auto &device : devices) {
+            cl::Context context(device, nullptr, nullptr, nullptr, &err);
+            if (err != CL_SUCCESS) continue;
+            cl::Program program(context, {device}, bins, nullptr, &err);
+            if (err != CL_SUCCESS) continue;
+
+            std::unique_ptr<PosterizeAccelerator> accel(
+                new PosterizeAccelerator(context, device, program, width, height, depth, size_arg));
+            if (accel->ok()) return accel;
+        }
+        std::cerr << "PosterizeAccelerator: no device accepted " << xclbin << std::endl;
+        return nullptr;
+    }
+
+    ~PosterizeAccelerator() {
+        if (!completer.joinable()) return;
+        drain();
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+        }
+        pending_cv.notify_all();
+        completer.join();
+    }
+
+    PosterizeAccelerator(const PosterizeAccelerator &) = delete;
+    PosterizeAccelerator &operator=(const PosterizeAccelerator &) = delete;
+
+    bool ok() const { return valid; }
+    int depth() const { return (int)slots.size(); }
+
+    /* Queues one frame pair
+        - Input  : frame_A, frame_B of width x height pixels, read before submit() returns
+        - Output : future set once out holds the result (false if the device reported an error)
+        Blocks while depth frames are already in flight.
+    */
+    std::future<bool> submit(const uint8_t *frame_A, const uint8_t *frame_B, uint8_t *out) {
+        if (!valid) {
+            std::promise<bool> failed;
+            failed.set_value(false);
+            return failed.get_future();
+        }
+
+        int s;
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            free_cv.wait(lk, [this] { return !free_slots.empty(); });
+            s = free_slots.front();
+            free_slots.pop_front();
+            in_flight++;
+        }
+
+        Slot &slot = slots[s];
+        memcpy(slot.in_A.data(), frame_A, frame_bytes);
+        memcpy(slot.in_B.data(), frame_B, frame_bytes);
+        slot.dest = out;
+        slot.result = std::promise<bool>();
+        std::future<bool> result = slot.result.get_future();
+
+        bool enqueued;
+        {
+            // cl::CommandQueue calls from several submitters are serialized here
+            std::lock_guard<std::mutex> lk(queue_mtx);
+            cl::Event migrated, computed;
+            std::vector<cl::Event> wait_migrate, wait_compute;
+
+            enqueued = check(queue.enqueueMigrateMemObjects({slot.buffer_in_A, slot.buffer_in_B}, 0, nullptr, &migrated), "migrate inputs");
+            wait_migrate.push_back(migrated);
+            enqueued = enqueued && check(queue.enqueueTask(slot.kernel, &wait_migrate, &computed), "launch kernel");
+            wait_compute.push_back(computed);
+            enqueued = enqueued && check(queue.enqueueMigrateMemObjects({slot.buffer_out}, CL_MIGRATE_MEM_OBJECT_HOST, &wait_compute, &slot.done), "migrate output");
+            queue.flush();
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            slot.failed = !enqueued;
+            pending.push_back(s);
+        }
+        pending_cv.notify_one();
+        return result;
+    }
+
+    // Waits until every submitted frame has completed
+    void drain() {
+        std::unique_lock<std::mutex> lk(mtx);
+        free_cv.wait(lk, [this] { return in_flight == 0; });
+    }
+
+private:
+    struct Slot {
+        std::vector<uint8_t, aligned_allocator<uint8_t>> in_A, in_B, out;
+        cl::Buffer buffer_in_A, buffer_in_B, buffer_out;
+        cl::Kernel kernel;
+        cl::Event done;
+        uint8_t *dest = nullptr;
+        bool failed = false;
+        std::promise<bool> result;
+    };
+
+    static bool check(cl_int err, const char *what) {
+        if (err == CL_SUCCESS) return true;
+        std::cerr << "PosterizeAccelerator: " << what << " failed (" << err << ")" << std::endl;
+        return false;
+    }
+
+    // Retires frames in submission order: wait, copy out, fulfil the future, recycle the slot
+    void complete_loop() {
+        for (;;) {
+            int s;
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                pending_cv.wait(lk, [this] { return stopping || !pending.empty(); });
+                if (pending.empty()) return;
+                s = pending.front();
+                pending.pop_front();
+            }
+
+            Slot &slot = slots[s];
+            bool success = !slot.failed && check(slot.done.wait(), "wait for frame");
+            if (success) memcpy(slot.dest, slot.out.data(), frame_bytes);
+            slot.result.set_value(success);
+
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                free_slots.push_back(s);
+                in_flight--;
+            }
+            free_cv.notify_all();
+        }
+    }
+
+    const size_t frame_bytes;
+    bool valid = false;
+    cl::CommandQueue queue;
+    std::vector<Slot> slots;
+
+    std::mutex mtx;                     // free_slots, pending, in_flight, stopping
+    std::mutex queue_mtx;
+    std::condition_variable free_cv;    // a slot was recycled
+    std::condition_variable pending_cv; // a frame was queued
+    std::deque<int> free_slots;
+    std::deque<int> pending;
+    int in_flight = 0;
+    bool stopping = false;
+    std::thread completer;
+};
+
+#endif
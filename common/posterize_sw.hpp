@@ -0,0 +1,148 @@
+/**
+ * @file posterize_sw.hpp
+ * @brief CPU reference of IMAGE_DIFF_POSTERIZE for any frame size
+ *
+ * Same math as the kernels: G = Compare(A, B) posterized to {0, 128, 255}, then
+ * the 5-point stencil 5*G - up - down - left - right clamped to [0, 255] with the
+ * one pixel border forced to zero. The frame size is a run-time argument so the
+ * host benchmarks can sweep sizes without recompiling.
+ *
+ * Fixed-camera footage has long stretches where A and B are byte-identical, and
+ * there G is zero. Each 64-byte cache line of A and B is compared with SSE2 first
+ * and only lines that differ go through Compare; an output row whose three input
+ * rows are all identical is written as zeros without running the stencil.
+ */
+
+#ifndef POSTERIZE_SW_HPP
+#define POSTERIZE_SW_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "frame_stats.hpp"
+
+#ifndef T1
+#define T1 32
+#endif
+#ifndef T2
+#define T2 96
+#endif
+
+inline uint8_t Compare(uint8_t A, uint8_t B, uint8_t t1 = T1, uint8_t t2 = T2) {
+    int16_t temp_d = (int16_t)A - (int16_t)B;
+    uint8_t D = (temp_d < 0) ? -temp_d : temp_d;
+
+    if (D < t1) return 0;
+    else if (D < t2) return 128;
+    else return 255;
+}
+
+// True when the 64 bytes at a and b are equal
+inline bool lines_equal_sw(const uint8_t *a, const uint8_t *b) {
+#if defined(__SSE2__)
+    __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b));
+    for (int i = 16; i < 64; i += 16) {
+        eq = _mm_and_si128(eq, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                                              _mm_loadu_si128((const __m128i *)(b + i))));
+    }
+    return _mm_movemask_epi8(eq) == 0xFFFF;
+#else
+    return memcmp(a, b, 64) == 0;
+#endif
+}
+
+/* Posterize one row
+    - Input  : WIDTH pixels of A and B
+    - Output : WIDTH compared pixels (G), true when the A and B rows are identical
+*/
+inline bool posterize_row_sw(const uint8_t *a, const uint8_t *b, uint8_t *g, int width,
+                             uint8_t t1 = T1, uint8_t t2 = T2) {
+    bool identical = true;
+    int col = 0;
+    for (; col + 64 <= width; col += 64) {
+        if (lines_equal_sw(a + col, b + col)) {
+            memset(g + col, 0, 64);
+            continue;
+        }
+        identical = false;
+        for (int i = col; i < col + 64; i++) {
+            g[i] = Compare(a[i], b[i], t1, t2);
+        }
+    }
+    for (; col < width; col++) {
+        g[col] = Compare(a[col], b[col], t1, t2);
+        identical = identical && (a[col] == b[col]);
+    }
+    return identical;
+}
+
+/* Filter one row
+    - Input  : compared rows above, at and below the output row
+    - Output : WIDTH filtered pixels, first and last column zero
+*/
+inline void stencil_row_sw(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out, int width) {
+    out[0] = 0;
+    for (int col = 1; col < width - 1; col++) {
+        int16_t temp = 5 * mid[col] - up[col] - down[col] - mid[col - 1] - mid[col + 1];
+        out[col] = (temp < 0) ? 0 : ((temp > 255) ? 255 : temp);
+    }
+    out[width - 1] = 0;
+}
+
+/* Whole frame reference
+    Keeps only three compared rows alive (rolling line buffer, like the kernels)
+    instead of a full frame sized diff array, so any resolution fits.
+    With stats != nullptr the frame statistics (frame_stats.hpp) are gathered from
+    each output row right after it is filtered, instead of in a second pass.
+*/
+inline void IMAGE_DIFF_POSTERIZE_SW(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out,
+                                    int width, int height, uint8_t t1 = T1, uint8_t t2 = T2,
+                                    uint32_t *stats = nullptr) {
+    if (height < 3 || width < 3) {
+        memset(out, 0, (size_t)width * height);
+        if (stats) frame_stats_sw(out, width, height, stats);
+        return;
+    }
+    if (stats) frame_stats_begin(stats);
+
+    std::vector<uint8_t> lines(3 * (size_t)width);
+    uint8_t *g[3] = {&lines[0], &lines[width], &lines[2 * (size_t)width]};
+    bool same[3];   // A and B rows behind g[] were identical
+
+    same[0] = posterize_row_sw(in_A, in_B, g[0], width, t1, t2);
+    same[1] = posterize_row_sw(in_A + width, in_B + width, g[1], width, t1, t2);
+    memset(out, 0, width);
+
+    for (int row = 1; row < height - 1; row++) {
+        size_t next = (size_t)(row + 1) * width;
+        same[2] = posterize_row_sw(in_A + next, in_B + next, g[2], width, t1, t2);
+        if (same[0] && same[1] && same[2]) {
+            memset(out + (size_t)row * width, 0, width);
+        } else {
+            stencil_row_sw(g[0], g[1], g[2], out + (size_t)row * width, width);
+        }
+        if (stats) frame_stats_row(stats, out + (size_t)row * width, row, width);
+
+        uint8_t *oldest = g[0];
+        g[0] = g[1];
+        g[1] = g[2];
+        g[2] = oldest;
+        same[0] = same[1];
+        same[1] = same[2];
+    }
+
+    memset(out + (size_t)(height - 1) * width, 0, width);
+
+    // The two zero border rows only add to bin 0
+    if (stats) {
+        stats[STATS_HIST + 0] += 2 * width;
+        frame_stats_end(stats);
+    }
+}
+
+#endif
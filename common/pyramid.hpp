@@ -0,0 +1,160 @@
+/**
+ * @file pyramid.hpp
+ * @brief Coarse-to-fine mode: full resolution only where a coarse diff sees change
+ *
+ * The output can only be nonzero within one pixel of a pixel whose |A - B| reaches T1
+ * (G is zero everywhere else). A coarse pass samples every factor-th pixel of every
+ * factor-th row, so it reads 1/factor of the input rows, and marks the blocks with a
+ * sampled difference of at least T1 as active. Runs of active blocks in a block row
+ * become one rectangle. Only those rectangles plus the stencil halo are computed at
+ * full resolution; the rest of the output is written as zeros without reading A or B.
+ *
+ * The result equals the full computation whenever every block that holds a changed
+ * pixel has one on the sampling grid. Changes smaller than the grid spacing can be
+ * missed, so factor trades bandwidth for sensitivity (factor 1 is exact).
+ *
+ * The device side is Third_Lab/pyramid.cpp, launched with the block list as
+ * RectLaunch entries (common/dirty_rect.hpp). Those are widened to whole 512-bit
+ * beats, and the CPU version computes exactly the same widened regions so the two
+ * outputs match bit for bit.
+ *
+ * Command line:
+ *     --pyramid                 run the coarse-to-fine mode as well
+ *     --pyramid-factor <N>      sampling step in both directions (default 8)
+ *     --pyramid-block <W>x<H>   block size in pixels (default 64x16, W a multiple of 64)
+ */
+
+#ifndef PYRAMID_HPP
+#define PYRAMID_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "dirty_rect.hpp"
+
+#define PYRAMID_MAX_BLOCKS 512      // block list capacity, must match MAX_BLOCKS in Third_Lab/pyramid.cpp
+
+struct PyramidConfig {
+    int factor = 8;
+    int block_w = 64;
+    int block_h = 16;
+    uint8_t threshold = T1;     // smallest difference Compare does not map to 0
+    int lanes = 64;             // the kernel computes whole beats, the reference does the same
+};
+
+/* Coarse pass
+    - Input  : A and B, width x height
+    - Output : active rectangles, block aligned and clipped to the frame, row-major order
+*/
+inline std::vector<DirtyRect> pyramid_active_blocks(const uint8_t *in_A, const uint8_t *in_B,
+                                                    int width, int height, const PyramidConfig &cfg) {
+    const int blocks_x = (width + cfg.block_w - 1) / cfg.block_w;
+    const int blocks_y = (height + cfg.block_h - 1) / cfg.block_h;
+    std::vector<uint8_t> active((size_t)blocks_x * blocks_y, 0);
+
+    // Sample the centre of every factor x factor cell
+    const int offset = cfg.factor / 2;
+    for (int y = offset; y < height; y += cfg.factor) {
+        const uint8_t *a = in_A + (size_t)y * width;
+        const uint8_t *b = in_B + (size_t)y * width;
+        uint8_t *block_row = &active[(size_t)(y / cfg.block_h) * blocks_x];
+        for (int x = offset; x < width; x += cfg.factor) {
+            int d = (int)a[x] - (int)b[x];
+            if (d >= cfg.threshold || -d >= cfg.threshold) block_row[x / cfg.block_w] = 1;
+        }
+    }
+
+    std::vector<DirtyRect> rects;
+    for (int by = 0; by < blocks_y; by++) {
+        const int y = by * cfg.block_h;
+        const int h = std::min(cfg.block_h, height - y);
+        for (int bx = 0; bx < blocks_x; bx++) {
+            if (!active[(size_t)by * blocks_x + bx]) continue;
+            int run = bx;
+            while (run + 1 < blocks_x && active[(size_t)by * blocks_x + run + 1]) run++;
+            const int x = bx * cfg.block_w;
+            rects.push_back({x, y, std::min((run + 1) * cfg.block_w, width) - x, h});
+            bx = run;
+        }
+    }
+    return rects;
+}
+
+/* Block list argument of IMAGE_DIFF_POSTERIZE_PYRAMID
+    - Input  : active rectangles
+    - Output : 4 ints per block (RectLaunch), regions with nothing inside the border dropped
+*/
+inline std::vector<int> pyramid_block_list(const std::vector<DirtyRect> &rects, int width, int height, int lanes = 64) {
+    std::vector<int> list;
+    for (const DirtyRect &r : rects) {
+        RectLaunch launch;
+        if (!dirty_rect_launch(r, width, height, launch, lanes)) continue;
+        list.insert(list.end(), {launch.row_start, launch.row_end, launch.chunk_start, launch.chunk_end});
+    }
+    return list;
+}
+
+/* Coarse-to-fine IMAGE_DIFF_POSTERIZE
+    - Input  : A and B, width x height
+    - Output : out, active rectangles in *rects when given
+*/
+inline void IMAGE_DIFF_POSTERIZE_SW_PYRAMID(const uint8_t *in_A, const uint8_t *in_B, uint8_t *out,
+                                            int width, int height, const PyramidConfig &cfg = PyramidConfig(),
+                                            std::vector<DirtyRect> *rects = nullptr) {
+    std::vector<DirtyRect> active = pyramid_active_blocks(in_A, in_B, width, height, cfg);
+    memset(out, 0, (size_t)width * height);
+
+    // Same beat-widened regions as the kernel, minus the border columns it forces to zero
+    std::vector<int> list = pyramid_block_list(active, width, height, cfg.lanes);
+    std::vector<uint8_t> lines;
+    for (size_t b = 0; b < list.size(); b += 4) {
+        int x0 = std::max(1, list[b + 2] * cfg.lanes);
+        int x1 = std::min(width - 1, list[b + 3] * cfg.lanes);
+        DirtyRect o = {x0, list[b], x1 - x0, list[b + 1] - list[b]};
+        posterize_region_sw(in_A, in_B, out, width, o, lines);
+    }
+    if (rects != nullptr) rects->swap(active);
+}
+
+/* Share of the frame computed at full resolution, halos included (an upper bound, overlaps count twice) */
+inline double pyramid_coverage(const std::vector<DirtyRect> &rects, int width, int height) {
+    size_t pixels = 0;
+    for (const DirtyRect &r : rects) {
+        DirtyRect o;
+        if (dirty_output_region(r, width, height, o)) pixels += (size_t)o.w * o.h;
+    }
+    return std::min(1.0, (double)pixels / ((double)width * height));
+}
+
+/* Takes the pyramid options out of args, enabled is set by --pyramid */
+inline void parse_pyramid_args(std::vector<std::string> &args, PyramidConfig &cfg, bool &enabled) {
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--pyramid") {
+            enabled = true;
+        } else if (args[i] == "--pyramid-factor" && i + 1 < args.size()) {
+            cfg.factor = std::max(1, atoi(args[++i].c_str()));
+        } else if (args[i] == "--pyramid-block" && i + 1 < args.size()) {
+            int w, h;
+            if (sscanf(args[++i].c_str(), "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+                std::cerr << "Ignoring malformed --pyramid-block " << args[i] << " (expected WxH)" << std::endl;
+            } else if (w % cfg.lanes != 0) {
+                // Blocks are widened to whole beats, unaligned ones would overlap and compute beats twice
+                std::cerr << "Ignoring --pyramid-block " << args[i] << ": W must be a multiple of " << cfg.lanes << std::endl;
+            } else {
+                cfg.block_w = w;
+                cfg.block_h = h;
+            }
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+#endif
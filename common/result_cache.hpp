@@ -0,0 +1,194 @@
+/**
+ * @file result_cache.hpp
+ * @brief LRU cache of filtered frames keyed by a 128-bit hash of the inputs
+ *
+ * Replay and regression runs push the same (A, B) pairs again and again. A hit
+ * costs one pass of the hash over both inputs plus a memcpy of the output, and
+ * never touches the device. The key also covers the frame size and the two
+ * thresholds, so results of different kernel builds cannot be mixed up.
+ *
+ * Entries are evicted least recently used first once the output bytes held pass
+ * the budget. The inputs are not stored, so a hit trusts the 128-bit hash.
+ * All calls are thread safe (the daemon serves several clients from one cache).
+ *
+ * Command line:
+ *     --cache <MB>              keep up to MB megabytes of outputs (default off)
+ */
+
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FrameHash {
+    uint64_t lo = 0, hi = 0;
+    bool operator==(const FrameHash &o) const { return lo == o.lo && hi == o.hi; }
+};
+
+struct FrameHashHasher {
+    size_t operator()(const FrameHash &h) const { return (size_t)(h.lo ^ (h.hi * 0x9E3779B97F4A7C15ull)); }
+};
+
+namespace result_cache_detail {
+
+const uint64_t P1 = 0x9E3779B185EBCA87ull;
+const uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t P3 = 0x165667B19E3779F9ull;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t lane_round(uint64_t acc, uint64_t lane) { return rotl(acc + lane * P2, 31) * P1; }
+
+inline uint64_t avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* Four independent 64-bit lanes over 32-byte stripes, so the multiplies overlap
+    - Input  : bytes, running state (4 lanes)
+    - Output : state updated, the tail shorter than a stripe folded into lane 0
+*/
+inline void absorb(uint64_t acc[4], const uint8_t *p, size_t bytes) {
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        acc[0] = lane_round(acc[0], read64(p + i));
+        acc[1] = lane_round(acc[1], read64(p + i + 8));
+        acc[2] = lane_round(acc[2], read64(p + i + 16));
+        acc[3] = lane_round(acc[3], read64(p + i + 24));
+    }
+    for (; i < bytes; i++) acc[0] = lane_round(acc[0], p[i]);
+    acc[0] = lane_round(acc[0], bytes);
+}
+
+}  // namespace result_cache_detail
+
+/* Key of one IMAGE_DIFF_POSTERIZE call
+    - Input  : A and B, width x height, thresholds
+    - Output : 128-bit hash of all of them
+*/
+inline FrameHash frame_pair_hash(const uint8_t *in_A, const uint8_t *in_B, int width, int height,
+                                 uint8_t t1, uint8_t t2) {
+    using namespace result_cache_detail;
+    const size_t bytes = (size_t)width * height;
+    const uint64_t seed = ((uint64_t)(uint32_t)width << 32 | (uint32_t)height) ^ ((uint64_t)t1 << 8 | t2) * P3;
+    uint64_t acc[4] = {seed + P1 + P2, seed + P2, seed, seed - P1};
+
+    absorb(acc, in_A, bytes);
+    absorb(acc, in_B, bytes);
+
+    FrameHash h;
+    h.lo = avalanche(rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18));
+    h.hi = avalanche((acc[0] ^ rotl(acc[2], 29)) * P1 + (acc[1] ^ rotl(acc[3], 41)) * P2 + h.lo);
+    return h;
+}
+
+class ResultCache {
+public:
+    explicit ResultCache(size_t budget_bytes) : budget(budget_bytes) {}
+
+    /* Copies the cached output of key into out
+        - Output : true on a hit (out holds bytes bytes), false on a miss (out untouched)
+    */
+    bool lookup(const FrameHash &key, uint8_t *out, size_t bytes) {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = index.find(key);
+        if (it == index.end() || it->second->data.size() != bytes) {
+            miss_count++;
+            return false;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        memcpy(out, it->second->data.data(), bytes);
+        hit_count++;
+        return true;
+    }
+
+    /* Stores a computed output under key, evicting the oldest entries past the budget.
+        An output larger than the whole budget is not stored.
+    */
+    void insert(const FrameHash &key, const uint8_t *data, size_t bytes) {
+        std::lock_guard<std::mutex> lk(mtx);
+        if (bytes > budget) return;
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            used -= it->second->data.size();
+            lru.erase(it->second);
+            index.erase(it);
+        }
+        while (used + bytes > budget && !lru.empty()) {
+            used -= lru.back().data.size();
+            index.erase(lru.back().key);
+            lru.pop_back();
+            eviction_count++;
+        }
+
+        lru.push_front(Entry{key, std::vector<uint8_t>(data, data + bytes)});
+        index[key] = lru.begin();
+        used += bytes;
+    }
+
+    uint64_t hits() const { std::lock_guard<std::mutex> lk(mtx); return hit_count; }
+    uint64_t misses() const { std::lock_guard<std::mutex> lk(mtx); return miss_count; }
+    uint64_t evictions() const { std::lock_guard<std::mutex> lk(mtx); return eviction_count; }
+    size_t entries() const { std::lock_guard<std::mutex> lk(mtx); return lru.size(); }
+    size_t bytes_used() const { std::lock_guard<std::mutex> lk(mtx); return used; }
+
+    void print_stats(std::ostream &os = std::cout) const {
+        std::lock_guard<std::mutex> lk(mtx);
+        uint64_t lookups = hit_count + miss_count;
+        os << "Result cache: " << hit_count << " hits, " << miss_count << " misses ("
+           << (lookups ? 100.0 * hit_count / lookups : 0.0) << "% hit rate), "
+           << eviction_count << " evictions, " << lru.size() << " entries, "
+           << used / 1024 << " of " << budget / 1024 << " KiB" << std::endl;
+    }
+
+private:
+    struct Entry {
+        FrameHash key;
+        std::vector<uint8_t> data;
+    };
+
+    const size_t budget;
+    mutable std::mutex mtx;
+    std::list<Entry> lru;       // most recently used first
+    std::unordered_map<FrameHash, std::list<Entry>::iterator, FrameHashHasher> index;
+    size_t used = 0;
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+    uint64_t eviction_count = 0;
+};
+
+/* Takes --cache out of args, budget_mb stays 0 (cache off) without it */
+inline void parse_cache_args(std::vector<std::string> &args, size_t &budget_mb) {
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--cache" && i + 1 < args.size()) {
+            long mb = atol(args[++i].c_str());
+            if (mb > 0) budget_mb = (size_t)mb;
+            else std::cerr << "Ignoring --cache " << args[i] << " (expected a size in MB)" << std::endl;
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file verify.hpp
+ * @brief Block-wise, multithreaded comparison of device and reference frames
+ *
+ * The frames are compared 64 bytes (one 512-bit beat) at a time. A block that
+ * matches costs four SSE2 compares and one branch, only a block that differs is
+ * walked byte by byte to record coordinates. Large frames are split in row bands
+ * across threads; each band keeps its own first mismatches and the bands are merged
+ * in order, so the report is the same as a sequential scan.
+ *
+ * With a tolerance t, |expected - actual| <= t counts as a match (useful against
+ * references with a different rounding).
+ */
+
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define VERIFY_BLOCK 64
+
+struct VerifyConfig {
+    int tolerance = 0;          // largest accepted |expected - actual|
+    int max_report = 10;        // first K mismatches kept with coordinates
+    int threads = 0;            // 0 = hardware concurrency
+};
+
+struct Mismatch {
+    int row, col;
+    uint8_t expected, actual;
+};
+
+struct VerifyResult {
+    size_t mismatches = 0;
+    int min_row = -1, min_col = -1, max_row = -1, max_col = -1;   // bounding box, -1 when clean
+    std::vector<Mismatch> first;
+
+    bool passed() const { return mismatches == 0; }
+};
+
+/* True when the 64 byte block holds no difference above tolerance */
+inline bool verify_block_ok(const uint8_t *e, const uint8_t *a, int tolerance) {
+#if defined(__SSE2__)
+    const __m128i tol = _mm_set1_epi8((char)tolerance);
+    __m128i bad = _mm_setzero_si128();
+    for (int i = 0; i < VERIFY_BLOCK; i += 16) {
+        __m128i ve = _mm_loadu_si128((const __m128i *)(e + i));
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        // |e - a| from two saturating subtractions, then anything above tolerance survives
+        __m128i diff = _mm_or_si128(_mm_subs_epu8(ve, va), _mm_subs_epu8(va, ve));
+        bad = _mm_or_si128(bad, _mm_subs_epu8(diff, tol));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) == 0xFFFF;
+#else
+    if (tolerance == 0) return memcmp(e, a, VERIFY_BLOCK) == 0;
+    for (int i = 0; i < VERIFY_BLOCK; i++) {
+        if (std::abs((int)e[i] - (int)a[i]) > tolerance) return false;
+    }
+    return true;
+#endif
+}
+
+/* Scans pixels [begin, end) of a width wide frame into res */
+inline void verify_range(const uint8_t *expected, const uint8_t *actual, size_t begin, size_t end,
+                         int width, const VerifyConfig &cfg, VerifyResult &res) {
+    auto check = [&](size_t i) {
+        if (std::abs((int)expected[i] - (int)actual[i]) <= cfg.tolerance) return;
+        int row = (int)(i / width), col = (int)(i % width);
+        if (res.mismatches == 0) {
+            res.min_row = res.max_row = row;
+            res.min_col = res.max_col = col;
+        } else {
+            res.min_row = std::min(res.min_row, row);
+            res.max_row = std::max(res.max_row, row);
+            res.min_col = std::min(res.min_col, col);
+            res.max_col = std::max(res.max_col, col);
+        }
+        if ((int)res.first.size() < cfg.max_report) res.first.push_back({row, col, expected[i], actual[i]});
+        res.mismatches++;
+    };
+
+    size_t i = begin;
+    for (; i + VERIFY_BLOCK <= end; i += VERIFY_BLOCK) {
+        if (verify_block_ok(expected + i, actual + i, cfg.tolerance)) continue;
+        for (size_t j = i; j < i + VERIFY_BLOCK; j++) check(j);
+    }
+    for (; i < end; i++) check(i);
+}
+
+/* Compares a whole frame
+    - Input  : reference and device frames of width x height pixels
+    - Output : mismatch count, bounding box and the first cfg.max_report mismatches in scan order
+*/
+inline VerifyResult verify_frames(const uint8_t *expected, const uint8_t *actual, int width, int height,
+                                  const VerifyConfig &cfg = VerifyConfig()) {
+    const size_t pixels = (size_t)width * height;
+    int threads = cfg.threads > 0 ? cfg.threads : (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    if (pixels < (1u << 20)) threads = 1;     // below ~1 MPix the thread start costs more than the scan
+    threads = std::min(threads, height);
+
+    VerifyResult res;
+    if (threads == 1) {
+        verify_range(expected, actual, 0, pixels, width, cfg, res);
+        return res;
+    }
+
+    // Bands on row boundaries, merged in order so "first" stays the first in scan order
+    std::vector<VerifyResult> bands(threads);
+    std::vector<std::thread> pool;
+    const int band_rows = (height + threads - 1) / threads;
+    for (int t = 0; t < threads; t++) {
+        size_t begin = (size_t)std::min(height, t * band_rows) * width;
+        size_t end = (size_t)std::min(height, (t + 1) * band_rows) * width;
+        pool.emplace_back([&, t, begin, end]() {
+            verify_range(expected, actual, begin, end, width, cfg, bands[t]);
+        });
+    }
+    for (auto &th : pool) th.join();
+
+    for (const VerifyResult &b : bands) {
+        if (b.mismatches == 0) continue;
+        if (res.mismatches == 0) {
+            res.min_row = b.min_row; res.max_row = b.max_row;
+            res.min_col = b.min_col; res.max_col = b.max_col;
+        } else {
+            res.min_row = std::min(res.min_row, b.min_row);
+            res.max_row = std::max(res.max_row, b.max_row);
+            res.min_col = std::min(res.min_col, b.min_col);
+            res.max_col = std::max(res.max_col, b.max_col);
+        }
+        res.mismatches += b.mismatches;
+        for (const Mismatch &m : b.first) {
+            if ((int)res.first.size() < cfg.max_report) res.first.push_back(m);
+        }
+    }
+    return res;
+}
+
+// Prints the first mismatches, the remaining count and the bounding box (nothing on a match)
+inline void verify_print(const VerifyResult &res, int width) {
+    if (res.passed()) return;
+    for (const Mismatch &m : res.first) {
+        std::cout << "Mismatch at i=" << (size_t)m.row * width + m.col
+                  << " (row=" << m.row << ", col=" << m.col << "): "
+                  << "SW=" << (int)m.expected << " "
+                  << "HW=" << (int)m.actual << std::endl;
+    }
+    if (res.mismatches > res.first.size()) {
+        std::cout << "...  and " << (res.mismatches - res.first.size()) << " more mismatches\n";
+    }
+    std::cout << res.mismatches << " mismatches in rows " << res.min_row << ".." << res.max_row
+              << ", cols " << res.min_col << ".." << res.max_col << std::endl;
+}
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * @file workload_gen.hpp
+ * @brief Fast, seeded, multithreaded synthetic frame pairs for the hosts
+ *
+ * std::generate(..., std::rand) is serial, slow on large frames and produces
+ * uniform noise, which pushes almost every pixel into the 255 bin. The scenes
+ * here give the compare/stencil datapath realistic inputs:
+ *
+ *     noise   - independent uniform A and B (the old behaviour)
+ *     blobs   - static textured background, a few blobs moving between B and A,
+ *               light sensor noise on top. Most of the frame is quiet.
+ *     ramp    - same background, A lit with a horizontal gain + vertical offset
+ *               ramp, so the difference sweeps smoothly through all three bins
+ *     sensor  - static scene, A and B differ only by Gaussian-like sensor noise
+ *
+ * The random source is a counter-based 32-bit hash (lowbias32): value i of a
+ * stream is hash(seed, stream, i), so rows can be produced in any order by any
+ * thread and the result does not depend on the thread count. The inner loops are
+ * plain 32-bit integer arithmetic and auto-vectorize at -O2/-O3.
+ */
+
+#ifndef WORKLOAD_GEN_HPP
+#define WORKLOAD_GEN_HPP
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum SceneType {
+    SCENE_NOISE,
+    SCENE_BLOBS,
+    SCENE_RAMP,
+    SCENE_SENSOR
+};
+
+struct SceneParams {
+    SceneType scene = SCENE_BLOBS;
+    uint32_t seed = 1;
+    int frame = 0;            // animation step, blobs move by velocity per frame
+    int blobs = 12;
+    int blob_radius = 24;     // pixels, actual radius is radius/2 .. radius
+    int velocity = 6;         // pixels per frame
+    int noise_sigma = 3;      // sensor noise (blobs and sensor scenes)
+    int ramp_gain = 90;       // percent brightness added at the right edge (ramp scene)
+    int ramp_offset = 40;     // grey levels added at the bottom edge (ramp scene)
+    int threads = 0;          // 0 = hardware concurrency
+};
+
+inline uint32_t lowbias32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Value <index> of random stream <stream>
+inline uint32_t rng_at(uint32_t seed, uint32_t stream, uint32_t index) {
+    return lowbias32(index * 0x9e3779b9U ^ lowbias32(seed ^ (stream * 0x85ebca6bU)));
+}
+
+inline uint8_t clamp_u8(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/* Fills one row with uniform bytes
+    4 pixels per hash, the loop body has no dependencies between iterations.
+*/
+inline void fill_noise_row(uint8_t *dst, int width, uint32_t seed, uint32_t stream, uint32_t row) {
+    const uint32_t base = row * (uint32_t)((width + 3) / 4);
+    const uint32_t key = lowbias32(seed ^ (stream * 0x85ebca6bU));
+    int words = width / 4;
+    for (int w = 0; w < words; w++) {
+        uint32_t r = lowbias32((base + w) * 0x9e3779b9U ^ key);
+        memcpy(dst + 4 * w, &r, 4);
+    }
+    for (int col = words * 4; col < width; col++) {
+        dst[col] = (uint8_t)lowbias32((base + words) * 0x9e3779b9U ^ key ^ col);
+    }
+}
+
+/* Adds zero-mean noise of roughly <sigma> grey levels
+    Sum of the four bytes of one hash is close to Gaussian (std ~147.8).
+*/
+inline void add_sensor_noise_row(uint8_t *dst, int width, int sigma, uint32_t seed, uint32_t stream, uint32_t row) {
+    if (sigma <= 0) return;
+    const uint32_t key = lowbias32(seed ^ (stream * 0x85ebca6bU));
+    const uint32_t base = row * (uint32_t)width;
+    const int scale = (sigma << 16) / 148;
+    for (int col = 0; col < width; col++) {
+        uint32_t r = lowbias32((base + col) * 0x9e3779b9U ^ key);
+        int sum = (int)(r & 0xFF) + (int)((r >> 8) & 0xFF) + (int)((r >> 16) & 0xFF) + (int)(r >> 24);
+        int n = ((sum - 510) * scale) >> 16;
+        dst[col] = clamp_u8(dst[col] + n);
+    }
+}
+
+/* Static textured background
+    Bilinear interpolation of a hashed 32x32 pixel grid, identical for A and B.
+*/
+inline void background_row(uint8_t *dst, int width, uint32_t seed, int row) {
+    const int cell = 32;
+    const int gy = row / cell;
+    const int fy = row % cell;
+    for (int gx = 0; gx * cell < width; gx++) {
+        int v00 = 48 + (rng_at(seed, 7, (uint32_t)(gy * 4099 + gx)) & 0x7F);
+        int v01 = 48 + (rng_at(seed, 7, (uint32_t)(gy * 4099 + gx + 1)) & 0x7F);
+        int v10 = 48 + (rng_at(seed, 7, (uint32_t)((gy + 1) * 4099 + gx)) & 0x7F);
+        int v11 = 48 + (rng_at(seed, 7, (uint32_t)((gy + 1) * 4099 + gx + 1)) & 0x7F);
+        int left = v00 * (cell - fy) + v10 * fy;      // column gx, interpolated in y
+        int right = v01 * (cell - fy) + v11 * fy;     // column gx + 1
+        int span = std::min(cell, width - gx * cell);
+        uint8_t *out = dst + gx * cell;
+        for (int fx = 0; fx < span; fx++) {
+            out[fx] = (uint8_t)((left * (cell - fx) + right * fx) / (cell * cell));
+        }
+    }
+}
+
+struct Blob {
+    int cx, cy;       // centre at frame 0
+    int vx, vy;       // motion per frame
+    int radius;
+    int level;        // grey level of the object
+};
+
+inline std::vector<Blob> make_blobs(const SceneParams &p, int width, int height) {
+    std::vector<Blob> blobs(p.blobs);
+    for (int i = 0; i < p.blobs; i++) {
+        uint32_t r0 = rng_at(p.seed, 11, 4 * i);
+        uint32_t r1 = rng_at(p.seed, 11, 4 * i + 1);
+        uint32_t r2 = rng_at(p.seed, 11, 4 * i + 2);
+        uint32_t r3 = rng_at(p.seed, 11, 4 * i + 3);
+        blobs[i].cx = r0 % width;
+        blobs[i].cy = r1 % height;
+        blobs[i].vx = (int)(r2 % (2 * p.velocity + 1)) - p.velocity;
+        blobs[i].vy = (int)((r2 >> 16) % (2 * p.velocity + 1)) - p.velocity;
+        blobs[i].radius = std::max(1, p.blob_radius / 2 + (int)(r3 % (p.blob_radius / 2 + 1)));
+        blobs[i].level = 16 + (r3 >> 8) % 224;
+    }
+    return blobs;
+}
+
+// Paints the blobs at animation step <frame> into one row, cost is the covered span only
+inline void paint_blobs_row(uint8_t *dst, int width, int height, int row, const std::vector<Blob> &blobs, int frame) {
+    for (const Blob &b : blobs) {
+        // Wrap around the frame so blobs never leave the scene
+        int cx = ((b.cx + b.vx * frame) % width + width) % width;
+        int cy = ((b.cy + b.vy * frame) % height + height) % height;
+        int dy = row - cy;
+        if (dy < -b.radius || dy > b.radius) continue;
+        int half = 0;
+        while ((half + 1) * (half + 1) + dy * dy <= b.radius * b.radius) half++;
+        int c0 = std::max(0, cx - half);
+        int c1 = std::min(width - 1, cx + half);
+        for (int col = c0; col <= c1; col++) dst[col] = (uint8_t)b.level;
+    }
+}
+
+/* Renders rows [row0, row1) of both frames
+    B is the earlier frame, A the later one, as a camera would deliver them.
+*/
+inline void render_rows(uint8_t *A, uint8_t *B, int width, int height, int row0, int row1,
+                        const SceneParams &p, const std::vector<Blob> &blobs) {
+    for (int row = row0; row < row1; row++) {
+        uint8_t *a = A + (size_t)row * width;
+        uint8_t *b = B + (size_t)row * width;
+        const uint32_t stream_a = 2 * p.frame + 1;
+        const uint32_t stream_b = 2 * p.frame;
+
+        switch (p.scene) {
+            case SCENE_NOISE:
+                fill_noise_row(a, width, p.seed, 100 + stream_a, row);
+                fill_noise_row(b, width, p.seed, 100 + stream_b, row);
+                break;
+
+            case SCENE_BLOBS:
+                background_row(b, width, p.seed, row);
+                memcpy(a, b, width);
+                paint_blobs_row(b, width, height, row, blobs, p.frame);
+                paint_blobs_row(a, width, height, row, blobs, p.frame + 1);
+                add_sensor_noise_row(a, width, p.noise_sigma, p.seed, 200 + stream_a, row);
+                add_sensor_noise_row(b, width, p.noise_sigma, p.seed, 200 + stream_b, row);
+                break;
+
+            case SCENE_RAMP: {
+                background_row(b, width, p.seed, row);
+                const int offset = (p.ramp_offset * row) / std::max(1, height - 1);
+                for (int col = 0; col < width; col++) {
+                    int gain = 100 + (p.ramp_gain * col) / std::max(1, width - 1);
+                    a[col] = clamp_u8((b[col] * gain) / 100 + offset);
+                }
+                break;
+            }
+
+            case SCENE_SENSOR:
+                background_row(b, width, p.seed, row);
+                memcpy(a, b, width);
+                add_sensor_noise_row(a, width, p.noise_sigma, p.seed, 200 + stream_a, row);
+                add_sensor_noise_row(b, width, p.noise_sigma, p.seed, 200 + stream_b, row);
+                break;
+        }
+    }
+}
+
+/* Generates one A/B frame pair
+    - Input  : frame geometry and scene parameters
+    - Output : A and B, each width*height bytes
+    Rows are split in contiguous bands across threads; small frames stay on the caller.
+*/
+inline void generate_frame_pair(uint8_t *A, uint8_t *B, int width, int height, const SceneParams &p) {
+    std::vector<Blob> blobs;
+    if (p.scene == SCENE_BLOBS) blobs = make_blobs(p, width, height);
+
+    int threads = p.threads > 0 ? p.threads : (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    if ((size_t)width * height < (1u << 18)) threads = 1;
+    threads = std::min(threads, height);
+
+    if (threads == 1) {
+        render_rows(A, B, width, height, 0, height, p, blobs);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    const int band = (height + threads - 1) / threads;
+    for (int t = 0; t < threads; t++) {
+        int row0 = t * band;
+        int row1 = std::min(height, row0 + band);
+        if (row0 >= row1) break;
+        pool.emplace_back(render_rows, A, B, width, height, row0, row1, std::cref(p), std::cref(blobs));
+    }
+    for (auto &th : pool) th.join();
+}
+
+inline bool parse_scene(const std::string &name, SceneType &scene) {
+    if (name == "noise")       scene = SCENE_NOISE;
+    else if (name == "blobs")  scene = SCENE_BLOBS;
+    else if (name == "ramp")   scene = SCENE_RAMP;
+    else if (name == "sensor") scene = SCENE_SENSOR;
+    else return false;
+    return true;
+}
+
+/* Picks --scene <noise|blobs|ramp|sensor>, --seed <N>, --frame <N> and --sigma <N> out of args
+    Consumed entries are removed, everything else is left for the caller.
+*/
+inline void parse_workload_args(std::vector<std::string> &args, SceneParams &p) {
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--scene" && i + 1 < args.size()) {
+            if (!parse_scene(args[++i], p.scene)) {
+                std::cerr << "Unknown scene " << args[i] << ", using blobs" << std::endl;
+                p.scene = SCENE_BLOBS;
+            }
+        } else if (args[i] == "--seed" && i + 1 < args.size()) {
+            p.seed = (uint32_t)strtoul(args[++i].c_str(), nullptr, 0);
+        } else if (args[i] == "--frame" && i + 1 < args.size()) {
+            p.frame = atoi(args[++i].c_str());
+        } else if (args[i] == "--sigma" && i + 1 < args.size()) {
+            p.noise_sigma = atoi(args[++i].c_str());
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    args.swap(rest);
+}
+
+#endif